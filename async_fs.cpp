@@ -0,0 +1,119 @@
+#include "async_fs.hpp"
+
+ThreadPoolExecutor::ThreadPoolExecutor(int threads) : stopping(false) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::thread([this]() { workerLoop(); }));
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPoolExecutor::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    cond.notify_one();
+}
+
+void ThreadPoolExecutor::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping 且队列已空
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+AsyncMiniFS::AsyncMiniFS(MiniFS& fs, AsyncExecutor& executor)
+    : fs(fs), executor(executor), inline_completions(0), posted(0) {}
+
+// 把路径拆成父目录的i-节点号和最后一个名字
+int AsyncMiniFS::resolveParent(const std::string& path, std::string& name) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "/" : path.substr(0, slash);
+    name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    if (name.empty()) {
+        return MiniFS::INVALID_INUM_CONST;
+    }
+    return fs.resolve_path_to_inum(dir.empty() ? "/" : dir);
+}
+
+void AsyncMiniFS::async_open(const std::string& path, int flags, std::function<void(int)> done) {
+    posted++;
+    executor.post([this, path, flags, done]() {
+        std::string name;
+        int parent = resolveParent(path, name);
+        done(parent == MiniFS::INVALID_INUM_CONST ? -1 : fs.open(parent, name.c_str(), flags));
+    });
+}
+
+void AsyncMiniFS::async_close(int fd, std::function<void(int)> done) {
+    posted++;
+    executor.post([this, fd, done]() { done(fs.close(fd)); });
+}
+
+void AsyncMiniFS::async_read(int fd, void* buf, int count, int offset, std::function<void(int)> done) {
+    // 命中预读缓冲区: 不读块，直接在调用线程内完成
+    int n = 0;
+    if (fs.tryReadCached(fd, buf, count, offset, n)) {
+        inline_completions++;
+        done(n);
+        return;
+    }
+    posted++;
+    executor.post([this, fd, buf, count, offset, done]() { done(fs.pread(fd, buf, count, offset)); });
+}
+
+void AsyncMiniFS::async_write(int fd, const void* buf, int count, int offset, std::function<void(int)> done) {
+    posted++;
+    executor.post([this, fd, buf, count, offset, done]() { done(fs.pwrite(fd, buf, count, offset)); });
+}
+
+void AsyncMiniFS::async_readdir(const std::string& path, std::function<void(AsyncDirListing)> done) {
+    posted++;
+    executor.post([this, path, done]() {
+        AsyncDirListing listing;
+        listing.status = -1;
+        int inum = fs.resolve_path_to_inum(path);
+        MiniFS::DirCursor cursor;
+        if (inum != MiniFS::INVALID_INUM_CONST && fs.opendir(inum, cursor) == 0) {
+            listing.status = 0;
+            MiniFS::DirEntry d;
+            while (fs.readdir(cursor, d)) {
+                AsyncDirEntry e;
+                e.inum = d.inum;
+                e.type = static_cast<short>(d.type);
+                e.name = d.name;
+                listing.entries.push_back(e);
+            }
+        }
+        done(listing);
+    });
+}
+
+AsyncMiniFS::Stats AsyncMiniFS::getStats() const {
+    Stats s;
+    s.inline_completions = inline_completions;
+    s.posted = posted;
+    return s;
+}
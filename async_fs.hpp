@@ -0,0 +1,173 @@
+#ifndef ASYNC_FS_HPP
+#define ASYNC_FS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "minifs.hpp"
+
+// 以 C++20 编译时提供协程接口 (co_await)，否则只有回调接口
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+#define MINIFS_HAS_COROUTINES 1
+#endif
+
+// 执行器: 在哪个线程上执行需要读写块的文件系统操作并回调
+// 调用方可以实现自己的执行器，把操作交给已有的事件循环或线程池
+class AsyncExecutor {
+public:
+    virtual ~AsyncExecutor() {}
+    virtual void post(std::function<void()> task) = 0;
+};
+
+// 在调用线程中立即执行 (单线程程序、测试)
+class InlineExecutor : public AsyncExecutor {
+public:
+    void post(std::function<void()> task) override { task(); }
+};
+
+// 固定数量的工作线程共享一个任务队列；析构时执行完剩余任务再退出
+class ThreadPoolExecutor : public AsyncExecutor {
+public:
+    explicit ThreadPoolExecutor(int threads);
+    ~ThreadPoolExecutor();
+
+    ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+    ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+    void post(std::function<void()> task) override;
+    int threadCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    void workerLoop();
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::function<void()> > tasks;
+    std::vector<std::thread> workers;
+    bool stopping;
+};
+
+struct AsyncDirEntry {
+    int inum;
+    short type;          // T_DIR / T_FILE / T_SYMLINK
+    std::string name;
+};
+
+// async_readdir 的结果: status 为0表示成功，-1表示路径不存在或不是目录
+struct AsyncDirListing {
+    int status;
+    std::vector<AsyncDirEntry> entries;
+};
+
+#ifdef MINIFS_HAS_COROUTINES
+// 一次异步操作的等待体: co_await 时启动操作
+// 操作在当前线程内完成 (如命中预读缓冲区) 时不挂起；否则挂起，由完成操作的执行器线程恢复协程
+template <typename T>
+class FsAwaitable {
+public:
+    typedef std::function<void(std::function<void(T)>)> Starter;
+
+    explicit FsAwaitable(Starter start) : start(std::move(start)), done(false) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        // 回调与 await_suspend 谁后到谁负责继续执行: 回调先到说明已同步完成，不必挂起
+        start([this](T r) {
+            result = std::move(r);
+            if (done.exchange(true)) {
+                handle.resume();
+            }
+        });
+        return !done.exchange(true);
+    }
+
+    T await_resume() { return std::move(result); }
+
+private:
+    Starter start;
+    std::coroutine_handle<> handle;
+    std::atomic<bool> done;
+    T result;
+};
+
+// 最简单的协程返回类型: 立即开始执行，结束后自行销毁 (调用方没有自己的任务类型时使用)
+struct AsyncTask {
+    struct promise_type {
+        AsyncTask get_return_object() { return AsyncTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+#endif
+
+// MiniFS 的异步接口: 路径为绝对路径，返回值与同步接口相同 (失败为 -1)
+// 命中预读缓冲区的读取在调用线程内完成并立即回调，其余操作交给执行器，在执行器线程上回调。
+// 大量进行中的操作只占用执行器的少数线程；同一时刻仍只有一个线程在操作文件系统 (MiniFS 内部加锁)
+class AsyncMiniFS {
+public:
+    struct Stats {
+        long inline_completions;  // 在调用线程内完成的操作数
+        long posted;              // 交给执行器的操作数
+    };
+
+    AsyncMiniFS(MiniFS& fs, AsyncExecutor& executor);
+
+    void async_open(const std::string& path, int flags, std::function<void(int)> done);
+    void async_close(int fd, std::function<void(int)> done);
+    // 缓冲区在回调之前必须保持有效
+    void async_read(int fd, void* buf, int count, int offset, std::function<void(int)> done);
+    void async_write(int fd, const void* buf, int count, int offset, std::function<void(int)> done);
+    void async_readdir(const std::string& path, std::function<void(AsyncDirListing)> done);
+
+#ifdef MINIFS_HAS_COROUTINES
+    // co_await 形式: int fd = co_await afs.async_open("/a", MiniFS::O_RDONLY);
+    FsAwaitable<int> async_open(const std::string& path, int flags) {
+        return FsAwaitable<int>([this, path, flags](std::function<void(int)> done) {
+            async_open(path, flags, std::move(done));
+        });
+    }
+    FsAwaitable<int> async_close(int fd) {
+        return FsAwaitable<int>([this, fd](std::function<void(int)> done) { async_close(fd, std::move(done)); });
+    }
+    FsAwaitable<int> async_read(int fd, void* buf, int count, int offset) {
+        return FsAwaitable<int>([this, fd, buf, count, offset](std::function<void(int)> done) {
+            async_read(fd, buf, count, offset, std::move(done));
+        });
+    }
+    FsAwaitable<int> async_write(int fd, const void* buf, int count, int offset) {
+        return FsAwaitable<int>([this, fd, buf, count, offset](std::function<void(int)> done) {
+            async_write(fd, buf, count, offset, std::move(done));
+        });
+    }
+    FsAwaitable<AsyncDirListing> async_readdir(const std::string& path) {
+        return FsAwaitable<AsyncDirListing>([this, path](std::function<void(AsyncDirListing)> done) {
+            async_readdir(path, std::move(done));
+        });
+    }
+#endif
+
+    Stats getStats() const;
+
+private:
+    int resolveParent(const std::string& path, std::string& name);
+
+    MiniFS& fs;
+    AsyncExecutor& executor;
+    std::atomic<long> inline_completions;
+    std::atomic<long> posted;
+};
+
+#endif // ASYNC_FS_HPP
@@ -0,0 +1,545 @@
+#include "block_device.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace {
+
+#ifndef _WIN32
+
+// 同步 pread/pwrite: 提交即完成，wait() 只汇报失败数
+class PreadDevice : public BlockDevice {
+public:
+    PreadDevice(int fd, int block_size, bool read_only)
+        : BlockDevice(read_only), fd(fd), block_size(block_size), failures(0) {}
+    ~PreadDevice() { ::close(fd); }
+
+    const char* name() const { return "pread"; }
+
+    long long sizeBytes() const {
+        struct stat st;
+        return ::fstat(fd, &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+    }
+
+    bool resize(long long bytes) { return ::ftruncate(fd, static_cast<off_t>(bytes)) == 0; }
+
+    bool submitRead(int first_block, int count, void* buf) {
+        return transfer(false, first_block, count, static_cast<char*>(buf));
+    }
+
+    bool submitWrite(int first_block, int count, const void* buf) {
+        return transfer(true, first_block, count, static_cast<char*>(const_cast<void*>(buf)));
+    }
+
+    int wait() {
+        int result = failures;
+        failures = 0;
+        return result;
+    }
+
+    bool flush() {
+#ifdef __linux__
+        return ::fdatasync(fd) == 0;
+#else
+        return ::fsync(fd) == 0;
+#endif
+    }
+
+private:
+    bool transfer(bool write, int first_block, int count, char* buf) {
+        if (first_block < 0 || count <= 0) {
+            return false;
+        }
+        stats.requests++;
+        off_t offset = static_cast<off_t>(first_block) * block_size;
+        size_t left = static_cast<size_t>(count) * block_size;
+        while (left > 0) {
+            ssize_t n = write ? ::pwrite(fd, buf, left, offset) : ::pread(fd, buf, left, offset);
+            stats.submit_calls++;
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                failures++; // 读到文件末尾 (n == 0) 也算失败: 镜像大小不足
+                return true;
+            }
+            stats.bytes += n;
+            buf += n;
+            offset += n;
+            left -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd;
+    int block_size;
+    int failures;
+};
+
+#else // _WIN32
+
+// Windows: 用 stdio 顺序读写
+class PreadDevice : public BlockDevice {
+public:
+    PreadDevice(FILE* file, int block_size, bool read_only)
+        : BlockDevice(read_only), file(file), block_size(block_size), failures(0) {}
+    ~PreadDevice() { std::fclose(file); }
+
+    const char* name() const { return "stdio"; }
+
+    long long sizeBytes() const {
+        if (_fseeki64(file, 0, SEEK_END) != 0) {
+            return -1;
+        }
+        return _ftelli64(file);
+    }
+
+    bool resize(long long bytes) {
+        std::fflush(file);
+        return _chsize_s(_fileno(file), bytes) == 0;
+    }
+
+    bool submitRead(int first_block, int count, void* buf) {
+        return transfer(false, first_block, count, static_cast<char*>(buf));
+    }
+
+    bool submitWrite(int first_block, int count, const void* buf) {
+        return transfer(true, first_block, count, static_cast<char*>(const_cast<void*>(buf)));
+    }
+
+    int wait() {
+        int result = failures;
+        failures = 0;
+        return result;
+    }
+
+    bool flush() { return std::fflush(file) == 0 && _commit(_fileno(file)) == 0; }
+
+private:
+    bool transfer(bool write, int first_block, int count, char* buf) {
+        if (first_block < 0 || count <= 0) {
+            return false;
+        }
+        stats.requests++;
+        stats.submit_calls++;
+        size_t len = static_cast<size_t>(count) * block_size;
+        if (_fseeki64(file, static_cast<long long>(first_block) * block_size, SEEK_SET) != 0) {
+            failures++;
+            return true;
+        }
+        size_t n = write ? std::fwrite(buf, 1, len, file) : std::fread(buf, 1, len, file);
+        if (n != len) {
+            failures++;
+        }
+        stats.bytes += static_cast<long long>(n);
+        return true;
+    }
+
+    FILE* file;
+    int block_size;
+    int failures;
+};
+
+#endif // _WIN32
+
+#ifdef __linux__
+
+// io_uring (直接使用系统调用，不依赖 liburing)
+// 请求先填入提交队列，队列满或 wait() 时才一次 io_uring_enter 批量提交；
+// 镜像文件登记为固定文件，registerBuffer 登记的内存区走 READ_FIXED/WRITE_FIXED
+class UringDevice : public BlockDevice {
+public:
+    static const unsigned QUEUE_DEPTH = 64;
+
+    UringDevice(int fd, int block_size, bool read_only)
+        : BlockDevice(read_only), fd(fd), block_size(block_size), ring_fd(-1), entries(0),
+          sq_ptr(MAP_FAILED), cq_ptr(MAP_FAILED), sq_len(0), cq_len(0),
+          sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), sqes_len(0),
+          to_submit(0), inflight(0), failures(0), fixed_file(false),
+          fixed_base(NULL), fixed_len(0), fixed_pid(0) {}
+
+    ~UringDevice() {
+        if (inflight > 0) {
+            wait(); // 内核可能仍在访问缓冲区
+        }
+        if (sqes != MAP_FAILED) {
+            ::munmap(sqes, sqes_len);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            ::munmap(cq_ptr, cq_len);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            ::munmap(sq_ptr, sq_len);
+        }
+        if (ring_fd >= 0) {
+            ::close(ring_fd);
+        }
+        ::close(fd);
+    }
+
+    // 建立环并映射共享内存；失败时 error 为原因 (fd 仍归调用者所有)
+    bool init(std::string& error) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+        if (ring_fd < 0) {
+            error = std::string("io_uring_setup: ") + std::strerror(errno);
+            return false;
+        }
+        entries = params.sq_entries;
+        sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_len = cq_len = (sq_len > cq_len ? sq_len : cq_len);
+        }
+        sq_ptr = ::mmap(NULL, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) {
+            error = std::string("mmap SQ: ") + std::strerror(errno);
+            return false;
+        }
+        cq_ptr = single_mmap ? sq_ptr
+                             : ::mmap(NULL, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      ring_fd, IORING_OFF_CQ_RING);
+        sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(::mmap(NULL, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                                 ring_fd, IORING_OFF_SQES));
+        if (cq_ptr == MAP_FAILED || sqes == MAP_FAILED) {
+            error = std::string("mmap CQ/SQE: ") + std::strerror(errno);
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_ptr);
+        char* cq = static_cast<char*>(cq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // 请求槽位: user_data 为槽位下标，同时在途的请求不超过提交队列长度，完成队列不会溢出
+        ops.resize(entries);
+        for (unsigned i = 0; i < entries; i++) {
+            free_slots.push_back(entries - 1 - i);
+        }
+
+        // 固定文件: 省去每个请求对文件表的查找与引用计数 (失败时照常按 fd 提交)
+        fixed_file = ::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_FILES, &fd, 1) == 0;
+        return true;
+    }
+
+    const char* name() const { return "io_uring"; }
+
+    long long sizeBytes() const {
+        struct stat st;
+        return ::fstat(fd, &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+    }
+
+    bool resize(long long bytes) { return ::ftruncate(fd, static_cast<off_t>(bytes)) == 0; }
+
+    bool registerBuffer(void* base, size_t length) {
+        if (inflight > 0 || to_submit > 0) {
+            wait();
+        }
+        if (fixed_base != NULL) {
+            ::syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+            fixed_base = NULL;
+            fixed_len = 0;
+        }
+        iovec iov;
+        iov.iov_base = base;
+        iov.iov_len = length;
+        // 登记会锁定这段内存 (受 RLIMIT_MEMLOCK 限制)，失败时照常用普通缓冲区
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) != 0) {
+            return false;
+        }
+        fixed_base = static_cast<char*>(base);
+        fixed_len = length;
+        fixed_pid = ::getpid();
+        return true;
+    }
+
+    bool submitRead(int first_block, int count, void* buf) {
+        return queue(false, first_block, count, static_cast<char*>(buf));
+    }
+
+    bool submitWrite(int first_block, int count, const void* buf) {
+        return queue(true, first_block, count, static_cast<char*>(const_cast<void*>(buf)));
+    }
+
+    int wait() {
+        while (to_submit > 0 || inflight > 0) {
+            if (!enter(inflight > 0 ? 1 : 0)) {
+                failures += static_cast<int>(inflight);
+                break;
+            }
+        }
+        int result = failures;
+        failures = 0;
+        return result;
+    }
+
+    bool flush() {
+        if (to_submit > 0 || inflight > 0) {
+            wait();
+        }
+        return ::fdatasync(fd) == 0;
+    }
+
+private:
+    struct Op {
+        bool write;
+        off_t offset;
+        char* buf;
+        size_t len;
+        iovec iov; // 不走固定缓冲区时的 READV/WRITEV 参数，需在完成前保持有效
+    };
+
+    bool queue(bool write, int first_block, int count, char* buf) {
+        if (first_block < 0 || count <= 0) {
+            return false;
+        }
+        // 登记锁定的是登记时那个进程的物理页: fork 之后子进程改写缓冲区会写时复制到新页，
+        // WRITE_FIXED 仍写出 fork 前的旧内容。进程号变化时先按原地址重新登记
+        if (fixed_base != NULL && fixed_pid != ::getpid()) {
+            registerBuffer(fixed_base, fixed_len);
+        }
+        // 没有空闲槽位时先提交已排队的请求并等待至少一个完成
+        while (free_slots.empty()) {
+            if (!enter(1)) {
+                return false;
+            }
+        }
+        unsigned slot = free_slots.back();
+        free_slots.pop_back();
+        Op& op = ops[slot];
+        op.write = write;
+        op.offset = static_cast<off_t>(first_block) * block_size;
+        op.buf = buf;
+        op.len = static_cast<size_t>(count) * block_size;
+
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        if (fixed_base != NULL && buf >= fixed_base && buf + op.len <= fixed_base + fixed_len) {
+            sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<uint64_t>(buf);
+            sqe->len = static_cast<uint32_t>(op.len);
+            sqe->buf_index = 0;
+        } else {
+            op.iov.iov_base = buf;
+            op.iov.iov_len = op.len;
+            sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->addr = reinterpret_cast<uint64_t>(&op.iov);
+            sqe->len = 1;
+        }
+        if (fixed_file) {
+            sqe->fd = 0; // 固定文件表中的下标
+            sqe->flags |= IOSQE_FIXED_FILE;
+        } else {
+            sqe->fd = fd;
+        }
+        sqe->off = static_cast<uint64_t>(op.offset);
+        sqe->user_data = slot;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        to_submit++;
+        inflight++;
+        stats.requests++;
+
+        // 提交队列满时批量提交一次，不等待完成
+        if (to_submit == entries) {
+            return enter(0);
+        }
+        return true;
+    }
+
+    // 提交排队的请求，并等待至少 min_complete 个完成，然后收割完成队列
+    bool enter(unsigned min_complete) {
+        for (;;) {
+            unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+            long n = ::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            stats.submit_calls++;
+            to_submit -= static_cast<unsigned>(n);
+            break;
+        }
+        reap();
+        return true;
+    }
+
+    void reap() {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cq_mask];
+            unsigned slot = static_cast<unsigned>(cqe.user_data);
+            Op& op = ops[slot];
+            size_t done = cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0;
+            stats.bytes += static_cast<long long>(done);
+            if (cqe.res < 0 || done < op.len) {
+                // 出错或只完成了一部分: 剩余部分同步补做 (普通文件上极少发生)
+                if (cqe.res < 0 || !finishSync(op, done)) {
+                    failures++;
+                }
+            }
+            free_slots.push_back(slot);
+            inflight--;
+            head++;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    bool finishSync(Op& op, size_t done) {
+        while (done < op.len) {
+            ssize_t n = op.write ? ::pwrite(fd, op.buf + done, op.len - done, op.offset + done)
+                                 : ::pread(fd, op.buf + done, op.len - done, op.offset + done);
+            stats.submit_calls++;
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            stats.bytes += n;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd;
+    int block_size;
+    int ring_fd;
+    unsigned entries;
+    void* sq_ptr;
+    void* cq_ptr;
+    size_t sq_len;
+    size_t cq_len;
+    io_uring_sqe* sqes;
+    size_t sqes_len;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+    unsigned to_submit;   // 已填入提交队列、尚未交给内核的请求数
+    unsigned inflight;    // 已占用槽位 (未完成) 的请求数
+    int failures;
+    bool fixed_file;
+    char* fixed_base;
+    size_t fixed_len;
+    pid_t fixed_pid;      // 登记固定缓冲区的进程
+    std::vector<Op> ops;
+    std::vector<unsigned> free_slots;
+};
+
+bool probeIoUring() {
+    if (std::getenv("MINIFS_NO_URING") != NULL) {
+        return false; // 强制使用 pread 后备实现 (测试、排查问题)
+    }
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+    if (ring_fd < 0) {
+        return false;
+    }
+    ::close(ring_fd);
+    return true;
+}
+
+#endif // __linux__
+
+} // namespace
+
+bool ioUringAvailable() {
+#ifdef __linux__
+    static const bool available = probeIoUring();
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<BlockDevice> openBlockDevice(const std::string& path, int block_size, bool create,
+                                             std::string& error, BlockDevice::Kind kind) {
+#ifdef _WIN32
+    if (kind == BlockDevice::IO_URING) {
+        error = "io_uring 只支持 Linux";
+        return std::unique_ptr<BlockDevice>();
+    }
+    FILE* file = std::fopen(path.c_str(), "r+b");
+    bool read_only = false;
+    if (file == NULL && create) {
+        file = std::fopen(path.c_str(), "w+b");
+    } else if (file == NULL && errno == EACCES) {
+        file = std::fopen(path.c_str(), "rb");
+        read_only = true;
+    }
+    if (file == NULL) {
+        error = path + ": " + std::strerror(errno);
+        return std::unique_ptr<BlockDevice>();
+    }
+    return std::unique_ptr<BlockDevice>(new PreadDevice(file, block_size, read_only));
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+    bool read_only = false;
+    if (fd < 0 && !create && (errno == EACCES || errno == EROFS)) {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        read_only = true;
+    }
+    if (fd < 0) {
+        error = path + ": " + std::strerror(errno);
+        return std::unique_ptr<BlockDevice>();
+    }
+#ifdef __linux__
+    if (kind == BlockDevice::IO_URING || (kind == BlockDevice::AUTO && ioUringAvailable())) {
+        std::unique_ptr<UringDevice> dev(new UringDevice(::dup(fd), block_size, read_only));
+        if (dev->init(error)) {
+            ::close(fd);
+            return std::unique_ptr<BlockDevice>(dev.release());
+        }
+        if (kind == BlockDevice::IO_URING) {
+            ::close(fd);
+            return std::unique_ptr<BlockDevice>();
+        }
+    }
+#else
+    if (kind == BlockDevice::IO_URING) {
+        error = "io_uring 只支持 Linux";
+        ::close(fd);
+        return std::unique_ptr<BlockDevice>();
+    }
+#endif
+    return std::unique_ptr<BlockDevice>(new PreadDevice(fd, block_size, read_only));
+#endif
+}
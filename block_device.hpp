@@ -0,0 +1,70 @@
+#ifndef BLOCK_DEVICE_HPP
+#define BLOCK_DEVICE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// 镜像文件的块设备: 以块为单位异步读写宿主文件 (加载镜像、增量写回)
+// 本头文件不依赖 minifs.hpp，block_device.cpp 也不包含它: <linux/io_uring.h> 会带入内核头文件
+//
+// 用法: 连续调用 submitRead/submitWrite 提交请求 (不等待)，再用 wait() 等待全部完成。
+// 提交的缓冲区在 wait() 返回前必须保持有效。
+class BlockDevice {
+public:
+    enum Kind {
+        AUTO,       // 优先 io_uring，不可用时 (内核不支持、被 seccomp 禁止) 退回 pread
+        IO_URING,   // Linux io_uring: 批量提交、固定缓冲区、固定文件
+        PREAD       // 同步 pread/pwrite (Windows 上为 stdio)
+    };
+
+    struct Stats {
+        long requests;      // 提交的读写请求数
+        long submit_calls;  // 进入内核的提交次数 (io_uring_enter 或 pread/pwrite 调用)
+        long long bytes;    // 完成的字节数
+    };
+
+    virtual ~BlockDevice() {}
+
+    virtual const char* name() const = 0;
+    // 镜像文件当前大小 (字节)
+    virtual long long sizeBytes() const = 0;
+    // 把文件扩展或截断到 bytes 字节
+    virtual bool resize(long long bytes) = 0;
+
+    // 登记一块长期有效的缓冲区 (如整个镜像在内存中的副本)，落在其中的请求走固定缓冲区，省去每次的页映射
+    virtual bool registerBuffer(void* base, size_t length) { (void)base; (void)length; return true; }
+
+    // 提交从 first_block 起 count 块的读/写请求，不等待完成；失败 (参数错误) 返回 false
+    virtual bool submitRead(int first_block, int count, void* buf) = 0;
+    virtual bool submitWrite(int first_block, int count, const void* buf) = 0;
+    // 等待全部已提交的请求完成，返回失败的请求数
+    virtual int wait() = 0;
+    // 把已完成的写入持久化到存储 (fdatasync)
+    virtual bool flush() = 0;
+
+    Stats getStats() const { return stats; }
+    // 只读打开 (镜像文件或所在文件系统不可写) 时为 true，此时写请求都会失败
+    bool isReadOnly() const { return read_only; }
+
+protected:
+    explicit BlockDevice(bool read_only) : read_only(read_only) {
+        stats.requests = 0;
+        stats.submit_calls = 0;
+        stats.bytes = 0;
+    }
+
+    Stats stats;
+    bool read_only;
+};
+
+// 打开镜像文件 path 作为块设备 (块大小 block_size)；create 为 true 时不存在则创建
+// create 为 false 且没有写权限 (EACCES/EROFS) 时退回只读打开，见 isReadOnly()
+// kind 为 IO_URING 而 io_uring 不可用时返回空指针；失败时 error 为原因
+std::unique_ptr<BlockDevice> openBlockDevice(const std::string& path, int block_size, bool create,
+                                             std::string& error, BlockDevice::Kind kind = BlockDevice::AUTO);
+
+// 当前系统能否使用 io_uring (结果在首次调用时探测并缓存)
+bool ioUringAvailable();
+
+#endif // BLOCK_DEVICE_HPP
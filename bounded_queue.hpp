@@ -0,0 +1,103 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// 有界无锁多生产者多消费者队列 (Vyukov 环形数组算法)
+// 每个槽位带一个序号: 序号等于入队位置时可写，等于入队位置+1时可读；
+// 生产者和消费者各自用 CAS 抢占位置，不使用互斥锁。容量向上取整为2的幂
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : mask(0), enqueue_pos(0), dequeue_pos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 队列满时返回 false (此时 value 保持不变)，成功时 value 的内容被移入队列
+    bool tryPush(T& value) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 队列空时返回 false
+    bool tryPop(T& out) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 阻塞版本: 满/空时让出CPU后重试 (反压: 下游跟不上时上游自然停下)
+    void push(T value) {
+        while (!tryPush(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void pop(T& out) {
+        while (!tryPop(out)) {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // 生产者和消费者的位置放在不同的缓存行，避免互相干扰
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+};
+
+#endif // BOUNDED_QUEUE_HPP
@@ -37,7 +37,7 @@ echo.
 REM 编译命令
 echo 正在编译...
 %COMPILER_PATH% -std=c++11 -O2 -static -static-libgcc -static-libstdc++ ^
-    main.cpp minifs.cpp fs_tests.cpp shell_utils.cpp user.cpp ^
+    main.cpp minifs.cpp fs_tests.cpp shell_utils.cpp user.cpp crc32c.cpp host_io.cpp import_pipeline.cpp rpc_server.cpp rpc_client.cpp block_device.cpp async_fs.cpp work_stealing.cpp ^
     -o minifs.exe
 
 if %errorlevel% == 0 (
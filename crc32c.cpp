@@ -0,0 +1,117 @@
+#include "crc32c.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_X86_HW 1
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t CRC32C_POLY = 0x82F63B78u; // 0x1EDC6F41 的位反转形式
+
+// slicing-by-8 查找表: table[k][b] 表示字节 b 后面再跟 k 个零字节时的CRC
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : (crc >> 1);
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32cTables& tables() {
+    static const Crc32cTables t; // C++11 保证局部静态变量线程安全地初始化一次
+    return t;
+}
+
+// 软件实现: 每次处理8字节，8张表并行查找
+uint32_t crc32c_sw(uint32_t crc, const unsigned char* p, size_t len) {
+    const Crc32cTables& t = tables();
+    while (len >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);     // 按小端序解释 (x86/ARM 均为小端)
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t.table[7][lo & 0xFF] ^ t.table[6][(lo >> 8) & 0xFF] ^
+              t.table[5][(lo >> 16) & 0xFF] ^ t.table[4][lo >> 24] ^
+              t.table[3][hi & 0xFF] ^ t.table[2][(hi >> 8) & 0xFF] ^
+              t.table[1][(hi >> 16) & 0xFF] ^ t.table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ t.table[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CRC32C_X86_HW
+// 硬件实现: 用 target 属性单独为这个函数打开 SSE4.2，整体编译选项不需要 -msse4.2
+__attribute__((target("sse4.2")))
+uint32_t crc32c_hw(uint32_t crc, const unsigned char* p, size_t len) {
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    while (len >= 4) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        len -= 4;
+    }
+    while (len--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+bool cpu_has_sse42() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+#endif
+
+bool use_hw_crc() {
+#ifdef CRC32C_X86_HW
+    static const bool has_hw = cpu_has_sse42();
+    return has_hw;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t len, uint32_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint32_t crc = ~seed;
+#ifdef CRC32C_X86_HW
+    if (use_hw_crc()) {
+        return ~crc32c_hw(crc, p, len);
+    }
+#endif
+    return ~crc32c_sw(crc, p, len);
+}
+
+const char* crc32cImplName() {
+    return use_hw_crc() ? "sse4.2" : "slicing-by-8";
+}
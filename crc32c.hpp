@@ -0,0 +1,15 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli, 多项式 0x1EDC6F41) 校验和
+// 支持 SSE4.2 的 x86 CPU 上使用硬件 crc32 指令，否则退回查表的 slicing-by-8 实现
+// seed 为上一段数据的CRC结果，可用于分段计算: crc32c(b, nb, crc32c(a, na)) == crc32c(a+b)
+uint32_t crc32c(const void* data, size_t len, uint32_t seed = 0);
+
+// 当前使用的实现名称 ("sse4.2" 或 "slicing-by-8")，用于状态显示
+const char* crc32cImplName();
+
+#endif // CRC32C_HPP
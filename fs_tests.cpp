@@ -2,6 +2,20 @@
 #include "shell_utils.hpp"
 #include "minifs.hpp"
 #include "user.hpp"
+#include "bounded_queue.hpp"
+#include "import_pipeline.hpp"
+#include "rpc_server.hpp"
+#include "rpc_client.hpp"
+#include "async_fs.hpp"
+#include "work_stealing.hpp"
+#include <set>
+#include <climits>
+#include <ctime>
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 void test_bitmap_operations(MiniFS& fs) 
 {
     std::cout << "--- 开始位图操作测试 ---" << std::endl;
@@ -333,4 +347,2062 @@ void test_user_operations(MiniFS& fs) {
     std::cout << "--- 用户管理功能测试结束 ---" << std::endl;
 }
 
+void test_checksum_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始校验和测试 (元数据 + 文件数据) ---" << std::endl;
 
+    // 1. CRC32C 标准测试向量
+    uint32_t check = crc32c("123456789", 9);
+    std::cout << "crc32c(\"123456789\") = 0x" << std::hex << check << std::dec
+              << " [" << crc32cImplName() << "]" << (check == 0xE3069283u ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 当前文件系统的全部元数据应当校验通过
+    int failures = fs.verifyAllMetadata();
+    std::cout << "全量元数据校验失败块数: " << failures << (failures == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 3. 开启数据校验的文件: 写入后巡检应当全部通过
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int file_inum = fs.create(root_inum, "csum_file");
+    int data_block = 0;
+    if (file_inum != MiniFS::INVALID_INUM_CONST && fs.setDataChecksums(file_inum, true) == 0) {
+        int fd = fs.open(root_inum, "csum_file", MiniFS::O_WRONLY);
+        std::string payload(100, 'c'); // 超过内联上限，数据放在数据块中
+        fs.write(fd, payload.c_str(), payload.size());
+        fs.close(fd);
+        int mismatches = fs.scrubOnce();
+        std::cout << "巡检不匹配块数: " << mismatches << (mismatches == 0 ? " (预期)" : " (异常!)") << std::endl;
+        dinode node;
+        fs._get_inode(file_inum, node);
+        data_block = node.addrs[0];
+    } else {
+        std::cout << "创建校验文件失败 (异常!)" << std::endl;
+    }
+
+    // 4. 在镜像文件中翻转i-节点区和文件数据块的各一个位，重新加载后首次读取应当发现
+    const std::string tmp_image = "csum_test.dat";
+    if (fs.saveFS(tmp_image) != 0) {
+        std::cout << "保存临时镜像失败 (异常!)" << std::endl;
+        return;
+    }
+    {
+        std::fstream f(tmp_image, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(INODE_START * BLOCK_SIZE + INODE_SIZE + 8);
+        char c = 0;
+        f.get(c);
+        c ^= 0x10;
+        f.seekp(INODE_START * BLOCK_SIZE + INODE_SIZE + 8);
+        f.put(c);
+        if (data_block != 0) {
+            f.seekg(data_block * BLOCK_SIZE);
+            f.get(c);
+            c ^= 0x01;
+            f.seekp(data_block * BLOCK_SIZE);
+            f.put(c);
+        }
+    }
+
+    MiniFS damaged;
+    damaged.loadFS(tmp_image);
+    long before = damaged.getChecksumStats().failures;
+    dinode root;
+    damaged._get_inode(MiniFS::ROOT_INUM_CONST, root); // 触发i-节点块的首次校验
+    damaged._get_inode(MiniFS::ROOT_INUM_CONST, root); // 已校验过的块不再重复计算
+    long after = damaged.getChecksumStats().failures;
+    std::cout << "损坏镜像读取根i-节点后新增校验失败: " << (after - before)
+              << (after - before == 1 ? " (预期)" : " (异常!)") << std::endl;
+
+    if (data_block != 0) {
+        char buf[64];
+        int fd = damaged.open(root_inum, "csum_file", MiniFS::O_RDONLY);
+        int read_result = damaged.read(fd, buf, sizeof(buf));
+        damaged.close(fd);
+        std::cout << "读取数据被破坏的文件返回: " << read_result << (read_result == -1 ? " (预期)" : " (异常!)") << std::endl;
+        int mismatches = damaged.scrubOnce();
+        // 巡检同时覆盖数据块和元数据: 1 个数据块 + 1 个i-节点块
+        std::cout << "损坏镜像巡检不匹配块数: " << mismatches << (mismatches == 2 ? " (预期)" : " (异常!)") << std::endl;
+        fs.rm(root_inum, "csum_file");
+    }
+
+    std::remove(tmp_image.c_str());
+    std::remove((tmp_image + ".bak").c_str());
+    std::cout << "--- 校验和测试结束 ---" << std::endl;
+}
+
+void test_link_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始硬链接测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    // 1. 创建文件并增加第二个名字
+    int file_inum = fs.create(root_inum, "link_a");
+    if (file_inum == MiniFS::INVALID_INUM_CONST) {
+        std::cout << "创建 link_a 失败 (异常!)" << std::endl;
+        return;
+    }
+    int fd = fs.open(root_inum, "link_a", MiniFS::O_WRONLY);
+    const char* payload = "shared by two names";
+    fs.write(fd, payload, strlen(payload));
+    fs.close(fd);
+
+    int link_result = fs.link(file_inum, root_inum, "link_b");
+    dinode node;
+    fs._get_inode(file_inum, node);
+    std::cout << "link 后链接数: " << node.nlink << (link_result == 0 && node.nlink == 2 ? " (预期)" : " (异常!)") << std::endl;
+    int dup_result = fs.link(file_inum, root_inum, "link_b");
+    std::cout << "重复名称 link 返回: " << dup_result << (dup_result == -1 ? " (预期)" : " (异常!)") << std::endl;
+    int dir_result = fs.link(root_inum, root_inum, "root_link");
+    std::cout << "为目录 link 返回: " << dir_result << (dir_result == -1 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 删除原名后，另一个名字仍能读到数据
+    fs.unlink(root_inum, "link_a");
+    char buf[64] = {0};
+    fd = fs.open(root_inum, "link_b", MiniFS::O_RDONLY);
+    int n = fs.read(fd, buf, sizeof(buf) - 1);
+    bool same = n == static_cast<int>(strlen(payload)) && std::strcmp(buf, payload) == 0;
+    std::cout << "删除 link_a 后通过 link_b 读取: " << (same ? "内容一致 (预期)" : "内容不一致 (异常!)") << std::endl;
+
+    // 3. 删除最后一个名字时文件仍被打开: 推迟到 close 时释放
+    fs.rm(root_inum, "link_b");
+    bool alive = fs._get_inode(file_inum, node);
+    std::cout << "删除最后一个名字但仍打开: i-节点" << (alive ? "保留 (预期)" : "已释放 (异常!)") << std::endl;
+    fs.close(fd);
+    bool freed = !fs._get_inode(file_inum, node);
+    std::cout << "最后一次 close 后: i-节点" << (freed ? "已释放 (预期)" : "仍存在 (异常!)") << std::endl;
+
+    // 4. 带着孤儿保存的镜像，重新加载时回收
+    int orphan_inum = fs.create(root_inum, "link_orphan");
+    fd = fs.open(root_inum, "link_orphan", MiniFS::O_RDONLY);
+    fs.rm(root_inum, "link_orphan");
+    const std::string tmp_image = "link_test.dat";
+    fs.saveFS(tmp_image);
+    {
+        MiniFS reloaded;
+        reloaded.loadFS(tmp_image);
+        bool reclaimed = !reloaded._get_inode(orphan_inum, node);
+        std::cout << "重新加载后孤儿i-节点: " << (reclaimed ? "已回收 (预期)" : "未回收 (异常!)") << std::endl;
+    }
+    fs.close(fd);
+    std::remove(tmp_image.c_str());
+    std::remove((tmp_image + ".bak").c_str());
+    std::cout << "--- 硬链接测试结束 ---" << std::endl;
+}
+
+void test_symlink_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始符号链接测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    int dir_inum = fs.mkdir(root_inum, "sl_dir");
+    int file_inum = fs.create(dir_inum, "f");
+    if (dir_inum == MiniFS::INVALID_INUM_CONST || file_inum == MiniFS::INVALID_INUM_CONST) {
+        std::cout << "创建测试目录/文件失败 (异常!)" << std::endl;
+        return;
+    }
+    int fd = fs.open(dir_inum, "f", MiniFS::O_WRONLY);
+    fs.write(fd, "abc", 3);
+    fs.close(fd);
+
+    // 1. 短目标内联存放，通过链接打开文件
+    int short_inum = fs.symlink(root_inum, "sl_short", "sl_dir/f");
+    dinode node;
+    fs._get_inode(short_inum, node);
+    std::string target;
+    fs.readlink(short_inum, target);
+    std::cout << "短链接目标: " << target << (target == "sl_dir/f" && node.size <= SYMLINK_INLINE_MAX ? " (内联, 预期)" : " (异常!)") << std::endl;
+    char buf[8] = {0};
+    fd = fs.open(root_inum, "sl_short", MiniFS::O_RDONLY);
+    fs.read(fd, buf, 3);
+    fs.close(fd);
+    std::cout << "通过符号链接读取: " << buf << (std::strcmp(buf, "abc") == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 指向目录的链接作为中间组件
+    fs.symlink(root_inum, "sl_dirlink", "/sl_dir");
+    int via_dir = fs.resolve_path_to_inum("sl_dirlink/f", root_inum);
+    std::cout << "解析 sl_dirlink/f: " << via_dir << (via_dir == file_inum ? " (预期)" : " (异常!)") << std::endl;
+
+    // 3. 超过内联长度的目标存放在数据块中
+    std::string long_target = "/sl_dir";
+    while (long_target.size() <= static_cast<size_t>(SYMLINK_INLINE_MAX)) {
+        long_target += "/.";
+    }
+    long_target += "/f";
+    int long_inum = fs.symlink(root_inum, "sl_long", long_target.c_str());
+    fs._get_inode(long_inum, node);
+    int via_long = fs.resolve_path_to_inum("sl_long", root_inum);
+    std::cout << "长链接 (" << node.size << " 字节) 解析: " << via_long
+              << (via_long == file_inum && node.addrs[0] >= DATA_START ? " (预期)" : " (异常!)") << std::endl;
+
+    // 4. 不跟随最后一个组件时得到链接本身
+    int self = fs.resolve_path_to_inum("sl_long", root_inum, false);
+    std::cout << "不跟随时得到链接i-节点: " << self << (self == long_inum ? " (预期)" : " (异常!)") << std::endl;
+
+    // 5. 循环链接在层数上限处失败
+    fs.symlink(root_inum, "sl_loop_a", "sl_loop_b");
+    fs.symlink(root_inum, "sl_loop_b", "sl_loop_a");
+    int loop = fs.resolve_path_to_inum("sl_loop_a", root_inum);
+    std::cout << "循环链接解析结果: " << loop << (loop == MiniFS::INVALID_INUM_CONST ? " (预期)" : " (异常!)") << std::endl;
+
+    // 6. 删除链接不影响目标
+    const char* links[] = {"sl_short", "sl_dirlink", "sl_long", "sl_loop_a", "sl_loop_b"};
+    for (const char* link_name : links) {
+        fs.rm(root_inum, link_name);
+    }
+    bool target_alive = fs._get_inode(file_inum, node);
+    std::cout << "删除链接后目标文件: " << (target_alive ? "仍存在 (预期)" : "已消失 (异常!)") << std::endl;
+    fs.rm(dir_inum, "f");
+    fs.rmdir(root_inum, "sl_dir");
+    std::cout << "--- 符号链接测试结束 ---" << std::endl;
+}
+
+void test_rename_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始重命名测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    // 1. 同一目录内改名
+    int file_inum = fs.create(root_inum, "rn_a");
+    int result = fs.rename(root_inum, "rn_a", root_inum, "rn_b");
+    bool renamed = result == 0 && fs._lookup_in_directory(root_inum, "rn_a") == MiniFS::INVALID_INUM_CONST &&
+                   fs._lookup_in_directory(root_inum, "rn_b") == file_inum;
+    std::cout << "同目录改名 rn_a -> rn_b: " << (renamed ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+
+    // 2. 跨目录移动文件
+    int d1 = fs.mkdir(root_inum, "rn_d1");
+    int d2 = fs.mkdir(root_inum, "rn_d2");
+    result = fs.rename(root_inum, "rn_b", d1, "x");
+    std::cout << "移动文件到 rn_d1/x: " << (result == 0 && fs.resolve_path_to_inum("/rn_d1/x") == file_inum ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+
+    // 3. 跨目录移动目录: .. 与父目录链接数随之更新
+    dinode root_before, d2_node;
+    fs._get_inode(root_inum, root_before);
+    result = fs.rename(root_inum, "rn_d1", d2, "d1");
+    dinode root_after;
+    fs._get_inode(root_inum, root_after);
+    fs._get_inode(d2, d2_node);
+    int dotdot = fs._lookup_in_directory(d1, "..");
+    std::cout << "移动目录后 .. = " << dotdot << ", rn_d2 链接数 = " << d2_node.nlink
+              << (result == 0 && dotdot == d2 && d2_node.nlink == 3 && root_after.nlink == root_before.nlink - 1 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 4. 不能把目录移动到自己的子目录中
+    result = fs.rename(root_inum, "rn_d2", d1, "loop");
+    std::cout << "移动到自身子目录返回: " << result << (result == -1 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 5. 覆盖已存在的文件: 目标名字直接指向新i-节点，旧i-节点被释放
+    int old_inum = fs.create(d2, "y");
+    result = fs.rename(d1, "x", d2, "y");
+    dinode old_node;
+    bool replaced = result == 0 && fs._lookup_in_directory(d2, "y") == file_inum && !fs._get_inode(old_inum, old_node);
+    std::cout << "覆盖 rn_d2/y: " << (replaced ? "成功且旧文件已释放 (预期)" : "失败 (异常!)") << std::endl;
+
+    // 6. 不能用目录覆盖文件
+    result = fs.rename(d2, "d1", d2, "y");
+    std::cout << "用目录覆盖文件返回: " << result << (result == -1 ? " (预期)" : " (异常!)") << std::endl;
+
+    fs.rm(d2, "y");
+    fs.rmdir(d2, "d1");
+    fs.rmdir(root_inum, "rn_d2");
+    std::cout << "--- 重命名测试结束 ---" << std::endl;
+}
+
+void test_truncate_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始截断与追加测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    int file_inum = fs.create(root_inum, "tr_file");
+    int fd = fs.open(root_inum, "tr_file", MiniFS::O_RDWR);
+    std::string payload(1000, 'a');
+    fs.write(fd, payload.c_str(), payload.size());
+
+    // 1. 缩小: 尾部数据块被释放
+    fs.ftruncate(fd, 10);
+    dinode node;
+    fs._get_inode(file_inum, node);
+    std::cout << "截断到10字节: size=" << node.size << ", addrs[1]=" << node.addrs[1]
+              << (node.size == 10 && node.addrs[1] == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 再扩展: 原先的 'a' 不会重新出现
+    fs.truncate(file_inum, 600);
+    char buf[600];
+    int n = fs.read(fd, buf, sizeof(buf));
+    bool zero_tail = n == 600 && buf[9] == 'a' && buf[10] == 0 && buf[599] == 0;
+    std::cout << "扩展到600字节后读取: " << n << (zero_tail ? " 字节, 扩展部分为0 (预期)" : " (异常!)") << std::endl;
+    fs.close(fd);
+
+    // 3. O_TRUNC 打开后文件为空
+    fd = fs.open(root_inum, "tr_file", MiniFS::O_WRONLY | MiniFS::O_TRUNC);
+    fs._get_inode(file_inum, node);
+    std::cout << "O_TRUNC 打开后 size=" << node.size << (node.size == 0 ? " (预期)" : " (异常!)") << std::endl;
+    fs.close(fd);
+
+    // 4. 两个 O_APPEND 描述符交替写入，内容不会互相覆盖
+    int fd1 = fs.open(root_inum, "tr_file", MiniFS::O_WRONLY | MiniFS::O_APPEND);
+    int fd2 = fs.open(root_inum, "tr_file", MiniFS::O_WRONLY | MiniFS::O_APPEND);
+    fs.write(fd1, "x", 1);
+    fs.write(fd2, "y", 1);
+    fs.write(fd1, "z", 1);
+    fs.close(fd1);
+    fs.close(fd2);
+    fd = fs.open(root_inum, "tr_file", MiniFS::O_RDONLY);
+    char abuf[8] = {0};
+    fs.read(fd, abuf, sizeof(abuf) - 1);
+    fs.close(fd);
+    std::cout << "O_APPEND 交替写入结果: " << abuf << (std::strcmp(abuf, "xyz") == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 5. 只读打开: O_TRUNC 不生效，ftruncate 被拒绝
+    fd = fs.open(root_inum, "tr_file", MiniFS::O_RDONLY | MiniFS::O_TRUNC);
+    fs._get_inode(file_inum, node);
+    int ro_trunc = fs.ftruncate(fd, 1);
+    dinode ro_node;
+    fs._get_inode(file_inum, ro_node);
+    fs.close(fd);
+    std::cout << "O_RDONLY|O_TRUNC 打开后 size=" << node.size << ", 只读 ftruncate 返回 " << ro_trunc
+              << (node.size == 3 && ro_trunc == -1 && ro_node.size == 3 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 6. 保存用户数据时原地重写 /etc/passwd
+    fs.saveUserData();
+    int passwd_before = fs.resolve_path_to_inum("/etc/passwd");
+    fs.saveUserData();
+    int passwd_after = fs.resolve_path_to_inum("/etc/passwd");
+    std::cout << "两次保存用户数据 /etc/passwd i-节点: " << passwd_before << " -> " << passwd_after
+              << (passwd_before == passwd_after && passwd_after != MiniFS::INVALID_INUM_CONST ? " (预期)" : " (异常!)") << std::endl;
+
+    fs.rm(root_inum, "tr_file");
+    std::cout << "--- 截断与追加测试结束 ---" << std::endl;
+}
+
+void test_sparse_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始稀疏文件测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    int file_inum = fs.create(root_inum, "sp_file");
+    int fd = fs.open(root_inum, "sp_file", MiniFS::O_RDWR);
+
+    // 1. 在高偏移处写入，中间的块不分配 (开头的内联数据迁出到第0块)
+    fs.write(fd, "head", 4);
+    fs.lseek(fd, 3 * BLOCK_SIZE + 10, MiniFS::LSEEK_SET);
+    fs.write(fd, "tail", 4);
+    dinode node;
+    fs._get_inode(file_inum, node);
+    std::cout << "高偏移写入后 size=" << node.size << ", addrs[1]=" << node.addrs[1] << ", addrs[2]=" << node.addrs[2]
+              << (node.size == 3 * BLOCK_SIZE + 14 && node.addrs[1] == 0 && node.addrs[2] == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 空洞读出为0
+    std::vector<char> buf(node.size, 'x');
+    int n = fs.read(fd, buf.data(), node.size);
+    bool holes_zero = n == node.size && std::memcmp(buf.data(), "head", 4) == 0 && buf[BLOCK_SIZE] == 0 && buf[3 * BLOCK_SIZE - 1] == 0 &&
+                      std::memcmp(buf.data() + 3 * BLOCK_SIZE + 10, "tail", 4) == 0;
+    std::cout << "读取整个稀疏文件: " << (holes_zero ? "空洞为0，尾部数据正确 (预期)" : "内容错误 (异常!)") << std::endl;
+    char part[4] = {0};
+    n = fs.pread(fd, part, 4, 3 * BLOCK_SIZE + 10);
+    std::cout << "pread 尾部: " << std::string(part, 4) << (n == 4 && std::memcmp(part, "tail", 4) == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 3. SEEK_DATA/SEEK_HOLE
+    int hole0 = fs.lseek(fd, 0, MiniFS::LSEEK_HOLE);
+    int data1 = fs.lseek(fd, BLOCK_SIZE, MiniFS::LSEEK_DATA);
+    int hole3 = fs.lseek(fd, 3 * BLOCK_SIZE, MiniFS::LSEEK_HOLE);
+    std::cout << "SEEK_HOLE(0)=" << hole0 << ", SEEK_DATA(" << BLOCK_SIZE << ")=" << data1 << ", SEEK_HOLE(" << 3 * BLOCK_SIZE << ")=" << hole3
+              << (hole0 == BLOCK_SIZE && data1 == 3 * BLOCK_SIZE && hole3 == node.size ? " (预期)" : " (异常!)") << std::endl;
+
+    // 4. 预分配填上空洞，打洞再释放
+    fs.fallocate(fd, MiniFS::FALLOC_KEEP_SIZE, BLOCK_SIZE, BLOCK_SIZE);
+    int hole_after_alloc = fs.lseek(fd, 0, MiniFS::LSEEK_HOLE);
+    std::cout << "预分配第1块后 SEEK_HOLE(0)=" << hole_after_alloc << (hole_after_alloc == 2 * BLOCK_SIZE ? " (预期)" : " (异常!)") << std::endl;
+    fs.fallocate(fd, MiniFS::FALLOC_PUNCH_HOLE, 0, 2 * BLOCK_SIZE);
+    fs._get_inode(file_inum, node);
+    int data_after_punch = fs.lseek(fd, 0, MiniFS::LSEEK_DATA);
+    std::cout << "打洞后 SEEK_DATA(0)=" << data_after_punch << ", size=" << node.size
+              << (data_after_punch == 3 * BLOCK_SIZE && node.addrs[0] == 0 && node.size == 3 * BLOCK_SIZE + 14 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 5. 不带 KEEP_SIZE 的预分配会扩展文件
+    fs.fallocate(fd, 0, node.size, 100);
+    fs._get_inode(file_inum, node);
+    std::cout << "预分配扩展后 size=" << node.size << (node.size == 3 * BLOCK_SIZE + 114 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 6. offset + length 超出 int 范围的请求被拒绝 (内联文件打洞曾因溢出越界清零)
+    int small_fd = fs.open(root_inum, "sp_small", MiniFS::O_CREATE | MiniFS::O_RDWR);
+    fs.write(small_fd, "inline", 6);
+    int huge_punch = fs.fallocate(small_fd, MiniFS::FALLOC_PUNCH_HOLE, 1, INT_MAX);
+    int huge_alloc = fs.fallocate(fd, 0, 1, INT_MAX);
+    char small_back[6] = {0};
+    fs.pread(small_fd, small_back, 6, 0);
+    std::cout << "fallocate(1, INT_MAX): 打洞 " << huge_punch << ", 预分配 " << huge_alloc
+              << (huge_punch == -1 && huge_alloc == -1 && std::memcmp(small_back, "inline", 6) == 0 ? " (预期)" : " (异常!)")
+              << std::endl;
+    fs.close(small_fd);
+    fs.rm(root_inum, "sp_small");
+
+    // 7. 只读描述符不能打洞或预分配
+    dinode before_ro;
+    fs._get_inode(fs._lookup_in_directory(root_inum, "sp_file"), before_ro);
+    int ro_fd = fs.open(root_inum, "sp_file", MiniFS::O_RDONLY);
+    int ro_punch = fs.fallocate(ro_fd, MiniFS::FALLOC_PUNCH_HOLE | MiniFS::FALLOC_KEEP_SIZE, 0, BLOCK_SIZE);
+    int ro_alloc = fs.fallocate(ro_fd, 0, 0, 8 * BLOCK_SIZE);
+    fs.close(ro_fd);
+    dinode after_ro;
+    fs._get_inode(fs._lookup_in_directory(root_inum, "sp_file"), after_ro);
+    bool ro_same = after_ro.size == before_ro.size && std::memcmp(after_ro.addrs, before_ro.addrs, sizeof(after_ro.addrs)) == 0;
+    std::cout << "只读描述符 fallocate: 打洞 " << ro_punch << ", 预分配 " << ro_alloc
+              << (ro_punch == -1 && ro_alloc == -1 && ro_same ? ", 文件不变 (预期)" : " (异常!)") << std::endl;
+
+    fs.close(fd);
+    fs.rm(root_inum, "sp_file");
+    std::cout << "--- 稀疏文件测试结束 ---" << std::endl;
+}
+
+void test_inline_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始内联小文件测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int free_before = fs.countFreeBlocks();
+
+    // 1. 创建并写入小文件不占用数据块
+    int file_inum = fs.create(root_inum, "il_file");
+    int fd = fs.open(root_inum, "il_file", MiniFS::O_RDWR);
+    fs.write(fd, "tiny config", 11);
+    dinode node;
+    fs._get_inode(file_inum, node);
+    int free_small = fs.countFreeBlocks();
+    std::cout << "写入11字节后空闲块变化: " << (free_small - free_before)
+              << ((node.flags & INODE_FLAG_INLINE) && free_small == free_before ? " (内联, 预期)" : " (异常!)") << std::endl;
+    char buf[64] = {0};
+    fs.read(fd, buf, sizeof(buf) - 1);
+    std::cout << "读取内联数据: " << buf << (std::strcmp(buf, "tiny config") == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 超过内联上限后迁出到一个数据块，已有内容保留
+    std::string more(INLINE_DATA_MAX, '+');
+    fs.write(fd, more.c_str(), more.size());
+    fs._get_inode(file_inum, node);
+    std::memset(buf, 0, sizeof(buf));
+    int n = fs.read(fd, buf, sizeof(buf) - 1);
+    bool spilled = !(node.flags & INODE_FLAG_INLINE) && fs.countFreeBlocks() == free_before - 1 &&
+                   n == 11 + INLINE_DATA_MAX && std::strncmp(buf, "tiny config+", 12) == 0;
+    std::cout << "迁出后大小 " << node.size << (spilled ? ", 占用1个数据块, 内容完整 (预期)" : " (异常!)") << std::endl;
+    fs.close(fd);
+
+    // 3. 截断为0后释放数据块并恢复内联
+    fd = fs.open(root_inum, "il_file", MiniFS::O_WRONLY | MiniFS::O_TRUNC);
+    fs.close(fd);
+    fs._get_inode(file_inum, node);
+    std::cout << "O_TRUNC 后: " << ((node.flags & INODE_FLAG_INLINE) && fs.countFreeBlocks() == free_before ? "恢复内联且数据块已释放 (预期)" : "(异常!)") << std::endl;
+
+    fs.rm(root_inum, "il_file");
+    std::cout << "删除后空闲块: " << fs.countFreeBlocks() << (fs.countFreeBlocks() == free_before ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "--- 内联小文件测试结束 ---" << std::endl;
+}
+
+void test_lazy_zero_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始延迟清零测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+
+    // 1. 整块追加: 每块只写一次，不读旧内容也不预先清零
+    int file_inum = fs.create(root_inum, "lz_file");
+    int fd = fs.open(root_inum, "lz_file", MiniFS::O_RDWR);
+    std::string blocks(2 * BLOCK_SIZE, 'q');
+    MiniFS::IOStats before = fs.getIOStats();
+    fs.write(fd, blocks.c_str(), blocks.size());
+    MiniFS::IOStats after = fs.getIOStats();
+    long data_writes = after.data_writes - before.data_writes;
+    long data_reads = after.data_reads - before.data_reads;
+    std::cout << "追加2个整块: 数据块写 " << data_writes << " 次, 读 " << data_reads << " 次"
+              << (data_writes == 2 && data_reads == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 留下一块带旧数据的空闲块，再预分配: 读出为0而不是旧数据，且不读盘
+    int junk_inum = fs.create(root_inum, "lz_junk");
+    int junk_fd = fs.open(root_inum, "lz_junk", MiniFS::O_WRONLY);
+    std::string junk(BLOCK_SIZE, 'Z');
+    fs.write(junk_fd, junk.c_str(), junk.size());
+    fs.close(junk_fd);
+    dinode junk_node;
+    fs._get_inode(junk_inum, junk_node);
+    int junk_block = junk_node.addrs[0];
+    fs.rm(root_inum, "lz_junk");
+
+    fs.fallocate(fd, 0, 2 * BLOCK_SIZE, BLOCK_SIZE);
+    dinode node;
+    fs._get_inode(file_inum, node);
+    char buf[BLOCK_SIZE];
+    before = fs.getIOStats();
+    int n = fs.pread(fd, buf, BLOCK_SIZE, 2 * BLOCK_SIZE);
+    after = fs.getIOStats();
+    bool zeros = n == BLOCK_SIZE && buf[0] == 0 && buf[BLOCK_SIZE - 1] == 0;
+    std::cout << "预分配块 (复用旧块 " << (node.addrs[2] == junk_block ? "是" : "否") << ") 读取: "
+              << (zeros && after.data_reads == before.data_reads ? "全0且未读盘 (预期)" : "(异常!)") << std::endl;
+
+    // 3. 部分写入未写入块: 其余部分补0
+    fs.lseek(fd, 2 * BLOCK_SIZE, MiniFS::LSEEK_SET);
+    fs.write(fd, "ab", 2);
+    fs._get_inode(file_inum, node);
+    n = fs.pread(fd, buf, BLOCK_SIZE, 2 * BLOCK_SIZE);
+    bool partial = n == BLOCK_SIZE && buf[0] == 'a' && buf[1] == 'b' && buf[2] == 0 && buf[BLOCK_SIZE - 1] == 0 &&
+                   !(node.unwritten & (1u << 2));
+    std::cout << "部分写入后: " << (partial ? "写入部分正确，其余为0 (预期)" : "(异常!)") << std::endl;
+
+    // 4. 分配后立即整块写入的单块分配 (目录、内联数据迁出) 不再先写一次全0块
+    before = fs.getIOStats();
+    int lz_dir = fs.mkdir(root_inum, "lz_dir");
+    after = fs.getIOStats();
+    long mkdir_writes = after.data_writes - before.data_writes;
+    int small_fd = fs.open(lz_dir, "s", MiniFS::O_CREATE | MiniFS::O_RDWR);
+    fs.write(small_fd, "0123456789", 10);
+    std::string spill(40, 's');
+    before = fs.getIOStats();
+    fs.write(small_fd, spill.c_str(), spill.size());
+    after = fs.getIOStats();
+    long spill_writes = after.data_writes - before.data_writes;
+    fs.close(small_fd);
+    std::cout << "mkdir 数据块写 " << mkdir_writes << " 次, 内联迁出并写入数据块写 " << spill_writes << " 次"
+              << (mkdir_writes == 2 && spill_writes == 2 ? " (预期)" : " (异常!)") << std::endl;
+    fs.rm(lz_dir, "s");
+    fs.rmdir(root_inum, "lz_dir");
+
+    fs.close(fd);
+    fs.rm(root_inum, "lz_file");
+    std::cout << "--- 延迟清零测试结束 ---" << std::endl;
+}
+
+void test_batch_alloc_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始批量分配测试 ---" << std::endl;
+    int free_before = fs.countFreeBlocks();
+
+    // 1. 一次分配10个数据块: 只写一次位图块，尽量连续
+    std::vector<MiniFS::BlockSpan> spans;
+    MiniFS::IOStats before = fs.getIOStats();
+    int got = fs.balloc_n(10, 0, spans, false);
+    MiniFS::IOStats after = fs.getIOStats();
+    long bitmap_writes = after.meta_writes - before.meta_writes;
+    std::cout << "balloc_n(10): 分配 " << got << " 块, " << spans.size() << " 个区间, 位图写 " << bitmap_writes << " 次"
+              << (got == 10 && bitmap_writes == 1 && fs.countFreeBlocks() == free_before - 10 ? " (预期)" : " (异常!)") << std::endl;
+    bool all_set = true;
+    for (const MiniFS::BlockSpan& span : spans) {
+        for (int b = span.start; b < span.start + span.count; b++) {
+            all_set = all_set && fs.test_bit(DATA_BITMAP_BLOCK_START, b - DATA_START);
+        }
+    }
+    std::cout << "区间内的位全部置1: " << (all_set ? "是 (预期)" : "否 (异常!)") << std::endl;
+    for (const MiniFS::BlockSpan& span : spans) {
+        for (int b = span.start; b < span.start + span.count; b++) {
+            fs.bfree(b);
+        }
+    }
+
+    // 2. 批量分配i-节点
+    std::vector<int> inums;
+    got = fs.ialloc_n(5, T_FILE, inums);
+    bool distinct = got == 5;
+    for (size_t i = 0; i < inums.size(); i++) {
+        dinode node;
+        distinct = distinct && fs._get_inode(inums[i], node) && node.type == T_FILE;
+        for (size_t j = 0; j < i; j++) {
+            distinct = distinct && inums[i] != inums[j];
+        }
+    }
+    std::cout << "ialloc_n(5): " << (distinct ? "5 个不同的文件i-节点 (预期)" : "(异常!)") << std::endl;
+    for (int inum : inums) {
+        fs.ifree(inum);
+    }
+
+    // 3. 大块写入: 位图和i-节点各写一次
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    fs.create(root_inum, "ba_file");
+    int fd = fs.open(root_inum, "ba_file", MiniFS::O_WRONLY);
+    std::string data(8 * BLOCK_SIZE, 'b');
+    before = fs.getIOStats();
+    int written = fs.write(fd, data.c_str(), data.size());
+    after = fs.getIOStats();
+    long meta_writes = after.meta_writes - before.meta_writes;
+    std::cout << "写入8个块: 元数据块写 " << meta_writes << " 次" << (written == 8 * BLOCK_SIZE && meta_writes == 2 ? " (预期)" : " (异常!)") << std::endl;
+    fs.close(fd);
+    fs.rm(root_inum, "ba_file");
+    std::cout << "释放后空闲块: " << fs.countFreeBlocks() << (fs.countFreeBlocks() == free_before ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "--- 批量分配测试结束 ---" << std::endl;
+}
+
+// 比较两棵 HostNode 树 (名称、类型、内容、子项顺序) 是否相同
+static bool same_host_tree(const HostNode& a, const HostNode& b) {
+    if (a.kind != b.kind || a.name != b.name || a.data != b.data || a.children.size() != b.children.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.children.size(); i++) {
+        if (!same_host_tree(a.children[i], b.children[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 逐个文件调用 mkdir/create/open/write/close/symlink 生成同样的树 (与批量导入对比)
+static void build_tree_with_api(MiniFS& fs, int dir_inum, const HostNode& dir) {
+    for (const HostNode& child : dir.children) {
+        if (child.kind == HostNode::DIR_NODE) {
+            build_tree_with_api(fs, fs.mkdir(dir_inum, child.name.c_str()), child);
+        } else if (child.kind == HostNode::SYMLINK_NODE) {
+            fs.symlink(dir_inum, child.name.c_str(), child.data.c_str());
+        } else {
+            fs.create(dir_inum, child.name.c_str());
+            int fd = fs.open(dir_inum, child.name.c_str(), MiniFS::O_WRONLY);
+            fs.write(fd, child.data.data(), child.data.size());
+            fs.close(fd);
+        }
+    }
+}
+
+// 删除目录 dir_inum 下与 dir 对应的全部内容
+static void remove_tree_with_api(MiniFS& fs, int dir_inum, const HostNode& dir) {
+    for (const HostNode& child : dir.children) {
+        if (child.kind == HostNode::DIR_NODE) {
+            remove_tree_with_api(fs, fs._lookup_in_directory(dir_inum, child.name), child);
+            fs.rmdir(dir_inum, child.name.c_str());
+        } else {
+            fs.unlink(dir_inum, child.name.c_str());
+        }
+    }
+}
+
+void test_bulk_import_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始批量导入/导出测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int free_before = fs.countFreeBlocks();
+
+    // 构造一棵树: 内联小文件、中间有全0块的文件、10个两块大小的文件、符号链接
+    HostNode tree;
+    tree.kind = HostNode::DIR_NODE;
+    HostNode small;
+    small.name = "a.txt";
+    small.data = "hello";
+    HostNode big;
+    big.name = "big.bin";
+    big.data = std::string(BLOCK_SIZE, 'x') + std::string(BLOCK_SIZE, '\0') + std::string(BLOCK_SIZE + 10, 'y');
+    HostNode link;
+    link.kind = HostNode::SYMLINK_NODE;
+    link.name = "link";
+    link.data = "sub/f0";
+    HostNode sub;
+    sub.kind = HostNode::DIR_NODE;
+    sub.name = "sub";
+    for (int i = 0; i < 10; i++) {
+        HostNode f;
+        f.name = "f" + std::to_string(i);
+        f.data = std::string(BLOCK_SIZE + 88, static_cast<char>('0' + i));
+        sub.children.push_back(f);
+    }
+    tree.children.push_back(small);
+    tree.children.push_back(big);
+    tree.children.push_back(link);
+    tree.children.push_back(sub);
+
+    // 1. 批量导入与逐个文件调用的对比
+    int bulk_dir = fs.mkdir(root_inum, "bulk");
+    int api_dir = fs.mkdir(root_inum, "bulk_api");
+    MiniFS::IOStats before = fs.getIOStats();
+    auto t0 = std::chrono::steady_clock::now();
+    int imported = fs.bulkImport(tree, bulk_dir);
+    auto t1 = std::chrono::steady_clock::now();
+    MiniFS::IOStats mid = fs.getIOStats();
+    build_tree_with_api(fs, api_dir, tree);
+    auto t2 = std::chrono::steady_clock::now();
+    MiniFS::IOStats after = fs.getIOStats();
+    long bulk_writes = (mid.meta_writes + mid.data_writes) - (before.meta_writes + before.data_writes);
+    long api_writes = (after.meta_writes + after.data_writes) - (mid.meta_writes + mid.data_writes);
+    std::cout << "批量导入 " << imported << " 个i-节点: 写块 " << bulk_writes << " 次, "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us; 逐个调用: 写块 "
+              << api_writes << " 次, " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+              << (imported == 14 && bulk_writes * 3 < api_writes ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 布局: 同一目录的子项i-节点连续，文件数据块连续，全0块成为空洞
+    int f0 = fs.resolve_path_to_inum("/bulk/sub/f0");
+    int f1 = fs.resolve_path_to_inum("/bulk/sub/f1");
+    dinode n0, n1, nbig;
+    fs._get_inode(f0, n0);
+    fs._get_inode(f1, n1);
+    fs._get_inode(fs.resolve_path_to_inum("/bulk/big.bin"), nbig);
+    std::cout << "i-节点连续 (" << f0 << ", " << f1 << "), 数据块连续 (" << n0.addrs[0] << ", " << n0.addrs[1] << ", "
+              << n1.addrs[0] << ")"
+              << (f1 == f0 + 1 && n0.addrs[1] == n0.addrs[0] + 1 && n1.addrs[0] == n0.addrs[1] + 1 ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "全0块导入为空洞: " << (nbig.addrs[1] == 0 && nbig.addrs[2] != 0 ? "是 (预期)" : "否 (异常!)") << std::endl;
+    dinode nsmall;
+    fs._get_inode(fs.resolve_path_to_inum("/bulk/a.txt"), nsmall);
+    std::cout << "小文件内联: " << ((nsmall.flags & INODE_FLAG_INLINE) ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::cout << "符号链接可跟随: " << (fs.resolve_path_to_inum("/bulk/link") == f0 ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::cout << "一致性检查: " << (fs.checkFSConsistency() == 0 ? "通过 (预期)" : "失败 (异常!)") << std::endl;
+
+    // 3. 导出后与原树一致，两种方式生成的内容相同
+    HostNode exported, exported_api;
+    fs.bulkExport(bulk_dir, exported);
+    fs.bulkExport(api_dir, exported_api);
+    std::cout << "导出结果与原树一致: " << (same_host_tree(exported, tree) && same_host_tree(exported_api, tree) ? "是 (预期)" : "否 (异常!)") << std::endl;
+
+    // 4. 宿主文件系统往返
+    std::string error;
+    const std::string host_dir = "bulk_host_tmp";
+    removeHostTree(host_dir);
+    HostNode reread;
+    bool host_ok = writeHostTree(host_dir, exported, error) && readHostTree(host_dir, reread, error);
+    std::cout << "写到宿主目录再读回: " << (host_ok && same_host_tree(reread, tree) ? "一致 (预期)" : "不一致 (异常!) " + error) << std::endl;
+    removeHostTree(host_dir);
+
+    // 5. 放不下或重名时整体失败，不修改镜像
+    int free_mid = fs.countFreeBlocks();
+    HostNode too_big;
+    too_big.kind = HostNode::DIR_NODE;
+    too_big.children.push_back(big);
+    too_big.children.back().data = std::string(9 * BLOCK_SIZE, 'z');
+    int rc_big = fs.bulkImport(too_big, root_inum);
+    int rc_dup = fs.bulkImport(tree, bulk_dir);
+    std::cout << "超出限制/重名时拒绝导入: " << rc_big << ", " << rc_dup
+              << (rc_big == -1 && rc_dup == -1 && fs.countFreeBlocks() == free_mid ? " (预期)" : " (异常!)") << std::endl;
+
+    remove_tree_with_api(fs, bulk_dir, tree);
+    remove_tree_with_api(fs, api_dir, tree);
+    fs.rmdir(root_inum, "bulk");
+    fs.rmdir(root_inum, "bulk_api");
+    std::cout << "删除后空闲块: " << fs.countFreeBlocks() << (fs.countFreeBlocks() == free_before ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "--- 批量导入/导出测试结束 ---" << std::endl;
+}
+
+void test_pipeline_import_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始流水线导入测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int free_before = fs.countFreeBlocks();
+
+    // 1. 有界无锁队列: 4个生产者、4个消费者经过容量为16的队列，总和不变
+    BoundedQueue<int> queue(16);
+    std::atomic<long> consumed_sum(0);
+    std::atomic<int> consumed_count(0);
+    const int per_producer = 20000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; p++) {
+        threads.push_back(std::thread([&queue, p]() {
+            for (int i = 1; i <= per_producer; i++) {
+                queue.push(p * per_producer + i);
+            }
+        }));
+    }
+    for (int c = 0; c < 4; c++) {
+        threads.push_back(std::thread([&]() {
+            for (;;) {
+                int value;
+                queue.pop(value);
+                if (value < 0) {
+                    break;
+                }
+                consumed_sum += value;
+                consumed_count++;
+            }
+        }));
+    }
+    for (int p = 0; p < 4; p++) {
+        threads[p].join();
+    }
+    for (int c = 0; c < 4; c++) {
+        queue.push(-1);
+    }
+    for (int c = 4; c < 8; c++) {
+        threads[c].join();
+    }
+    long n = 4L * per_producer;
+    std::cout << "无锁队列: 收到 " << consumed_count << " 个, 总和 " << consumed_sum
+              << (consumed_count == n && consumed_sum == n * (n + 1) / 2 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 在宿主上准备一棵目录树，用小队列迫使各级之间产生反压
+    HostNode tree;
+    tree.kind = HostNode::DIR_NODE;
+    for (int d = 0; d < 2; d++) {
+        HostNode dir;
+        dir.kind = HostNode::DIR_NODE;
+        dir.name = "d" + std::to_string(d);
+        for (int i = 0; i < 12; i++) {
+            HostNode f;
+            f.name = "f" + std::to_string(i);
+            f.data = std::string(i * 150 + 1, static_cast<char>('a' + i));
+            if (i == 11) {
+                f.data.replace(0, BLOCK_SIZE, BLOCK_SIZE, '\0'); // 第0块全0，应成为空洞
+            }
+            dir.children.push_back(f);
+        }
+        tree.children.push_back(dir);
+    }
+    HostNode link;
+    link.kind = HostNode::SYMLINK_NODE;
+    link.name = "link";
+    link.data = "d0/f1";
+    tree.children.push_back(link);
+
+    std::string error;
+    const std::string host_dir = "pipeline_host_tmp";
+    removeHostTree(host_dir);
+    if (!writeHostTree(host_dir, tree, error)) {
+        std::cout << "准备宿主目录失败 (异常!) " << error << std::endl;
+        return;
+    }
+    HostNode expected;
+    readHostTree(host_dir, expected, error);
+
+    int dest = fs.mkdir(root_inum, "pipe");
+    PipelineOptions options;
+    options.reader_threads = 3;
+    options.writer_threads = 2;
+    options.queue_capacity = 2;
+    PipelineStats stats;
+    int created = pipelineImport(fs, host_dir, dest, options, &stats);
+    std::cout << "流水线导入: " << created << " 个i-节点, " << stats.files << " 个文件, " << stats.blocks << " 个数据块"
+              << (created == 27 && stats.files == 24 && stats.failed_files == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 3. 内容、空洞与连续性
+    HostNode exported;
+    fs.bulkExport(dest, exported);
+    std::cout << "导出结果与宿主目录一致: " << (same_host_tree(exported, expected) ? "是 (预期)" : "否 (异常!)") << std::endl;
+    dinode big, holey;
+    fs._get_inode(fs.resolve_path_to_inum("/pipe/d1/f10"), big);
+    fs._get_inode(fs.resolve_path_to_inum("/pipe/d1/f11"), holey);
+    bool contiguous = big.addrs[0] != 0 && big.addrs[1] == big.addrs[0] + 1 && big.addrs[2] == big.addrs[1] + 1;
+    std::cout << "多块文件的数据块连续: " << (contiguous ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::cout << "全0块导入为空洞: " << (holey.addrs[0] == 0 && holey.addrs[1] != 0 ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::cout << "一致性检查: " << (fs.checkFSConsistency() == 0 ? "通过 (预期)" : "失败 (异常!)") << std::endl;
+
+    // 4. 结构检查失败时不修改镜像
+    int free_mid = fs.countFreeBlocks();
+    int rc = pipelineImport(fs, host_dir, dest, options, nullptr);
+    std::cout << "重名时拒绝导入: " << rc << (rc == -1 && fs.countFreeBlocks() == free_mid ? " (预期)" : " (异常!)") << std::endl;
+
+    remove_tree_with_api(fs, dest, tree);
+    fs.rmdir(root_inum, "pipe");
+    removeHostTree(host_dir);
+    std::cout << "删除后空闲块: " << fs.countFreeBlocks() << (fs.countFreeBlocks() == free_before ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "--- 流水线导入测试结束 ---" << std::endl;
+}
+
+void test_batch_shell_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始批处理模式测试 ---" << std::endl;
+    const std::string image = "batch_test_tmp.dat";
+    std::remove(image.c_str());
+
+    // 密码和多行写入的内容也从脚本中读取；save 被合并到结束时
+    std::istringstream script(
+        "# 批处理脚本\n"
+        "login root\n"
+        "root\n"
+        "\n"
+        "mkdir /batch\n"
+        "create /batch/f\n"
+        "open /batch/f w\n"
+        "write 0 $\n"
+        "line one\n"
+        "line two\n"
+        ".\n"
+        "save\n"
+        "close 0\n"
+        "save\n"
+        "logout\n"
+        "exit\n"
+        "mkdir /not_run\n");
+    BatchOptions options;
+    options.save_at_end = true;
+    int executed = runBatchShell(fs, image, script, options);
+    std::cout << "执行命令数: " << executed << (executed == 7 ? " (预期)" : " (异常!)") << std::endl;
+
+    int inum = fs.resolve_path_to_inum("/batch/f");
+    dinode node;
+    bool content_ok = inum != MiniFS::INVALID_INUM_CONST && fs._get_inode(inum, node) &&
+                      node.size == static_cast<int>(std::string("line one\nline two\n").size());
+    std::cout << "脚本中的多行写入: " << (content_ok ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+    std::cout << "exit 之后的命令未执行: "
+              << (fs.resolve_path_to_inum("/not_run") == MiniFS::INVALID_INUM_CONST ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::ifstream saved(image.c_str(), std::ios::binary);
+    std::cout << "结束时保存镜像: " << (saved ? "是 (预期)" : "否 (异常!)") << std::endl;
+    std::cout << "批处理结束后已登出: " << (!fs.isLoggedIn() ? "是 (预期)" : "否 (异常!)") << std::endl;
+    saved.close();
+    std::remove(image.c_str());
+
+    fs.unlink(fs.resolve_path_to_inum("/batch"), "f");
+    fs.rmdir(MiniFS::ROOT_INUM_CONST, "batch");
+    std::cout << "--- 批处理模式测试结束 ---" << std::endl;
+}
+
+void test_cwd_cache_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始当前目录路径缓存测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    bool was_logged_in = fs.isLoggedIn();
+    if (!was_logged_in) {
+        fs.login("root", "root");
+    }
+    std::istringstream no_input;
+    int cw = fs.mkdir(root_inum, "cw");
+    int a = fs.mkdir(cw, "a");
+    fs.mkdir(a, "b");
+    fs.symlink(cw, "lnk", "a/b");
+
+    auto cd = [&](const std::string& path) {
+        std::vector<std::string> tokens;
+        tokens.push_back("cd");
+        tokens.push_back(path);
+        executeCommand(fs, "", tokens, no_input);
+    };
+
+    cd("/cw/a/b");
+    std::string path = getShellCwdPath(fs);
+    MiniFS::IOStats before = fs.getIOStats();
+    path = getShellCwdPath(fs);
+    MiniFS::IOStats after = fs.getIOStats();
+    long reads = (after.meta_reads + after.data_reads) - (before.meta_reads + before.data_reads);
+    std::cout << "cd /cw/a/b 后路径: " << path << ", 再次取路径读块 " << reads << " 次"
+              << (path == "/cw/a/b" && reads == 0 ? " (预期)" : " (异常!)") << std::endl;
+
+    cd("..");
+    std::string up = getShellCwdPath(fs);
+    cd("b/../b/./");
+    std::string back = getShellCwdPath(fs);
+    std::cout << "增量更新 (.. 与相对路径): " << up << ", " << back
+              << (up == "/cw/a" && back == "/cw/a/b" ? " (预期)" : " (异常!)") << std::endl;
+
+    cd("/cw/lnk");
+    std::string via_link = getShellCwdPath(fs);
+    std::cout << "经符号链接进入后显示真实路径: " << via_link << (via_link == "/cw/a/b" ? " (预期)" : " (异常!)") << std::endl;
+
+    std::vector<std::string> mv;
+    mv.push_back("mv");
+    mv.push_back("/cw/a");
+    mv.push_back("/cw/z");
+    executeCommand(fs, "", mv, no_input);
+    std::string renamed = getShellCwdPath(fs);
+    std::cout << "重命名上级目录后路径: " << renamed << (renamed == "/cw/z/b" ? " (预期)" : " (异常!)") << std::endl;
+
+    cd("/");
+    fs.unlink(cw, "lnk");
+    fs.rmdir(fs.resolve_path_to_inum("/cw/z"), "b");
+    fs.rmdir(cw, "z");
+    fs.rmdir(root_inum, "cw");
+    std::cout << "回到根目录: " << getShellCwdPath(fs) << (getShellCwdPath(fs) == "/" ? " (预期)" : " (异常!)") << std::endl;
+
+    // rm -r 删除当前目录的上级: 当前目录重置为根目录
+    int gone = fs.mkdir(root_inum, "cw_gone");
+    fs.mkdir(fs.mkdir(gone, "x"), "y");
+    cd("/cw_gone/x/y");
+    executeCommand(fs, "", parseCommand("rm -r /cw_gone"), no_input);
+    std::string after_rm = getShellCwdPath(fs);
+    std::cout << "rm -r 当前目录的上级后: " << after_rm
+              << (after_rm == "/" && fs._lookup_in_directory(root_inum, "cw_gone") == MiniFS::INVALID_INUM_CONST
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+    if (!was_logged_in) {
+        fs.logout();
+    }
+    std::cout << "--- 当前目录路径缓存测试结束 ---" << std::endl;
+}
+
+// 读取宿主文件的全部字节 (测试辅助)
+static std::string read_host_bytes(const std::string& path) {
+    std::string data, error;
+    readHostFile(path, data, error);
+    return data;
+}
+
+void test_copy_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始宿主文件复制与重定向测试 ---" << std::endl;
+    bool was_logged_in = fs.isLoggedIn();
+    if (!was_logged_in) {
+        fs.login("root", "root");
+    }
+    std::istringstream no_input;
+    auto run = [&](const std::string& line) {
+        executeCommand(fs, "", parseCommand(line), no_input);
+    };
+
+    // 含全部 256 种字节值、跨 3 个块的二进制文件
+    std::string payload;
+    for (int i = 0; i < 1300; i++) {
+        payload.push_back(static_cast<char>((i * 7) & 0xFF));
+    }
+    const std::string host_in = "cp_in_tmp.bin";
+    const std::string host_out = "cp_out_tmp.bin";
+    const std::string host_cat = "cp_cat_tmp.bin";
+    {
+        std::ofstream f(host_in.c_str(), std::ios::binary);
+        f.write(payload.data(), payload.size());
+    }
+
+    run("cp-in " + host_in + " /cpf");
+    dinode node;
+    int inum = fs.resolve_path_to_inum("/cpf");
+    bool size_ok = inum != MiniFS::INVALID_INUM_CONST && fs._get_inode(inum, node) && node.size == 1300;
+    std::cout << "cp-in 复制 1300 字节: " << (size_ok ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+
+    run("cp-out /cpf " + host_out);
+    std::cout << "cp-out 往返后内容一致: " << (read_host_bytes(host_out) == payload ? "是 (预期)" : "否 (异常!)") << std::endl;
+
+    run("cat /cpf > " + host_cat);
+    run("cat /cpf >> " + host_cat);
+    std::cout << "cat > 与 >> 重定向: " << (read_host_bytes(host_cat) == payload + payload ? "内容正确 (预期)" : "内容错误 (异常!)") << std::endl;
+
+    // 覆盖已有文件时先截断
+    {
+        std::ofstream f(host_in.c_str(), std::ios::binary | std::ios::trunc);
+        f << "short";
+    }
+    run("cp-in " + host_in + " /cpf");
+    fs._get_inode(inum, node);
+    std::cout << "覆盖已有文件: 大小 " << node.size << (node.size == 5 ? " (预期)" : " (异常!)") << std::endl;
+
+    fs.unlink(MiniFS::ROOT_INUM_CONST, "cpf");
+    std::remove(host_in.c_str());
+    std::remove(host_out.c_str());
+    std::remove(host_cat.c_str());
+    if (!was_logged_in) {
+        fs.logout();
+    }
+    std::cout << "--- 宿主文件复制与重定向测试结束 ---" << std::endl;
+}
+
+// 测试 Unix 域套接字 RPC 服务端与客户端
+void test_rpc_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始 RPC 服务端测试 ---" << std::endl;
+#ifdef __linux__
+    const std::string sock_path = "rpc_test.sock";
+    RpcServer server(fs);
+    if (!server.listen(sock_path)) {
+        std::cout << "监听套接字: 失败 (异常!)" << std::endl;
+        return;
+    }
+    std::thread loop([&server]() { server.run(); });
+
+    RpcClient a;
+    RpcClient b;
+    bool connected = a.connect(sock_path) && b.connect(sock_path);
+    std::cout << "两个客户端连接: " << (connected ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+
+    int dir_inum = a.mkdir("/rpcdir");
+    int fd = a.open("/rpcdir/f", RPC_O_RDWR | RPC_O_CREATE);
+    std::cout << "mkdir 与 open(O_CREATE): " << (dir_inum > 0 && fd >= 0 ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+
+    std::string payload;
+    for (int i = 0; i < 1000; i++) {
+        payload.push_back(static_cast<char>('A' + i % 26));
+    }
+    int written = a.pwrite(fd, payload.data(), static_cast<int>(payload.size()), 0);
+    std::vector<char> back(payload.size());
+    int got = a.pread(fd, back.data(), static_cast<int>(back.size()), 0);
+    bool same = got == static_cast<int>(payload.size()) && std::string(back.begin(), back.end()) == payload;
+    std::cout << "写入 " << written << " 字节后读回: " << (same ? "一致 (预期)" : "不一致 (异常!)") << std::endl;
+
+    RpcStat st;
+    bool stat_ok = b.stat("/rpcdir/f", st) == 0 && st.type == T_FILE && st.size == 1000;
+    std::cout << "另一个客户端 stat: " << (stat_ok ? "大小 1000 (预期)" : "结果错误 (异常!)") << std::endl;
+
+    std::vector<RpcDirEntry> entries;
+    b.readdir("/rpcdir", entries);
+    bool found = false;
+    for (const RpcDirEntry& e : entries) {
+        found = found || (e.name == "f" && e.type == T_FILE);
+    }
+    std::cout << "readdir 返回 f (文件类型): " << (found ? "是 (预期)" : "否 (异常!)") << std::endl;
+
+    std::cout << "其他连接使用本连接的 fd: "
+              << (b.pread(fd, back.data(), 10, 0) == RPC_ERR_BAD_FD ? "被拒绝 (预期)" : "未拒绝 (异常!)") << std::endl;
+
+    // 一次往返: 写 → 读 → stat
+    RpcBatch batch;
+    batch.addWrite(fd, 2000, "xyz", 3);
+    batch.addRead(fd, 2000, 3);
+    batch.addStat("/rpcdir/f");
+    batch.addStat("/rpcdir/missing");
+    int n = batch.execute(a);
+    bool batch_ok = n == 4 && batch.status(0) == 3 && batch.reply(1) == "xyz" && batch.status(2) == 0 &&
+                    batch.status(3) == RPC_ERR_FAILED;
+    std::cout << "批量请求 (含一项失败): " << (batch_ok ? "各项结果正确 (预期)" : "结果错误 (异常!)") << std::endl;
+
+    std::cout << "未知操作码: " << (a.call(99, "", nullptr) == RPC_ERR_UNKNOWN_OP ? "被拒绝 (预期)" : "未拒绝 (异常!)")
+              << std::endl;
+
+    // 接近 INT_MAX 的偏移: offset + count 会溢出，服务端应拒绝而不是崩溃
+    int huge_write = a.pwrite(fd, "boom", 4, INT_MAX - 1);
+    RpcStat after_huge;
+    bool huge_ok = huge_write == RPC_ERR_BAD_REQUEST && b.stat("/rpcdir/f", after_huge) == 0 && after_huge.size == 2003;
+    std::cout << "pwrite(offset=INT_MAX-1): " << (huge_ok ? "被拒绝，文件不变 (预期)" : "未拒绝 (异常!)") << std::endl;
+
+    // 多个客户端并发
+    std::atomic<int> failures(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.push_back(std::thread([&]() {
+            RpcClient c;
+            if (!c.connect(sock_path)) {
+                failures++;
+                return;
+            }
+            RpcStat s;
+            for (int i = 0; i < 50; i++) {
+                if (c.stat("/rpcdir/f", s) != 0 || s.size != 2003) {
+                    failures++;
+                }
+            }
+        }));
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    std::cout << "4 个客户端并发 stat 200 次: 失败 " << failures.load() << (failures.load() == 0 ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    // 断开连接时服务端关闭遗留的 fd: 之后占满文件描述符表的打开应当全部成功
+    const int fd_slots = 16; // MiniFS 文件描述符表的大小
+    a.disconnect();
+    RpcClient c;
+    c.connect(sock_path);
+    int opened = 0;
+    for (int attempt = 0; attempt < 50 && opened < fd_slots; attempt++) {
+        while (opened < fd_slots && c.open("/rpcdir/f", RPC_O_RDONLY) >= 0) {
+            opened++;
+        }
+        if (opened < fd_slots) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 等服务端处理断开事件
+        }
+    }
+    std::cout << "断开后 fd 被回收，可打开 " << opened << " 个"
+              << (opened == fd_slots ? " (预期)" : " (异常!)") << std::endl;
+    c.disconnect();
+    b.unlink("/rpcdir/f");
+    b.disconnect();
+
+    server.stop();
+    loop.join();
+    RpcServer::Stats stats = server.getStats();
+    std::cout << "服务端统计: 连接 " << stats.connections << "，请求 " << stats.requests << "，操作 " << stats.ops
+              << std::endl;
+    fs.rmdir(MiniFS::ROOT_INUM_CONST, "rpcdir");
+#else
+    (void)fs;
+    std::cout << "服务端模式只支持 Linux，跳过" << std::endl;
+#endif
+    std::cout << "--- RPC 服务端测试结束 ---" << std::endl;
+}
+
+// 测试镜像块设备 (io_uring/pread) 与增量写回
+void test_block_device_operations(MiniFS& fs) {
+    (void)fs;
+    std::cout << "\n--- 开始镜像块设备测试 ---" << std::endl;
+    const std::string dev_path = "blockdev_tmp.img";
+    const int blocks = 200; // 超过 io_uring 队列深度，覆盖队列满时的批量提交
+    std::vector<char> pattern(static_cast<size_t>(blocks) * BLOCK_SIZE);
+    for (size_t i = 0; i < pattern.size(); i++) {
+        pattern[i] = static_cast<char>((i * 31 + i / BLOCK_SIZE) & 0xFF);
+    }
+
+    std::vector<BlockDevice::Kind> kinds;
+    kinds.push_back(BlockDevice::PREAD);
+    if (ioUringAvailable()) {
+        kinds.push_back(BlockDevice::IO_URING);
+    } else {
+        std::cout << "io_uring 不可用，只测试 pread 后备实现" << std::endl;
+    }
+    for (BlockDevice::Kind kind : kinds) {
+        std::remove(dev_path.c_str());
+        std::string error;
+        std::unique_ptr<BlockDevice> dev = openBlockDevice(dev_path, BLOCK_SIZE, true, error, kind);
+        if (!dev || !dev->resize(static_cast<long long>(pattern.size()))) {
+            std::cout << "打开块设备: 失败 " << error << " (异常!)" << std::endl;
+            continue;
+        }
+        // 逐块提交写入 (一半在登记的固定缓冲区内)，再整体读回
+        dev->registerBuffer(&pattern[0], pattern.size() / 2);
+        for (int b = 0; b < blocks; b++) {
+            dev->submitWrite(b, 1, &pattern[static_cast<size_t>(b) * BLOCK_SIZE]);
+        }
+        int write_failures = dev->wait();
+        dev->flush();
+        std::vector<char> back(pattern.size());
+        for (int b = 0; b < blocks; b += 8) {
+            dev->submitRead(b, std::min(8, blocks - b), &back[static_cast<size_t>(b) * BLOCK_SIZE]);
+        }
+        int read_failures = dev->wait();
+        BlockDevice::Stats st = dev->getStats();
+        bool ok = write_failures == 0 && read_failures == 0 && back == pattern;
+        std::cout << dev->name() << ": " << blocks << " 块写入并读回" << (ok ? "一致 (预期)" : "不一致 (异常!)")
+                  << "，请求 " << st.requests << "，进入内核 " << st.submit_calls << " 次" << std::endl;
+        if (kind == BlockDevice::IO_URING) {
+            std::cout << "io_uring 批量提交 (进入内核次数少于请求数): "
+                      << (st.submit_calls < st.requests ? "是 (预期)" : "否 (异常!)") << std::endl;
+        }
+
+        // 读超出文件末尾算作失败
+        dev->submitRead(blocks, 1, &back[0]);
+        std::cout << dev->name() << " 读超出文件末尾: " << (dev->wait() == 1 ? "报告失败 (预期)" : "未报告 (异常!)")
+                  << std::endl;
+    }
+    std::remove(dev_path.c_str());
+
+    // 增量写回: 首次整体写入，之后只写改动过的块
+    const std::string image = "sync_tmp.dat";
+    std::remove(image.c_str());
+    {
+        MiniFS a;
+        a.format();
+        int first = a.syncFS(image);
+        std::cout << "首次 syncFS 写入 " << first << " 块" << (first == BLOCK_COUNT ? " (预期)" : " (异常!)") << std::endl;
+        std::cout << "无改动时 syncFS: " << (a.syncFS(image) == 0 ? "不写任何块 (预期)" : "仍有写入 (异常!)") << std::endl;
+        int fd = a.open(MiniFS::ROOT_INUM_CONST, "synced", MiniFS::O_CREATE | MiniFS::O_RDWR);
+        a.write(fd, pattern.data(), 3 * BLOCK_SIZE);
+        a.close(fd);
+        int second = a.syncFS(image);
+        std::cout << "创建 3 块文件后 syncFS 写入 " << second << " 块"
+                  << (second > 0 && second < 16 ? " (预期)" : " (异常!)") << std::endl;
+    }
+    {
+        MiniFS b;
+        bool loaded = b.loadFS(image) == MiniFS::FSStatus::OK;
+        int fd = loaded ? b.open(MiniFS::ROOT_INUM_CONST, "synced", MiniFS::O_RDONLY) : -1;
+        std::vector<char> back(3 * BLOCK_SIZE);
+        bool same = fd >= 0 && b.read(fd, back.data(), 3 * BLOCK_SIZE) == 3 * BLOCK_SIZE &&
+                    std::equal(back.begin(), back.end(), pattern.begin());
+        if (fd >= 0) {
+            b.close(fd);
+        }
+        std::cout << "重新加载 (" << b.backingDeviceName() << ") 后内容: "
+                  << (same ? "一致 (预期)" : "不一致 (异常!)") << std::endl;
+        // 修改后第一次读取按 relatime 更新访问时间: 只写回该i-节点块和记录其校验和的超级块
+        int after_read = b.syncFS(image);
+        std::cout << "加载并读取后 syncFS 写入 " << after_read << " 块"
+                  << (after_read == 2 ? " (访问时间, 预期)" : " (异常!)") << std::endl;
+        std::cout << "之后无改动时 syncFS: " << (b.syncFS(image) == 0 ? "不写任何块 (预期)" : "仍有写入 (异常!)")
+                  << std::endl;
+    }
+#ifdef __linux__
+    // 加载后 fork (如 fuse_daemonize)，在子进程写入并写回: 固定缓冲区须按子进程的内存重新登记
+    {
+        MiniFS c;
+        bool loaded = c.loadFS(image) == MiniFS::FSStatus::OK;
+        std::cout.flush();
+        pid_t pid = loaded ? ::fork() : -1;
+        if (pid == 0) {
+            int fd = c.open(MiniFS::ROOT_INUM_CONST, "forked", MiniFS::O_CREATE | MiniFS::O_RDWR);
+            bool ok = fd >= 0 && c.write(fd, pattern.data(), 2 * BLOCK_SIZE) == 2 * BLOCK_SIZE;
+            c.close(fd);
+            ok = ok && c.syncFS(image) > 0;
+            std::cout.flush();
+            ::_exit(ok ? 0 : 1);
+        }
+        int status = -1;
+        if (pid > 0) {
+            ::waitpid(pid, &status, 0);
+        }
+        MiniFS d;
+        int fd = d.loadFS(image) == MiniFS::FSStatus::OK
+                     ? d.open(MiniFS::ROOT_INUM_CONST, "forked", MiniFS::O_RDONLY) : -1;
+        std::vector<char> back(2 * BLOCK_SIZE);
+        bool same = fd >= 0 && d.read(fd, back.data(), 2 * BLOCK_SIZE) == 2 * BLOCK_SIZE &&
+                    std::equal(back.begin(), back.end(), pattern.begin());
+        if (fd >= 0) {
+            d.close(fd);
+        }
+        std::cout << "fork 后子进程写入并 syncFS，重新加载: "
+                  << (status == 0 && same ? "文件存在且内容一致 (预期)" : "写入丢失 (异常!)") << std::endl;
+    }
+    // 只读镜像: 以只读方式加载，syncFS 在镜像可写之前报错，可写后重新以读写方式打开并写回
+    ::chmod(image.c_str(), 0444);
+    if (::access(image.c_str(), W_OK) == 0) {
+        std::cout << "当前用户可写只读文件 (root)，跳过只读镜像测试" << std::endl;
+    } else {
+        MiniFS e;
+        bool loaded = e.loadFS(image) == MiniFS::FSStatus::OK;
+        std::cout << "加载只读镜像: " << (loaded ? "成功 (预期)" : "失败 (异常!)") << std::endl;
+        int fd = e.open(MiniFS::ROOT_INUM_CONST, "readonly", MiniFS::O_CREATE | MiniFS::O_RDWR);
+        e.close(fd);
+        int refused = e.syncFS(image);
+        ::chmod(image.c_str(), 0644);
+        int written = e.syncFS(image);
+        MiniFS f;
+        bool persisted = f.loadFS(image) == MiniFS::FSStatus::OK &&
+                         f.open(MiniFS::ROOT_INUM_CONST, "readonly", MiniFS::O_RDONLY) >= 0;
+        std::cout << "只读时 syncFS 返回 " << refused << "，可写后写入 " << written << " 块"
+                  << (refused == -1 && written > 0 && persisted ? " (预期)" : " (异常!)") << std::endl;
+    }
+    ::chmod(image.c_str(), 0644);
+#endif
+    std::remove(image.c_str());
+    std::cout << "--- 镜像块设备测试结束 ---" << std::endl;
+}
+
+// 测试顺序读预读: 小块顺序读整块读入并命中缓冲区，写入使缓冲区作废，随机读不预读
+void test_readahead_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始顺序预读测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    const int file_size = 8 * BLOCK_SIZE;
+    const int chunk = 64;
+    const int chunks = file_size / chunk;
+    std::vector<char> pattern(file_size);
+    for (int i = 0; i < file_size; i++) {
+        pattern[i] = static_cast<char>((i * 7 + i / BLOCK_SIZE) & 0xFF);
+    }
+    int fd = fs.open(root_inum, "ra_file", MiniFS::O_CREATE | MiniFS::O_RDWR);
+    if (fd < 0 || fs.write(fd, pattern.data(), file_size) != file_size) {
+        std::cout << "创建测试文件失败 (异常!)" << std::endl;
+        if (fd >= 0) {
+            fs.close(fd);
+        }
+        return;
+    }
+    fs.close(fd);
+
+    // 1. 顺序小块读: 内容一致，块读取次数远少于逐次读取
+    fd = fs.open(root_inum, "ra_file", MiniFS::O_RDONLY);
+    std::vector<char> back(file_size);
+    MiniFS::IOStats before = fs.getIOStats();
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 0; i < chunks; i++) {
+        ok = ok && fs.pread(fd, &back[i * chunk], chunk, i * chunk) == chunk;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    MiniFS::IOStats mid = fs.getIOStats();
+    ok = ok && back == pattern;
+    long seq_reads = mid.data_reads - before.data_reads;
+    long fills = mid.readahead_fills - before.readahead_fills;
+    long hits = mid.readahead_hits - before.readahead_hits;
+    std::cout << "顺序读 " << chunks << " 次 x " << chunk << " 字节: 内容" << (ok ? "一致" : "不一致")
+              << ", 数据块读 " << seq_reads << " 次, 预读填充 " << fills << " 次, 命中 " << hits << " 次"
+              << (ok && fills > 0 && fills <= 4 && hits == chunks - fills ? " (预期)" : " (异常!)") << std::endl;
+
+    // 2. 同样的读取次数按打乱的顺序读: 每次都是随机读，不预读
+    std::fill(back.begin(), back.end(), 0);
+    for (int i = 0; i < chunks; i++) {
+        int k = (i * 37) % chunks;
+        fs.pread(fd, &back[k * chunk], chunk, k * chunk);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    MiniFS::IOStats after = fs.getIOStats();
+    long rand_reads = after.data_reads - mid.data_reads;
+    std::cout << "随机读 " << chunks << " 次: 内容" << (back == pattern ? "一致" : "不一致") << ", 数据块读 "
+              << rand_reads << " 次, 预读填充 " << (after.readahead_fills - mid.readahead_fills) << " 次"
+              << (back == pattern && after.readahead_fills == mid.readahead_fills && seq_reads * 4 < rand_reads
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "耗时: 顺序 " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+              << " us, 随机 " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us"
+              << std::endl;
+
+    // 3. 写入使预读缓冲区作废: 另一个描述符改写窗口内的数据后，顺序读看到新内容
+    char first[chunk];
+    fs.pread(fd, first, chunk, 0);
+    int wfd = fs.open(root_inum, "ra_file", MiniFS::O_WRONLY);
+    const char patch[] = "PATCHED";
+    fs.pwrite(wfd, patch, 7, chunk);
+    fs.close(wfd);
+    char next[chunk];
+    int n = fs.pread(fd, next, chunk, chunk);
+    std::cout << "写入后继续顺序读: " << (n == chunk && std::memcmp(next, patch, 7) == 0 ? "看到新内容 (预期)" : "读到旧数据 (异常!)")
+              << std::endl;
+
+    // 4. 文件末尾: 跨越末尾的读取返回剩余字节，越过末尾返回0
+    fs.pread(fd, &back[0], chunk, file_size - 3 * chunk);
+    int tail = fs.pread(fd, &back[0], 3 * chunk, file_size - 2 * chunk);
+    int past = fs.pread(fd, &back[0], chunk, file_size);
+    std::cout << "读到文件末尾: 返回 " << tail << " / " << past << " 字节"
+              << (tail == 2 * chunk && past == 0 ? " (预期)" : " (异常!)") << std::endl;
+    fs.close(fd);
+    fs.unlink(root_inum, "ra_file");
+    std::cout << "--- 顺序预读测试结束 ---" << std::endl;
+}
+
+#ifdef MINIFS_HAS_COROUTINES
+// 协程形式: 打开、按块读取、关闭，结果累加到 bytes
+static AsyncTask async_read_file_coro(AsyncMiniFS& afs, std::string path, char* out, int size,
+                                      std::atomic<long>& bytes, std::atomic<int>& finished) {
+    int fd = co_await afs.async_open(path, MiniFS::O_RDONLY);
+    if (fd >= 0) {
+        for (int off = 0; off < size; off += BLOCK_SIZE) {
+            int n = co_await afs.async_read(fd, out + off, BLOCK_SIZE, off);
+            if (n > 0) {
+                bytes += n;
+            }
+        }
+        co_await afs.async_close(fd);
+    }
+    finished++;
+}
+#endif
+
+// 测试异步接口: 线程池执行器上的并发读写、命中预读缓冲区时在调用线程内完成、协程 (C++20)
+void test_async_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始异步接口测试 ---" << std::endl;
+    const int file_size = 8 * BLOCK_SIZE;
+    std::vector<char> pattern(file_size);
+    for (int i = 0; i < file_size; i++) {
+        pattern[i] = static_cast<char>((i * 13 + 5) & 0xFF);
+    }
+
+    // 等待 expected 个回调完成
+    std::mutex m;
+    std::condition_variable cv;
+    int completed = 0;
+    auto wait_for = [&](int expected) {
+        std::unique_lock<std::mutex> lock(m);
+        return cv.wait_for(lock, std::chrono::seconds(10), [&]() { return completed >= expected; });
+    };
+    auto complete = [&]() {
+        std::lock_guard<std::mutex> lock(m);
+        completed++;
+        cv.notify_all();
+    };
+
+    ThreadPoolExecutor pool(2);
+    AsyncMiniFS afs(fs, pool);
+
+    // 1. 打开并写入 (回调在执行器线程上)
+    int fd = -1;
+    afs.async_open("/async_file", MiniFS::O_CREATE | MiniFS::O_RDWR, [&](int r) { fd = r; complete(); });
+    wait_for(1);
+    int written = -1;
+    if (fd >= 0) {
+        afs.async_write(fd, pattern.data(), file_size, 0, [&](int r) { written = r; complete(); });
+        wait_for(2);
+    }
+    std::cout << "async_open/async_write: fd " << fd << ", 写入 " << written << " 字节"
+              << (fd >= 0 && written == file_size ? " (预期)" : " (异常!)") << std::endl;
+    if (fd < 0 || written != file_size) {
+        return;
+    }
+
+    // 2. 大量并发读取共享两个工作线程
+    const int reads = 256;
+    const int chunk = file_size / 64;
+    std::vector<char> back(static_cast<size_t>(reads) * chunk);
+    std::atomic<int> short_reads(0);
+    completed = 0;
+    for (int i = 0; i < reads; i++) {
+        int off = (i % 64) * chunk;
+        afs.async_read(fd, &back[static_cast<size_t>(i) * chunk], chunk, off, [&, chunk](int r) {
+            if (r != chunk) {
+                short_reads++;
+            }
+            complete();
+        });
+    }
+    bool all_done = wait_for(reads);
+    bool same = true;
+    for (int i = 0; i < reads && same; i++) {
+        same = std::memcmp(&back[static_cast<size_t>(i) * chunk], &pattern[(i % 64) * chunk], chunk) == 0;
+    }
+    std::cout << reads << " 个并发 async_read (" << pool.threadCount() << " 个工作线程): "
+              << (all_done && short_reads == 0 && same ? "全部完成且内容一致 (预期)" : "(异常!)") << std::endl;
+
+    // 3. 预读缓冲区中的数据: 回调在 async_read 返回之前、在调用线程内执行
+    char buf[64];
+    int r0 = fs.pread(fd, buf, 64, 0);
+    fs.pread(fd, buf, 64, 64); // 顺序读，填充预读窗口
+    AsyncMiniFS::Stats before = afs.getStats();
+    bool called_inline = false;
+    std::thread::id cb_thread;
+    afs.async_read(fd, buf, 64, 128, [&](int r) {
+        called_inline = (r == 64);
+        cb_thread = std::this_thread::get_id();
+    });
+    AsyncMiniFS::Stats after = afs.getStats();
+    std::cout << "命中预读缓冲区的 async_read: "
+              << (r0 == 64 && called_inline && cb_thread == std::this_thread::get_id() &&
+                          after.inline_completions == before.inline_completions + 1 && after.posted == before.posted
+                      ? "在调用线程内完成 (预期)" : "被交给执行器 (异常!)")
+              << std::endl;
+
+    // 4. 读目录
+    AsyncDirListing listing;
+    completed = 0;
+    afs.async_readdir("/", [&](AsyncDirListing l) { listing = l; complete(); });
+    wait_for(1);
+    bool found = false;
+    for (const AsyncDirEntry& e : listing.entries) {
+        found = found || (e.name == "async_file" && e.type == T_FILE);
+    }
+    std::cout << "async_readdir(\"/\"): " << listing.entries.size() << " 项"
+              << (listing.status == 0 && found ? "，包含 async_file (预期)" : " (异常!)") << std::endl;
+    completed = 0;
+    afs.async_readdir("/no_such_dir", [&](AsyncDirListing l) { listing = l; complete(); });
+    wait_for(1);
+    std::cout << "async_readdir 不存在的目录: " << (listing.status == -1 ? "失败 (预期)" : "成功 (异常!)") << std::endl;
+
+    completed = 0;
+    afs.async_close(fd, [&](int) { complete(); });
+    wait_for(1);
+
+#ifdef MINIFS_HAS_COROUTINES
+    // 5. 协程: 多个协程同时读同一文件，挂起时不占用线程
+    const int coros = 12; // 每个协程占用一个文件描述符
+    std::vector<std::vector<char> > outs(coros, std::vector<char>(file_size));
+    std::atomic<long> bytes(0);
+    std::atomic<int> finished(0);
+    for (int i = 0; i < coros; i++) {
+        async_read_file_coro(afs, "/async_file", outs[i].data(), file_size, bytes, finished);
+    }
+    for (int spin = 0; spin < 1000 && finished < coros; spin++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    bool coro_same = true;
+    for (int i = 0; i < coros; i++) {
+        coro_same = coro_same && outs[i] == pattern;
+    }
+    std::cout << coros << " 个协程 co_await 读取: 完成 " << finished << " 个, " << bytes << " 字节"
+              << (finished == coros && bytes == static_cast<long>(coros) * file_size && coro_same ? " (预期)" : " (异常!)")
+              << std::endl;
+#else
+    std::cout << "未以 C++20 编译，跳过协程测试 (make CXXSTD=c++20)" << std::endl;
+#endif
+
+    fs.unlink(MiniFS::ROOT_INUM_CONST, "async_file");
+    std::cout << "--- 异步接口测试结束 ---" << std::endl;
+}
+
+// 测试工作窃取线程池、树形完成计数、并行目录树遍历与并行巡检
+void test_work_stealing_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始工作窃取线程池测试 ---" << std::endl;
+
+    // 1. 从单个根任务逐层派生的二叉任务树: 其他线程只能靠窃取拿到任务
+    {
+        WorkStealingPool pool(4);
+        std::atomic<long> nodes(0);
+        const int depth = 12;
+        std::function<void(TaskTree::Node&, int)> fan_out = [&](TaskTree::Node& n, int level) {
+            nodes++;
+            if (level < depth) {
+                n.spawn([&fan_out, level](TaskTree::Node& c) { fan_out(c, level + 1); });
+                n.spawn([&fan_out, level](TaskTree::Node& c) { fan_out(c, level + 1); });
+            }
+        };
+        TaskTree tree(pool);
+        tree.spawn([&fan_out](TaskTree::Node& n) { fan_out(n, 1); });
+        tree.wait();
+        WorkStealingPool::Stats st = pool.getStats();
+        long expected = (1L << depth) - 1;
+        std::cout << "二叉任务树 (深度 " << depth << "): 执行 " << nodes << " 个节点, 窃取 " << st.stolen << " 次"
+                  << (nodes == expected && st.executed == expected && st.stolen > 0 ? " (预期)" : " (异常!)")
+                  << std::endl;
+
+        // 空任务树立即完成
+        TaskTree empty(pool);
+        empty.wait();
+        std::cout << "空任务树: 立即完成 (预期)" << std::endl;
+    }
+
+    // 2. 并行遍历目录树
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int top = fs.mkdir(root_inum, "ws_tree");
+    int expected_entries = 0;
+    long expected_bytes = 0;
+    std::vector<int> files;
+    char data[BLOCK_SIZE + 100];
+    std::memset(data, 'w', sizeof(data));
+    for (int d = 0; d < 3 && top >= 0; d++) {
+        std::string dname = "d" + std::to_string(d);
+        int dir = fs.mkdir(top, dname.c_str());
+        int sub = fs.mkdir(dir, "sub");
+        expected_entries += 2;
+        for (int f = 0; f < 2; f++) {
+            std::string fname = "f" + std::to_string(f);
+            int parent = (f == 0) ? dir : sub;
+            int fd = fs.open(parent, fname.c_str(), MiniFS::O_CREATE | MiniFS::O_RDWR);
+            int len = BLOCK_SIZE + 100 - d * 10 - f;
+            fs.write(fd, data, len);
+            fs.close(fd);
+            files.push_back(fs._lookup_in_directory(parent, fname.c_str()));
+            expected_entries++;
+            expected_bytes += len;
+        }
+    }
+    std::atomic<long> bytes(0);
+    std::atomic<int> dirs(0);
+    long visited = fs.walkTree(top, [&](int, const std::string&, int, const dinode& node) {
+        if (node.type == T_FILE) {
+            bytes += node.size;
+        } else if (node.type == T_DIR) {
+            dirs++;
+        }
+    });
+    std::cout << "walkTree: 访问 " << visited << " 项 (目录 " << dirs << "), 文件共 " << bytes << " 字节"
+              << (visited == expected_entries && dirs == 6 && bytes == expected_bytes ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "walkTree 文件 (非目录): "
+              << (fs.walkTree(files.empty() ? MiniFS::INVALID_INUM_CONST : files[0], [](int, const std::string&, int,
+                                                                                    const dinode&) {}) == -1
+                      ? "返回-1 (预期)" : "(异常!)")
+              << std::endl;
+
+    // 3. 并行巡检: 每个开启数据校验的文件一个任务
+    for (int inum : files) {
+        fs.setDataChecksums(inum, true);
+    }
+    MiniFS::ScrubStats before = fs.getScrubStats();
+    int mismatches = fs.scrubOnce();
+    MiniFS::ScrubStats after = fs.getScrubStats();
+    std::cout << "并行巡检 (" << fs.workerThreads() << " 个工作线程): 文件 " << (after.files - before.files)
+              << " 个, 数据块 " << (after.blocks - before.blocks) << " 个, 不匹配 " << mismatches
+              << (mismatches == 0 && after.files - before.files >= static_cast<long>(files.size()) &&
+                          after.blocks - before.blocks >= static_cast<long>(files.size()) * 2
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    for (int d = 0; d < 3; d++) {
+        std::string dname = "d" + std::to_string(d);
+        int dir = fs._lookup_in_directory(top, dname.c_str());
+        int sub = fs._lookup_in_directory(dir, "sub");
+        fs.unlink(dir, "f0");
+        fs.unlink(sub, "f1");
+        fs.rmdir(dir, "sub");
+        fs.rmdir(top, dname.c_str());
+    }
+    fs.rmdir(root_inum, "ws_tree");
+    std::cout << "--- 工作窃取线程池测试结束 ---" << std::endl;
+}
+
+// 逐项删除目录树 (对照组): 每个文件 unlink、每个目录 rmdir
+static void remove_tree_one_by_one(MiniFS& fs, int parent, const std::string& name) {
+    int inum = fs._lookup_in_directory(parent, name);
+    dinode node;
+    if (inum == MiniFS::INVALID_INUM_CONST || !fs._get_inode(inum, node)) {
+        return;
+    }
+    if (node.type == T_DIR) {
+        dirent entries[BLOCK_SIZE / sizeof(dirent)];
+        fs._read_dir_block(node, entries);
+        std::vector<std::string> names;
+        for (int i = 0; i < static_cast<int>(node.size / sizeof(dirent)); i++) {
+            if (std::strcmp(entries[i].name, ".") != 0 && std::strcmp(entries[i].name, "..") != 0) {
+                names.push_back(entries[i].name);
+            }
+        }
+        for (const std::string& child : names) {
+            remove_tree_one_by_one(fs, inum, child);
+        }
+        fs.rmdir(parent, name.c_str());
+    } else {
+        fs.unlink(parent, name.c_str());
+    }
+}
+
+// 测试递归删除、递归复制与空间统计
+void test_tree_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始目录树操作测试 (rm -r / cp -r / du) ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int free_before = fs.countFreeBlocks();
+
+    // 建树: /tree/{a,b/{c,d/e}}，每个目录 2 个文件，其中一个 3 块
+    int top = fs.mkdir(root_inum, "tree");
+    std::vector<char> data(3 * BLOCK_SIZE, 't');
+    std::vector<int> dirs;
+    dirs.push_back(top);
+    int b = fs.mkdir(top, "b");
+    dirs.push_back(fs.mkdir(top, "a"));
+    dirs.push_back(b);
+    dirs.push_back(fs.mkdir(b, "c"));
+    int d = fs.mkdir(b, "d");
+    dirs.push_back(d);
+    dirs.push_back(fs.mkdir(d, "e"));
+    long long bytes = 0;
+    for (size_t i = 0; i < dirs.size(); i++) {
+        int fd = fs.open(dirs[i], "big", MiniFS::O_CREATE | MiniFS::O_RDWR);
+        fs.write(fd, data.data(), 3 * BLOCK_SIZE);
+        fs.close(fd);
+        fd = fs.open(dirs[i], "small", MiniFS::O_CREATE | MiniFS::O_RDWR);
+        fs.write(fd, "hi", 2);
+        fs.close(fd);
+        bytes += 3 * BLOCK_SIZE + 2;
+    }
+    // 子树外的硬链接，以及删除时仍打开的文件
+    int linked = fs._lookup_in_directory(d, "big");
+    fs.link(linked, root_inum, "tree_link");
+    int open_fd = fs.open(b, "big", MiniFS::O_RDONLY);
+
+    // 1. du
+    MiniFS::DiskUsage du;
+    fs.diskUsage(top, du);
+    long expected_blocks = static_cast<long>(dirs.size()) * (1 + 3); // 目录块 + 大文件 3 块，小文件内联
+    std::cout << "du /tree: 文件 " << du.files << ", 目录 " << du.dirs << ", " << du.bytes << " 字节, " << du.blocks
+              << " 块"
+              << (du.files == static_cast<long>(dirs.size()) * 2 && du.dirs == static_cast<long>(dirs.size()) - 1 &&
+                          du.bytes == bytes && du.blocks == expected_blocks
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    // 2. cp -r: 整棵复制，内容与统计一致；不能复制到自身子树中
+    int created = fs.copyTree(top, root_inum, "tree_copy");
+    int copy_inum = fs._lookup_in_directory(root_inum, "tree_copy");
+    MiniFS::DiskUsage du_copy;
+    fs.diskUsage(copy_inum, du_copy);
+    std::vector<char> back(3 * BLOCK_SIZE);
+    int cfd = fs.open(fs.resolve_path_to_inum("/tree_copy/b/d/e"), "big", MiniFS::O_RDONLY);
+    bool same = cfd >= 0 && fs.read(cfd, back.data(), 3 * BLOCK_SIZE) == 3 * BLOCK_SIZE && back == data;
+    if (cfd >= 0) {
+        fs.close(cfd);
+    }
+    std::cout << "cp -r /tree /tree_copy: 新建 " << created << " 个i-节点"
+              << (created == 1 + du.files + du.dirs && du_copy.bytes == du.bytes && du_copy.blocks == du.blocks && same
+                      ? "，内容一致 (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "cp -r /tree /tree/b/inner: "
+              << (fs.copyTree(top, b, "inner") == -1 ? "拒绝复制到自身子树 (预期)" : "(异常!)") << std::endl;
+    std::cout << "cp -r 到已存在的名字: "
+              << (fs.copyTree(top, root_inum, "tree_copy") == -1 ? "失败 (预期)" : "(异常!)") << std::endl;
+
+    // 3. rm -r 与逐项删除的块写次数对比
+    MiniFS::IOStats s0 = fs.getIOStats();
+    int freed = fs.removeTree(root_inum, "tree");
+    MiniFS::IOStats s1 = fs.getIOStats();
+    remove_tree_one_by_one(fs, root_inum, "tree_copy");
+    MiniFS::IOStats s2 = fs.getIOStats();
+    long batched = (s1.meta_writes + s1.data_writes) - (s0.meta_writes + s0.data_writes);
+    long one_by_one = (s2.meta_writes + s2.data_writes) - (s1.meta_writes + s1.data_writes);
+    // 释放: 6 个目录 + 11 个文件 (硬链接的文件和仍打开的文件不释放)
+    std::cout << "rm -r /tree: 释放 " << freed << " 个i-节点, 写块 " << batched << " 次; 逐项删除副本写块 "
+              << one_by_one << " 次"
+              << (freed == static_cast<int>(dirs.size()) * 3 - 2 && batched * 3 < one_by_one ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "rm -r 后 /tree: "
+              << (fs._lookup_in_directory(root_inum, "tree") == MiniFS::INVALID_INUM_CONST ? "已删除 (预期)" : "仍存在 (异常!)")
+              << std::endl;
+
+    // 子树外的硬链接仍可读，链接数减为 1；打开中的文件在关闭后释放
+    dinode link_node;
+    bool link_ok = fs._get_inode(linked, link_node) && link_node.nlink == 1 && link_node.size == 3 * BLOCK_SIZE;
+    std::cout << "子树外的硬链接: " << (link_ok ? "保留, 链接数 1 (预期)" : "(异常!)") << std::endl;
+    bool open_ok = fs.pread(open_fd, back.data(), 3 * BLOCK_SIZE, 0) == 3 * BLOCK_SIZE && back == data;
+    fs.close(open_fd);
+    fs.unlink(root_inum, "tree_link");
+    int free_after = fs.countFreeBlocks();
+    std::cout << "打开中的文件删除后仍可读: " << (open_ok ? "是" : "否") << "; 全部清理后空闲块 " << free_after << " / 原 "
+              << free_before << (open_ok && free_after == free_before ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "--- 目录树操作测试结束 ---" << std::endl;
+}
+
+// 测试目录游标 (opendir/readdir 带类型) 与 readdirplus
+void test_readdir_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始目录游标与 readdirplus 测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int dir = fs.mkdir(root_inum, "rd");
+    const int files = 12;
+    for (int i = 0; i < files; i++) {
+        std::string name = "f" + std::to_string(i);
+        int fd = fs.open(dir, name.c_str(), MiniFS::O_CREATE | MiniFS::O_RDWR);
+        std::string content(i + 1, 'r');
+        fs.write(fd, content.data(), static_cast<int>(content.size()));
+        fs.close(fd);
+    }
+    fs.mkdir(dir, "sub");
+    fs.symlink(dir, "lnk", "f0");
+
+    // 1. readdir 返回名字、i-节点号和类型，不读i-节点
+    MiniFS::DirCursor cursor;
+    int opened = fs.opendir(dir, cursor);
+    MiniFS::IOStats before = fs.getIOStats();
+    MiniFS::DirEntry e;
+    int count = 0, dirs = 0, links = 0, regular = 0;
+    while (fs.readdir(cursor, e)) {
+        count++;
+        if (e.type == T_DIR) {
+            dirs++;
+        } else if (e.type == T_SYMLINK) {
+            links++;
+        } else if (e.type == T_FILE) {
+            regular++;
+        }
+    }
+    MiniFS::IOStats after = fs.getIOStats();
+    std::cout << "readdir: " << count << " 项 (普通文件 " << regular << ", 目录 " << dirs << ", 符号链接 " << links
+              << "), 读i-节点块 " << (after.meta_reads - before.meta_reads) << " 次"
+              << (opened == 0 && count == files + 4 && regular == files && dirs == 3 && links == 1 &&
+                          after.meta_reads == before.meta_reads
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "opendir 普通文件: "
+              << (fs.opendir(fs._lookup_in_directory(dir, "f0"), cursor) == -1 ? "失败 (预期)" : "(异常!)") << std::endl;
+
+    // 2. 游标位置可以保存后继续读取
+    fs.opendir(dir, cursor);
+    fs.readdir(cursor, e);
+    fs.readdir(cursor, e);
+    size_t saved = cursor.pos;
+    MiniFS::DirEntry third, resumed;
+    fs.readdir(cursor, third);
+    cursor.pos = saved;
+    fs.readdir(cursor, resumed);
+    std::cout << "保存游标位置后继续: " << (third.name == resumed.name ? "得到同一项 (预期)" : "(异常!)") << std::endl;
+
+    // 3. 删除后不再列出 (目录块中 size 之后的旧数据不算目录项)
+    fs.unlink(dir, "f3");
+    fs.opendir(dir, cursor);
+    bool stale = false;
+    count = 0;
+    while (fs.readdir(cursor, e)) {
+        stale = stale || e.name == "f3";
+        count++;
+    }
+    std::cout << "删除 f3 后: " << count << " 项" << (!stale && count == files + 3 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 4. 旧版镜像的目录项没有类型: 回退到读i-节点
+    dinode dnode;
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    fs._get_inode(dir, dnode);
+    fs._read_dir_block(dnode, entries);
+    for (int i = 0; i < static_cast<int>(dnode.size / sizeof(dirent)); i++) {
+        entries[i].type = 0;
+    }
+    fs._write_dir_block(dnode, entries);
+    fs._write_inode(dir, dnode);
+    fs.opendir(dir, cursor);
+    dirs = 0;
+    links = 0;
+    while (fs.readdir(cursor, e)) {
+        dirs += e.type == T_DIR;
+        links += e.type == T_SYMLINK;
+    }
+    std::cout << "没有类型的旧目录项: " << (dirs == 3 && links == 1 ? "类型由i-节点补齐 (预期)" : "(异常!)") << std::endl;
+
+    // 5. readdirplus: 每个i-节点块只读一次
+    std::vector<MiniFS::DirEntryPlus> items;
+    before = fs.getIOStats();
+    int n = fs.readdirplus(dir, items);
+    after = fs.getIOStats();
+    std::set<int> inode_blocks;
+    bool sizes_ok = true;
+    for (const MiniFS::DirEntryPlus& item : items) {
+        inode_blocks.insert(INODE_START + (item.entry.inum * INODE_SIZE) / BLOCK_SIZE);
+        if (item.entry.name.size() > 1 && item.entry.name[0] == 'f') {
+            sizes_ok = sizes_ok && item.attr.type == T_FILE && item.attr.size == std::stoi(item.entry.name.substr(1)) + 1;
+        }
+    }
+    long reads = after.meta_reads - before.meta_reads;
+    std::cout << "readdirplus: " << n << " 项, 读i-节点区 " << reads << " 次 (涉及 " << inode_blocks.size()
+              << " 个i-节点块)"
+              << (n == files + 3 && sizes_ok && reads <= static_cast<long>(inode_blocks.size()) + 1 &&
+                          reads < n
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    // 清理
+    for (int i = 0; i < files; i++) {
+        fs.unlink(dir, ("f" + std::to_string(i)).c_str());
+    }
+    fs.unlink(dir, "lnk");
+    fs.rmdir(dir, "sub");
+    fs.rmdir(root_inum, "rd");
+    std::cout << "--- 目录游标与 readdirplus 测试结束 ---" << std::endl;
+}
+
+// 测试 stat/lstat/fstat 与属性缓存
+void test_stat_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始 stat 与属性缓存测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    int dir = fs.mkdir(root_inum, "st");
+    int fd = fs.open(dir, "data", MiniFS::O_CREATE | MiniFS::O_RDWR);
+    std::string content(BLOCK_SIZE + 100, 's');
+    fs.write(fd, content.data(), static_cast<int>(content.size()));
+    fs.symlink(dir, "lnk", "data");
+
+    // 1. 各字段与i-节点一致，stat 跟随符号链接而 lstat 不跟随
+    MiniFS::FileStat st, lst, fst;
+    int rc = fs.stat("/st/lnk", st);
+    int lrc = fs.lstat("/st/lnk", lst);
+    int frc = fs.fstat(fd, fst);
+    std::cout << "stat /st/lnk: 类型 " << st.st_type << ", 大小 " << st.st_size << ", 块 " << st.st_blocks
+              << (rc == 0 && st.st_type == T_FILE && st.st_size == static_cast<int>(content.size()) &&
+                          st.st_blocks == 2 && st.st_nlink == 1 && st.st_blksize == BLOCK_SIZE
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "lstat /st/lnk: 类型 " << lst.st_type << ", 大小 " << lst.st_size
+              << (lrc == 0 && lst.st_type == T_SYMLINK && lst.st_size == 4 && lst.st_blocks == 0 ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::cout << "fstat: i-节点 " << fst.st_ino
+              << (frc == 0 && fst.st_ino == st.st_ino && fst.st_size == st.st_size ? " (预期)" : " (异常!)") << std::endl;
+    std::cout << "stat 不存在的路径: " << (fs.stat("/st/none", st) == -1 ? "失败 (预期)" : "(异常!)") << std::endl;
+
+    // 2. 重复 stat 由缓存返回，不读块
+    const int repeat = 1000;
+    MiniFS::IOStats before = fs.getIOStats();
+    bool same = true;
+    for (int i = 0; i < repeat; i++) {
+        same = same && fs.fstat(fd, st) == 0 && st.st_size == fst.st_size;
+    }
+    MiniFS::IOStats after = fs.getIOStats();
+    std::cout << "重复 fstat " << repeat << " 次: 命中 " << (after.attr_cache_hits - before.attr_cache_hits)
+              << " 次, 读块 " << (after.meta_reads - before.meta_reads) << " 次"
+              << (same && after.attr_cache_hits - before.attr_cache_hits == repeat && after.meta_reads == before.meta_reads
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    // 3. 修改i-节点后缓存随之更新
+    fs.write(fd, "tail", 4);
+    fs.link(fst.st_ino, dir, "data2");
+    fs.fstat(fd, st);
+    std::cout << "追加并建立硬链接后: 大小 " << st.st_size << ", 链接 " << st.st_nlink
+              << (st.st_size == static_cast<int>(content.size()) + 4 && st.st_nlink == 2 ? " (预期)" : " (异常!)")
+              << std::endl;
+    fs.ftruncate(fd, 10);
+    fs.fstat(fd, st);
+    std::cout << "截断到10字节后: 大小 " << st.st_size << ", 块 " << st.st_blocks
+              << (st.st_size == 10 && st.st_blocks == 1 ? " (预期)" : " (异常!)") << std::endl;
+    int data_inum = fst.st_ino;
+    fs.close(fd);
+    fs.unlink(dir, "data");
+    fs.unlink(dir, "data2");
+    std::cout << "删除后 statInode: " << (fs.statInode(data_inum, st) == -1 ? "失败 (预期)" : "(异常!)") << std::endl;
+
+    // 4. readdirplus 顺带填充缓存，列目录后逐项 stat 不再读块
+    for (int i = 0; i < 6; i++) {
+        fs.mkdir(dir, ("d" + std::to_string(i)).c_str());
+    }
+    std::vector<MiniFS::DirEntryPlus> items;
+    fs.readdirplus(dir, items);
+    before = fs.getIOStats();
+    bool match = true;
+    for (const MiniFS::DirEntryPlus& item : items) {
+        match = match && fs.statInode(item.entry.inum, st) == 0 && st.st_type == item.attr.type &&
+                st.st_nlink == item.attr.nlink && st.st_size == item.attr.size;
+    }
+    after = fs.getIOStats();
+    std::cout << "readdirplus 后逐项 stat: " << items.size() << " 项, 读块 " << (after.meta_reads - before.meta_reads)
+              << " 次" << (match && after.meta_reads == before.meta_reads ? " (预期)" : " (异常!)") << std::endl;
+
+    // 清理
+    for (int i = 0; i < 6; i++) {
+        fs.rmdir(dir, ("d" + std::to_string(i)).c_str());
+    }
+    fs.unlink(dir, "lnk");
+    fs.rmdir(root_inum, "st");
+    std::cout << "--- stat 与属性缓存测试结束 ---" << std::endl;
+}
+
+// 测试时间戳与访问时间更新策略
+void test_timestamp_operations(MiniFS& fs) {
+    std::cout << "\n--- 开始时间戳测试 ---" << std::endl;
+    int root_inum = MiniFS::ROOT_INUM_CONST;
+    uint32_t t0 = static_cast<uint32_t>(std::time(nullptr));
+    int dir = fs.mkdir(root_inum, "ts");
+    int fd = fs.open(dir, "f", MiniFS::O_CREATE | MiniFS::O_RDWR);
+    std::string content(BLOCK_SIZE + 10, 't');
+    fs.write(fd, content.data(), static_cast<int>(content.size()));
+    int inum = fs._lookup_in_directory(dir, "f");
+    uint32_t t1 = static_cast<uint32_t>(std::time(nullptr));
+
+    // 1. 新建文件三个时间都是当前时间；所在目录的修改时间随之更新
+    MiniFS::FileStat st, dst;
+    fs.statInode(inum, st);
+    fs.statInode(dir, dst);
+    bool fresh = st.st_atim >= t0 && st.st_atim <= t1 && st.st_mtim >= t0 && st.st_mtim <= t1 &&
+                 st.st_ctim >= t0 && st.st_ctim <= t1 && dst.st_mtim >= t0 && dst.st_mtim <= t1;
+    std::cout << "新建文件: 访问 " << formatTimestamp(st.st_atim) << ", 修改 " << formatTimestamp(st.st_mtim)
+              << (fresh ? " (预期)" : " (异常!)") << std::endl;
+
+    // 把时间戳改到过去: 修改/改变时间 base，访问时间 access
+    const uint32_t day = 24 * 60 * 60;
+    auto set_past = [&](uint32_t base, uint32_t access) {
+        dinode node;
+        fs._get_inode(inum, node);
+        node.mtime = base;
+        node.ctime = base;
+        node.atime = access;
+        fs._write_inode(inum, node);
+    };
+    char buf[64];
+
+    // 2. relatime: 访问时间晚于修改时间且不满一天时不更新；超过一天时更新，但只记在内存中
+    fs.setAtimePolicy(MiniFS::AtimePolicy::RELATIME);
+    set_past(t0 - 1000, t0 - 500);
+    fs.pread(fd, buf, sizeof(buf), 0);
+    fs.statInode(inum, st);
+    std::cout << "relatime, 访问时间晚于修改时间: "
+              << (st.st_atim == t0 - 500 && fs.pendingTimes() == 0 ? "不更新 (预期)" : "(异常!)") << std::endl;
+    set_past(t0 - 3 * day, t0 - 2 * day);
+    MiniFS::IOStats before = fs.getIOStats();
+    fs.pread(fd, buf, sizeof(buf), 0);
+    MiniFS::IOStats after = fs.getIOStats();
+    fs.statInode(inum, st);
+    std::cout << "relatime, 访问时间已超过一天: " << (st.st_atim >= t0 ? "更新" : "未更新") << ", 待写回 "
+              << fs.pendingTimes() << " 个, 写块 " << (after.meta_writes - before.meta_writes) << " 次"
+              << (st.st_atim >= t0 && fs.pendingTimes() == 1 && after.meta_writes == before.meta_writes
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+    std::vector<MiniFS::DirEntryPlus> items;
+    fs.readdirplus(dir, items);
+    uint32_t listed_atime = 0;
+    for (const MiniFS::DirEntryPlus& item : items) {
+        if (item.entry.name == "f") {
+            listed_atime = item.attr.atime;
+        }
+    }
+    std::cout << "readdirplus 的访问时间与 stat 一致 (尚未写回): "
+              << (listed_atime == st.st_atim ? "是 (预期)" : "否 (异常!)") << std::endl;
+    fs.flushTimes();
+
+    // 3. noatime 从不更新，strict 每次都更新
+    fs.setAtimePolicy(MiniFS::AtimePolicy::NOATIME);
+    set_past(t0 - 3 * day, t0 - 2 * day);
+    fs.pread(fd, buf, sizeof(buf), 0);
+    fs.statInode(inum, st);
+    std::cout << "noatime: " << (st.st_atim == t0 - 2 * day && fs.pendingTimes() == 0 ? "不更新 (预期)" : "(异常!)")
+              << std::endl;
+    fs.setAtimePolicy(MiniFS::AtimePolicy::STRICT);
+    set_past(t0 - 1000, t0 - 10);
+    fs.pread(fd, buf, sizeof(buf), 0);
+    fs.statInode(inum, st);
+    std::cout << "strict: " << (st.st_atim >= t0 ? "更新 (预期)" : "(异常!)") << std::endl;
+
+    // 4. 大量读取不写块；flushTimes 按i-节点块成批写回
+    const int files = 10;
+    for (int i = 0; i < files; i++) {
+        std::string name = "r" + std::to_string(i);
+        int rfd = fs.open(dir, name.c_str(), MiniFS::O_CREATE | MiniFS::O_RDWR);
+        fs.write(rfd, "data", 4);
+        fs.close(rfd);
+    }
+    fs.flushTimes();
+    before = fs.getIOStats();
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < files; i++) {
+            std::string name = "r" + std::to_string(i);
+            int rfd = fs.open(dir, name.c_str(), MiniFS::O_RDONLY);
+            fs.read(rfd, buf, 4);
+            fs.close(rfd);
+        }
+    }
+    after = fs.getIOStats();
+    int pending = fs.pendingTimes();
+    std::cout << "strict 下读取 " << files << " 个文件各 5 次: 写块 " << (after.meta_writes - before.meta_writes)
+              << " 次, 待写回 " << pending << " 个"
+              << (after.meta_writes == before.meta_writes && pending >= files ? " (预期)" : " (异常!)") << std::endl;
+    before = fs.getIOStats();
+    int flushed = fs.flushTimes();
+    after = fs.getIOStats();
+    long flush_writes = after.meta_writes - before.meta_writes;
+    dinode node;
+    fs._get_inode(fs._lookup_in_directory(dir, "r0"), node);
+    std::cout << "flushTimes 写回 " << flushed << " 个i-节点, 写元数据块 " << flush_writes << " 次"
+              << (flushed == pending && flush_writes < flushed && fs.pendingTimes() == 0 && node.atime >= t0
+                      ? " (预期)" : " (异常!)")
+              << std::endl;
+
+    // 5. 写入更新修改/改变时间；setTimes 还原时间戳并更新改变时间
+    set_past(t0 - 1000, t0 - 1000);
+    fs.pwrite(fd, "x", 1, 0);
+    fs.fstat(fd, st);
+    std::cout << "写入后修改时间: " << (st.st_mtim >= t0 && st.st_ctim >= t0 ? "更新 (预期)" : "(异常!)") << std::endl;
+    fs.setTimes(inum, 1000000000u, 1200000000u);
+    fs.fstat(fd, st);
+    std::cout << "setTimes: 访问 " << st.st_atim << ", 修改 " << st.st_mtim
+              << (st.st_atim == 1000000000u && st.st_mtim == 1200000000u && st.st_ctim >= t0 ? " (预期)" : " (异常!)")
+              << std::endl;
+    set_past(t0 - 1000, t0 - 1000);
+    fs.link(inum, dir, "f2");
+    fs.fstat(fd, st);
+    std::cout << "建立硬链接后: " << (st.st_ctim >= t0 && st.st_mtim == t0 - 1000 ? "只更新改变时间 (预期)" : "(异常!)")
+              << std::endl;
+
+    // 6. 释放的i-节点丢弃暂存的访问时间
+    fs.close(fd);
+    fs.unlink(dir, "f2");
+    fd = fs.open(dir, "f", MiniFS::O_RDONLY);
+    fs.read(fd, buf, 4);
+    fs.close(fd);
+    int before_unlink = fs.pendingTimes();
+    fs.unlink(dir, "f");
+    std::cout << "删除有待写回访问时间的文件: 待写回 " << before_unlink << " -> " << fs.pendingTimes()
+              << (fs.pendingTimes() == before_unlink - 1 ? " (预期)" : " (异常!)") << std::endl;
+
+    // 清理
+    fs.setAtimePolicy(MiniFS::AtimePolicy::RELATIME);
+    for (int i = 0; i < files; i++) {
+        fs.unlink(dir, ("r" + std::to_string(i)).c_str());
+    }
+    fs.rmdir(root_inum, "ts");
+    fs.flushTimes();
+    std::cout << "--- 时间戳测试结束 ---" << std::endl;
+}
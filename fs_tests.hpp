@@ -8,5 +8,51 @@ void test_directory_operations(MiniFS& fs);
 void test_file_operations(MiniFS& fs);
 // 测试MiniFS中的用户管理功能
 void test_user_operations(MiniFS& fs);
+// 测试元数据与文件数据的CRC32C校验、巡检
+void test_checksum_operations(MiniFS& fs);
+// 测试硬链接、链接数与延迟释放
+void test_link_operations(MiniFS& fs);
+// 测试符号链接的创建、内联存放与路径跟随
+void test_symlink_operations(MiniFS& fs);
+// 测试重命名、跨目录移动与原子替换
+void test_rename_operations(MiniFS& fs);
+// 测试 truncate/ftruncate 与 O_TRUNC/O_APPEND
+void test_truncate_operations(MiniFS& fs);
+// 测试稀疏文件、SEEK_DATA/SEEK_HOLE 与 fallocate
+void test_sparse_operations(MiniFS& fs);
+// 测试小文件内联存放与迁出
+void test_inline_operations(MiniFS& fs);
+// 测试新分配数据块的延迟清零 (unwritten 标志)
+void test_lazy_zero_operations(MiniFS& fs);
+// 测试 balloc_n/ialloc_n 批量分配
+void test_batch_alloc_operations(MiniFS& fs);
+// 测试宿主目录树的批量导入/导出
+void test_bulk_import_operations(MiniFS& fs);
+// 测试多线程流水线导入与有界无锁队列
+void test_pipeline_import_operations(MiniFS& fs);
+// 测试批处理 (脚本) 模式
+void test_batch_shell_operations(MiniFS& fs);
+// 测试 shell 当前目录路径缓存的增量更新与失效
+void test_cwd_cache_operations(MiniFS& fs);
+// 测试 cp-in/cp-out 与 cat 重定向
+void test_copy_operations(MiniFS& fs);
+// 测试 Unix 域套接字 RPC 服务端与客户端
+void test_rpc_operations(MiniFS& fs);
+// 测试镜像块设备 (io_uring/pread) 与增量写回
+void test_block_device_operations(MiniFS& fs);
+// 测试顺序读预读
+void test_readahead_operations(MiniFS& fs);
+// 测试异步接口 (执行器、回调与协程)
+void test_async_operations(MiniFS& fs);
+// 测试工作窃取线程池与并行目录树遍历/巡检
+void test_work_stealing_operations(MiniFS& fs);
+// 测试递归删除、递归复制与空间统计 (rm -r / cp -r / du)
+void test_tree_operations(MiniFS& fs);
+// 测试目录游标 (带类型的 readdir) 与批量取属性的 readdirplus
+void test_readdir_operations(MiniFS& fs);
+// 测试 stat/lstat/fstat 与属性缓存
+void test_stat_operations(MiniFS& fs);
+// 测试时间戳与访问时间更新策略 (strict/relatime/noatime)
+void test_timestamp_operations(MiniFS& fs);
 
 #endif // FS_TESTS_HPP
\ No newline at end of file
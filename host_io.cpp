@@ -0,0 +1,226 @@
+#include "host_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string joinPath(const std::string& dir, const std::string& name) {
+    if (dir.empty() || dir[dir.size() - 1] == '/') {
+        return dir + name;
+    }
+    return dir + "/" + name;
+}
+
+bool statNoFollow(const std::string& path, struct stat& st) {
+#ifdef _WIN32
+    return ::stat(path.c_str(), &st) == 0; // Windows 上没有 lstat，也不导入符号链接
+#else
+    return ::lstat(path.c_str(), &st) == 0;
+#endif
+}
+
+// 只导入目录、普通文件和符号链接，设备、管道、套接字等跳过
+bool isImportable(const struct stat& st) {
+#ifndef _WIN32
+    if (S_ISLNK(st.st_mode)) {
+        return true;
+    }
+#endif
+    return S_ISDIR(st.st_mode) || S_ISREG(st.st_mode);
+}
+
+bool makeDir(const std::string& path) {
+#ifdef _WIN32
+    int rc = ::_mkdir(path.c_str());
+#else
+    int rc = ::mkdir(path.c_str(), 0755);
+#endif
+    if (rc == 0) {
+        return true;
+    }
+    struct stat st;
+    return errno == EEXIST && ::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool readFileContents(const std::string& path, std::string& out) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return !in.bad();
+}
+
+bool byName(const HostNode& a, const HostNode& b) {
+    return a.name < b.name;
+}
+
+bool readNode(const std::string& path, HostNode& node, std::string& error, bool load_file_data) {
+    struct stat st;
+    if (!statNoFollow(path, st)) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        node.kind = HostNode::DIR_NODE;
+        DIR* dir = ::opendir(path.c_str());
+        if (dir == NULL) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct dirent* ent;
+        while ((ent = ::readdir(dir)) != NULL) {
+            std::string name = ent->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string child_path = joinPath(path, name);
+            struct stat child_st;
+            if (statNoFollow(child_path, child_st) && !isImportable(child_st)) {
+                std::cerr << "警告: 跳过特殊文件 " << child_path << std::endl;
+                continue;
+            }
+            HostNode child;
+            child.name = name;
+            if (!readNode(child_path, child, error, load_file_data)) {
+                ::closedir(dir);
+                return false;
+            }
+            node.children.push_back(child);
+        }
+        ::closedir(dir);
+        // 排序后导入时i-节点号和数据块按名称顺序分配，目录项也按名称排列
+        std::sort(node.children.begin(), node.children.end(), byName);
+        return true;
+    }
+#ifndef _WIN32
+    if (S_ISLNK(st.st_mode)) {
+        node.kind = HostNode::SYMLINK_NODE;
+        std::vector<char> buf(static_cast<size_t>(st.st_size) + 1);
+        ssize_t n = ::readlink(path.c_str(), &buf[0], buf.size());
+        if (n < 0) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        node.data.assign(&buf[0], static_cast<size_t>(n));
+        return true;
+    }
+#endif
+    if (S_ISREG(st.st_mode)) {
+        node.kind = HostNode::FILE_NODE;
+        node.size = static_cast<long long>(st.st_size);
+        if (load_file_data && !readFileContents(path, node.data)) {
+            error = path + ": 读取失败";
+            return false;
+        }
+        return true;
+    }
+
+    error = path + ": 不支持的文件类型";
+    return false;
+}
+
+} // namespace
+
+bool readHostTree(const std::string& path, HostNode& out, std::string& error, bool load_file_data) {
+    out = HostNode();
+    return readNode(path, out, error, load_file_data);
+}
+
+bool readHostFile(const std::string& path, std::string& out, std::string& error) {
+    if (!readFileContents(path, out)) {
+        error = path + ": 读取失败";
+        return false;
+    }
+    return true;
+}
+
+bool writeHostTree(const std::string& path, const HostNode& node, std::string& error) {
+    switch (node.kind) {
+    case HostNode::DIR_NODE:
+        if (!makeDir(path)) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        for (const HostNode& child : node.children) {
+            if (!writeHostTree(joinPath(path, child.name), child, error)) {
+                return false;
+            }
+        }
+        return true;
+
+    case HostNode::SYMLINK_NODE:
+#ifdef _WIN32
+        std::cerr << "警告: Windows 上不导出符号链接 " << path << " -> " << node.data << std::endl;
+        return true;
+#else
+        ::unlink(path.c_str()); // 覆盖已有的同名项
+        if (::symlink(node.data.c_str(), path.c_str()) != 0) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        return true;
+#endif
+
+    case HostNode::FILE_NODE: {
+        std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(node.data.data(), node.data.size())) {
+            error = path + ": 写入失败";
+            return false;
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+bool removeHostTree(const std::string& path) {
+    struct stat st;
+    if (!statNoFollow(path, st)) {
+        return errno == ENOENT;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = ::opendir(path.c_str());
+        if (dir == NULL) {
+            return false;
+        }
+        std::vector<std::string> names;
+        struct dirent* ent;
+        while ((ent = ::readdir(dir)) != NULL) {
+            std::string name = ent->d_name;
+            if (name != "." && name != "..") {
+                names.push_back(name);
+            }
+        }
+        ::closedir(dir);
+        for (const std::string& name : names) {
+            if (!removeHostTree(joinPath(path, name))) {
+                return false;
+            }
+        }
+#ifdef _WIN32
+        return ::_rmdir(path.c_str()) == 0;
+#else
+        return ::rmdir(path.c_str()) == 0;
+#endif
+    }
+    return std::remove(path.c_str()) == 0;
+}
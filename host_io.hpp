@@ -0,0 +1,35 @@
+#ifndef HOST_IO_HPP
+#define HOST_IO_HPP
+
+#include <string>
+#include <vector>
+
+// 宿主文件系统上的目录树，作为批量导入/导出的中间表示
+// 本头文件不依赖 minifs.hpp，host_io.cpp 也不包含它: <dirent.h> 的 struct dirent 与 MiniFS 的 dirent 同名
+struct HostNode {
+    enum Kind { FILE_NODE, DIR_NODE, SYMLINK_NODE };
+    Kind kind;
+    std::string name;               // 单个路径组件，根节点可以为空
+    std::string data;               // 文件内容，或符号链接的目标
+    long long size;                 // 文件大小 (未加载内容时 data 为空，只有 size)
+    std::vector<HostNode> children; // 目录的子项，按名称排序
+
+    HostNode() : kind(FILE_NODE), size(0) {}
+
+    long long fileSize() const { return data.empty() ? size : static_cast<long long>(data.size()); }
+};
+
+// 递归读取宿主目录 path (不跟随符号链接)，跳过设备、管道等特殊文件；失败时 error 为原因
+// load_file_data 为 false 时只读取目录结构和文件大小，文件内容留给调用者按需读取
+bool readHostTree(const std::string& path, HostNode& out, std::string& error, bool load_file_data = true);
+
+// 读取单个宿主文件的全部内容
+bool readHostFile(const std::string& path, std::string& out, std::string& error);
+
+// 把 node 写到宿主路径 path: 目录逐级创建 (已存在时复用)，文件覆盖写入
+bool writeHostTree(const std::string& path, const HostNode& node, std::string& error);
+
+// 递归删除宿主路径 (测试清理用)，不存在时视为成功
+bool removeHostTree(const std::string& path);
+
+#endif // HOST_IO_HPP
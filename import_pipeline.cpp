@@ -0,0 +1,162 @@
+#include "import_pipeline.hpp"
+#include "bounded_queue.hpp"
+#include "minifs.hpp"
+
+#include <map>
+
+namespace {
+
+// 读线程 → 分配阶段: 一个文件的完整内容
+struct FileData {
+    size_t index;                       // 在延后文件列表中的下标
+    std::shared_ptr<std::string> data;  // 读取失败时为空
+};
+
+// 分配阶段 → 写块线程: 一个已分配的数据块
+struct BlockWrite {
+    int block;                          // 绝对块号，-1 表示结束
+    std::shared_ptr<std::string> data;  // 所属文件的内容 (多个块共享)
+    int offset;                         // 本块在文件中的起始偏移
+};
+
+// 记录每个文件节点对应的宿主路径
+void collectHostPaths(const HostNode& dir, const std::string& path,
+                      std::map<const HostNode*, std::string>& paths) {
+    for (const HostNode& child : dir.children) {
+        std::string child_path = path + "/" + child.name;
+        if (child.kind == HostNode::DIR_NODE) {
+            collectHostPaths(child, child_path, paths);
+        } else if (child.kind == HostNode::FILE_NODE) {
+            paths[&child] = child_path;
+        }
+    }
+}
+
+} // namespace
+
+int pipelineImport(MiniFS& fs, const std::string& host_dir, int dest_dir_inum,
+                   const PipelineOptions& options, PipelineStats* stats) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PipelineStats local = {0, 0, 0, 0, 0.0};
+
+    // 1. 只读目录结构和文件大小，先建好全部元数据
+    HostNode tree;
+    std::string error;
+    if (!readHostTree(host_dir, tree, error, false)) {
+        std::cerr << "错误: " << error << std::endl;
+        return -1;
+    }
+    std::vector<MiniFS::BulkFile> files;
+    int created = fs.bulkImport(tree, dest_dir_inum, &files);
+    if (created < 0) {
+        return -1;
+    }
+    std::map<const HostNode*, std::string> paths;
+    collectHostPaths(tree, host_dir, paths);
+    // 读线程只按下标读这个数组 (std::map::operator[] 查不到时会插入，不能在多个线程中调用)
+    std::vector<std::string> file_paths(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        file_paths[i] = paths[files[i].node];
+    }
+    const std::vector<std::string>& host_paths = file_paths;
+
+    int reader_count = std::max(1, options.reader_threads);
+    int writer_count = std::max(1, options.writer_threads);
+    BoundedQueue<FileData> read_queue(static_cast<size_t>(std::max(1, options.queue_capacity)));
+    BoundedQueue<BlockWrite> write_queue(static_cast<size_t>(std::max(1, options.queue_capacity)) * 8);
+
+    // 2. 读线程: 按下标领取文件，读完整个文件后交给分配阶段
+    std::atomic<size_t> next_file(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < reader_count; t++) {
+        readers.push_back(std::thread([&]() {
+            for (;;) {
+                size_t index = next_file++;
+                if (index >= files.size()) {
+                    break;
+                }
+                FileData item;
+                item.index = index;
+                std::shared_ptr<std::string> content(new std::string());
+                std::string read_error;
+                if (readHostFile(host_paths[index], *content, read_error)) {
+                    item.data = content;
+                } else {
+                    std::cerr << "错误: " << read_error << std::endl;
+                }
+                read_queue.push(item);
+            }
+        }));
+    }
+
+    // 4. 写块线程: 把一块数据补齐到整块后直接写入镜像
+    std::vector<std::thread> writers;
+    for (int t = 0; t < writer_count; t++) {
+        writers.push_back(std::thread([&]() {
+            Byte buf[BLOCK_SIZE];
+            for (;;) {
+                BlockWrite item;
+                write_queue.pop(item);
+                if (item.block < 0) {
+                    break;
+                }
+                int chunk = std::min(BLOCK_SIZE, static_cast<int>(item.data->size()) - item.offset);
+                std::memset(buf, 0, sizeof(buf));
+                std::memcpy(buf, item.data->data() + item.offset, chunk);
+                fs.writeDataBlockDirect(item.block, buf);
+            }
+        }));
+    }
+
+    // 3. 分配阶段 (当前线程): 唯一修改位图和i-节点的地方，按到达顺序为文件分配连续的块
+    std::vector<std::pair<int, dinode> > inodes;
+    int goal = 0;
+    for (size_t n = 0; n < files.size(); n++) {
+        FileData item;
+        read_queue.pop(item);
+        dinode node;
+        std::vector<int> blocks;
+        if (!item.data || fs.bulkLayoutFile(*item.data, goal, node, blocks) != 0) {
+            local.failed_files++;
+            continue;
+        }
+        for (size_t b = 0; b < blocks.size(); b++) {
+            if (blocks[b] == 0) {
+                continue; // 空洞
+            }
+            BlockWrite write = { blocks[b], item.data, static_cast<int>(b) * BLOCK_SIZE };
+            write_queue.push(write);
+            goal = blocks[b] + 1;
+            local.blocks++;
+        }
+        inodes.push_back(std::make_pair(files[item.index].inum, node));
+        local.files++;
+        local.bytes += static_cast<long long>(item.data->size());
+    }
+    for (int t = 0; t < writer_count; t++) {
+        BlockWrite stop = { -1, std::shared_ptr<std::string>(), 0 };
+        write_queue.push(stop);
+    }
+    for (std::thread& t : readers) {
+        t.join();
+    }
+    for (std::thread& t : writers) {
+        t.join();
+    }
+
+    // 数据块全部落盘后再写回i-节点，每个i-节点块只写一次
+    fs._write_inodes(inodes);
+
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    std::cout << "流水线导入完成: " << created << " 个i-节点, " << local.files << " 个文件, " << local.blocks
+              << " 个数据块, " << local.bytes << " 字节, " << local.seconds * 1000 << " ms ("
+              << reader_count << " 读线程, " << writer_count << " 写线程)" << std::endl;
+    if (local.failed_files > 0) {
+        std::cerr << "错误: " << local.failed_files << " 个文件的内容导入失败，已保留为空文件" << std::endl;
+        return -1;
+    }
+    return created;
+}
@@ -0,0 +1,34 @@
+#ifndef IMPORT_PIPELINE_HPP
+#define IMPORT_PIPELINE_HPP
+
+#include <string>
+
+class MiniFS; // 前向声明 MiniFS 类
+
+// 流水线导入的线程数与队列容量
+struct PipelineOptions {
+    int reader_threads;   // 读取宿主文件的线程数
+    int writer_threads;   // 填写数据块的线程数
+    int queue_capacity;   // 读取队列的容量 (文件个数)，写块队列为其 8 倍 (块数)
+
+    PipelineOptions() : reader_threads(2), writer_threads(2), queue_capacity(64) {}
+};
+
+struct PipelineStats {
+    int files;          // 导入内容的文件数
+    int failed_files;   // 读取或分配失败的文件数 (在镜像中保留为空文件)
+    long blocks;        // 写入的数据块数
+    long long bytes;    // 文件内容总字节数
+    double seconds;     // 总耗时
+};
+
+// 多级流水线导入宿主目录 host_dir 的内容到 dest_dir_inum 目录下:
+//   1. 调用者线程先用 bulkImport 一次性建好目录、符号链接和全部i-节点 (文件内容延后)
+//   2. 读线程并行读取宿主文件 → 有界无锁队列 →
+//   3. 单个分配阶段 (调用者线程) 为每个文件分配连续数据块并生成i-节点 → 有界无锁队列 →
+//   4. 写块线程把数据直接填入镜像的数据块
+// 返回新建的i-节点个数；结构检查失败返回-1 (镜像不变)，有文件内容导入失败时也返回-1 (见 stats)
+int pipelineImport(MiniFS& fs, const std::string& host_dir, int dest_dir_inum,
+                   const PipelineOptions& options = PipelineOptions(), PipelineStats* stats = nullptr);
+
+#endif // IMPORT_PIPELINE_HPP
@@ -2,11 +2,181 @@
 #include "shell_utils.hpp"
 #include "minifs.hpp"
 #include "encoding_utils.hpp"
+#include "import_pipeline.hpp"
+#include "rpc_server.hpp"
+#include "rpc_client.hpp"
+
+#include <csignal>
+#include <cstdlib>
+
+// 离线批量工具: 不进入交互界面，处理完直接保存镜像
+//   --mkfs   <宿主目录> [镜像]           格式化新镜像，并把宿主目录的内容导入根目录
+//   --import <宿主目录> [镜像] [镜像内目录] 导入到已有镜像 (不存在时先格式化)
+//   --export <镜像内路径> <宿主目录> [镜像] 把镜像中的子树导出到宿主目录
+static int runBulkTool(const std::string& mode, int argc, char* argv[]) {
+    int min_args = (mode == "--export") ? 4 : 3;
+    if (argc < min_args) {
+        std::cerr << "用法: minifs --mkfs <宿主目录> [镜像]\n"
+                  << "      minifs --import <宿主目录> [镜像] [镜像内目录]\n"
+                  << "      minifs --export <镜像内路径> <宿主目录> [镜像]" << std::endl;
+        return 1;
+    }
+    std::string image = "my_unix_fs.dat";
+    if (mode == "--export" && argc > 4) {
+        image = argv[4];
+    } else if (mode != "--export" && argc > 3) {
+        image = argv[3];
+    }
+
+    MiniFS fs;
+    if (mode == "--mkfs" || fs.loadFS(image) != MiniFS::FSStatus::OK) {
+        std::cout << "格式化新镜像: " << image << std::endl;
+        fs.format();
+    }
+
+    std::string error;
+    if (mode == "--export") {
+        int inum = fs.resolve_path_to_inum(argv[2]);
+        HostNode tree;
+        if (inum == MiniFS::INVALID_INUM_CONST || fs.bulkExport(inum, tree) != 0) {
+            std::cerr << "错误: 无法导出 " << argv[2] << std::endl;
+            return 1;
+        }
+        if (!writeHostTree(argv[3], tree, error)) {
+            std::cerr << "错误: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "已导出 " << argv[2] << " 到 " << argv[3] << std::endl;
+        return 0;
+    }
+
+    // 读文件与写数据块各用一半的硬件线程
+    PipelineOptions options;
+    int hw_threads = static_cast<int>(std::thread::hardware_concurrency());
+    options.reader_threads = std::max(1, hw_threads / 2);
+    options.writer_threads = std::max(1, hw_threads / 2);
+    int dest = fs.resolve_path_to_inum(mode == "--import" && argc > 4 ? argv[4] : "/");
+    if (dest == MiniFS::INVALID_INUM_CONST || pipelineImport(fs, argv[2], dest, options) < 0) {
+        std::cerr << "错误: 导入失败，镜像未修改" << std::endl;
+        return 1;
+    }
+    if (fs.saveFS(image) != 0) {
+        std::cerr << "错误: 保存镜像 " << image << " 失败" << std::endl;
+        return 1;
+    }
+    std::cout << "已导入 " << argv[2] << " 到镜像 " << image << std::endl;
+    return 0;
+}
+
+static RpcServer* g_rpc_server = nullptr;
+
+static void onServerSignal(int) {
+    if (g_rpc_server != nullptr) {
+        g_rpc_server->stop();
+    }
+}
+
+// 服务端模式: --serve [镜像] [套接字] [--verbose]
+// 持有镜像并通过 Unix 域套接字为本机多个客户端服务，收到 SIGINT/SIGTERM 后写回改动过的块退出
+static int runServer(int argc, char* argv[]) {
+    std::string image = "my_unix_fs.dat";
+    std::string socket_path = "minifs.sock";
+    bool verbose = false;
+    int positional = 0;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--verbose") {
+            verbose = true;
+        } else if (positional == 0) {
+            image = arg;
+            positional++;
+        } else {
+            socket_path = arg;
+        }
+    }
+
+    MiniFS fs;
+    if (fs.loadFS(image) != MiniFS::FSStatus::OK) {
+        std::cout << "格式化新镜像: " << image << std::endl;
+        fs.format();
+    }
+    RpcServer server(fs);
+    if (!server.listen(socket_path)) {
+        return 1;
+    }
+    g_rpc_server = &server;
+    std::signal(SIGINT, onServerSignal);
+    std::signal(SIGTERM, onServerSignal);
+    std::cout << "MiniFS 服务已启动: " << socket_path << " (镜像: " << image << ")，Ctrl+C 退出" << std::endl;
+
+    // MiniFS 每次打开、读写都会往 stdout 打印进度，服务期间默认关闭
+    std::streambuf* saved_cout = std::cout.rdbuf();
+    if (!verbose) {
+        std::cout.rdbuf(nullptr);
+    }
+    int rc = server.run();
+    std::cout.rdbuf(saved_cout);
+    std::cout.clear();
+    g_rpc_server = nullptr;
+
+    RpcServer::Stats stats = server.getStats();
+    std::cout << "服务结束: 连接 " << stats.connections << "，请求 " << stats.requests
+              << "，操作 " << stats.ops << std::endl;
+    // 只写回服务期间改动过的块
+    if (fs.syncFS(image) < 0) {
+        std::cerr << "错误: 保存镜像 " << image << " 失败" << std::endl;
+        return 1;
+    }
+    return rc == 0 ? 0 : 1;
+}
+
+// 负载生成: --loadgen [套接字] [--clients N] [--ops N] [--batch N]
+static int runLoadGenTool(int argc, char* argv[]) {
+    std::string socket_path = "minifs.sock";
+    LoadGenOptions options;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--clients" || arg == "--ops" || arg == "--batch") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (arg == "--clients") {
+                options.clients = value;
+            } else if (arg == "--ops") {
+                options.ops_per_client = value;
+            } else {
+                options.batch = value;
+            }
+        } else if (arg[0] != '-') {
+            socket_path = arg;
+        } else {
+            std::cerr << "用法: minifs --loadgen [套接字] [--clients N] [--ops N] [--batch N]" << std::endl;
+            return 1;
+        }
+    }
+    // 每个客户端在根目录下建一个文件并占用一个文件描述符
+    if (options.clients < 1 || options.clients > 8 || options.ops_per_client < 1 || options.batch < 0) {
+        std::cerr << "错误: 客户端数须为 1-8，迭代次数须为正数" << std::endl;
+        return 1;
+    }
+    return runLoadGen(socket_path, options);
+}
 
 // 在 main 函数中
 int main(int argc, char *argv[]) {
     // 初始化控制台编码，解决中文乱码问题
     EncodingUtils::initConsoleEncoding();
+
+    if (argc > 1) {
+        std::string mode = argv[1];
+        if (mode == "--mkfs" || mode == "--import" || mode == "--export") {
+            return runBulkTool(mode, argc, argv);
+        }
+        if (mode == "--serve") {
+            return runServer(argc, argv);
+        }
+        if (mode == "--loadgen") {
+            return runLoadGenTool(argc, argv);
+        }
+    }
     
     const std::string fsfile = "my_unix_fs.dat";
     MiniFS fs;
@@ -29,6 +199,29 @@ int main(int argc, char *argv[]) {
         std::cout << "\n========== 测试模式 ==========" << std::endl;
         test_bitmap_operations(fs);
         test_directory_operations(fs);
+        test_checksum_operations(fs);
+        test_link_operations(fs);
+        test_symlink_operations(fs);
+        test_rename_operations(fs);
+        test_truncate_operations(fs);
+        test_sparse_operations(fs);
+        test_inline_operations(fs);
+        test_lazy_zero_operations(fs);
+        test_batch_alloc_operations(fs);
+        test_bulk_import_operations(fs);
+        test_pipeline_import_operations(fs);
+        test_batch_shell_operations(fs);
+        test_cwd_cache_operations(fs);
+        test_copy_operations(fs);
+        test_rpc_operations(fs);
+        test_block_device_operations(fs);
+        test_readahead_operations(fs);
+        test_async_operations(fs);
+        test_work_stealing_operations(fs);
+        test_tree_operations(fs);
+        test_readdir_operations(fs);
+        test_stat_operations(fs);
+        test_timestamp_operations(fs);
         
         // 保存文件系统状态
         std::cout << "正在保存文件系统..." << std::endl;
@@ -38,6 +231,32 @@ int main(int argc, char *argv[]) {
             std::cout << "保存文件系统失败!" << std::endl;
         }
     } 
+    else if (argc > 2 && std::string(argv[1]) == "--batch") {
+        // 批处理模式：--batch <脚本|-> [--save-at-end] [--echo]，"-" 表示从标准输入读取
+        BatchOptions options;
+        for (int i = 3; i < argc; i++) {
+            std::string opt = argv[i];
+            if (opt == "--save-at-end") {
+                options.save_at_end = true;
+            } else if (opt == "--echo") {
+                options.echo = true;
+            } else {
+                std::cerr << "未知的批处理选项: " << opt << std::endl;
+                return 1;
+            }
+        }
+        std::string script_path = argv[2];
+        if (script_path == "-") {
+            runBatchShell(fs, fsfile, std::cin, options);
+        } else {
+            std::ifstream script(script_path.c_str());
+            if (!script) {
+                std::cerr << "错误: 无法打开脚本 " << script_path << std::endl;
+                return 1;
+            }
+            runBatchShell(fs, fsfile, script, options);
+        }
+    }
     else 
     {
         // 交互模式：启动命令行界面
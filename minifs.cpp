@@ -1,16 +1,31 @@
 #include "fs_tests.hpp"
 #include "shell_utils.hpp"
 #include "user.hpp"  // 在实现文件中引入user.hpp
+#include "work_stealing.hpp"
+#include <deque>
+#include <ctime>
 
 
 // 构造函数 - 初始化虚拟磁盘
-MiniFS::MiniFS() : userManager() { // 在构造函数初始化列表中初始化 userManager,这里因为没初始化一直报错，一定要初始化
+MiniFS::MiniFS() : userManager(), // 在构造函数初始化列表中初始化 userManager,这里因为没初始化一直报错，一定要初始化
+    dirty_blocks(BLOCK_COUNT, 0), meta_csum_enabled(false), csum_verified(BLOCK_COUNT, false),
+    csum_verified_count(0), csum_failure_count(0), data_csum_failure_count(0),
+    scrub_stop(false), scrub_passes(0), scrub_files(0), scrub_blocks(0), scrub_mismatches(0),
+    io_meta_reads(0), io_meta_writes(0), io_data_reads(0), io_data_writes(0),
+    io_readahead_fills(0), io_readahead_hits(0), io_attr_cache_hits(0), io_attr_cache_misses(0) {
+    _invalidate_attr_cache();
+    atime_policy = AtimePolicy::RELATIME;
+    std::fill(pending_atime, pending_atime + INODE_NUM, 0);
+    pending_atime_count = 0;
     // 初始化文件描述符表
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         fd_table[i].is_used = false;
         fd_table[i].inum = -1;
         fd_table[i].position = 0;
         fd_table[i].mode = 0;
+        fd_table[i].ra_next = 0;
+        fd_table[i].ra_window = 0;
+        fd_table[i].ra_len = 0;
     }
     
     try {
@@ -62,11 +77,29 @@ MiniFS::MiniFS() : userManager() { // 在构造函数初始化列表中初始化
 // MiniFS 析构函数
 MiniFS::~MiniFS() {
     // userManager 作为 MiniFS 的直接成员，其析构函数会自动调用，无需手动 delete
+    // 后台巡检线程和线程池中的任务访问本对象，析构前必须停下
+    stopScrubber();
+    work_pool.reset();
+}
+
+WorkStealingPool& MiniFS::_work_pool()
+{
+    std::lock_guard<std::mutex> lk(work_pool_mutex);
+    if (!work_pool) {
+        work_pool.reset(new WorkStealingPool());
+    }
+    return *work_pool;
+}
+
+int MiniFS::workerThreads()
+{
+    return _work_pool().threadCount();
 }
 
 // 块读取方法
 void MiniFS::readBlock(int blockNum, void* buf) 
 {
+    FSLock lock(fs_mutex);
     try {
         // 增加安全检查，确保不会越界访问
         if (blockNum < 0 || blockNum >= BLOCK_COUNT) {
@@ -103,6 +136,16 @@ void MiniFS::readBlock(int blockNum, void* buf)
         // 计算源地址并执行复制
         const void* src_addr = disk.data() + blockNum * BLOCK_SIZE;
         std::memcpy(buf, src_addr, BLOCK_SIZE);
+        if (blockNum < DATA_START) {
+            io_meta_reads++;
+        } else {
+            io_data_reads++;
+        }
+
+        // 固定元数据块在首次读取时校验CRC32C
+        if (meta_csum_enabled && blockNum < DATA_START && !csum_verified[blockNum]) {
+            _verify_meta_block(blockNum);
+        }
     }
     catch (const std::exception& e) {
         std::cerr << "readBlock 发生异常: " << e.what() << std::endl;
@@ -120,6 +163,7 @@ void MiniFS::readBlock(int blockNum, void* buf)
 //
 void MiniFS::writeBlock(int blockNum, const void* buf) 
 {
+    FSLock lock(fs_mutex);
     // 增加安全检查，确保不会越界访问
     if (blockNum < 0 || blockNum >= BLOCK_COUNT) {
         std::cerr << "错误: writeBlock 尝试写入无效块号: " << blockNum 
@@ -144,10 +188,156 @@ void MiniFS::writeBlock(int blockNum, const void* buf)
     }
     
     std::memcpy(disk.data() + blockNum * BLOCK_SIZE, buf, BLOCK_SIZE);
+    if (blockNum >= INODE_START && blockNum < DATA_START && attr_block_cached[blockNum - INODE_START]) {
+        _decode_attr_block(blockNum - INODE_START, static_cast<const Byte*>(buf));
+    }
+    if (static_cast<size_t>(blockNum) < dirty_blocks.size()) {
+        dirty_blocks[blockNum] = 1;
+    }
+    if (blockNum < DATA_START) {
+        io_meta_writes++;
+    } else {
+        io_data_writes++;
+    }
+
+    // 写元数据块时同步更新超级块中的校验和
+    if (meta_csum_enabled && blockNum < DATA_START) {
+        _note_meta_write(blockNum);
+    }
+}
+
+// 不加锁的数据块写入: 只做范围检查，disk 在导入期间不会改变大小，不同线程写的是不同的块
+void MiniFS::writeDataBlockDirect(int blockNum, const void* buf)
+{
+    if (blockNum < DATA_START || blockNum >= BLOCK_COUNT ||
+        disk.size() < static_cast<size_t>(blockNum + 1) * BLOCK_SIZE) {
+        std::cerr << "错误: writeDataBlockDirect 无效的数据块号: " << blockNum << std::endl;
+        return;
+    }
+    std::memcpy(disk.data() + blockNum * BLOCK_SIZE, buf, BLOCK_SIZE);
+    dirty_blocks[blockNum] = 1;
+    io_data_writes++;
+}
+
+// 重新计算超级块自身的校验和 (sb_csum 字段按0参与计算)
+void MiniFS::_seal_superblock()
+{
+    superblock* sb = reinterpret_cast<superblock*>(disk.data());
+    sb->sb_csum = 0;
+    sb->sb_csum = crc32c(disk.data(), BLOCK_SIZE);
+}
+
+// 元数据块被写入: 更新其在超级块中的校验和，新内容视为已校验
+void MiniFS::_note_meta_write(int blockNum)
+{
+    if (blockNum > 0) {
+        superblock* sb = reinterpret_cast<superblock*>(disk.data());
+        sb->meta_csum[blockNum] = crc32c(disk.data() + blockNum * BLOCK_SIZE, BLOCK_SIZE);
+    }
+    _seal_superblock();
+    csum_verified[blockNum] = true;
+    csum_verified[0] = true;
+}
+
+// 校验一个固定元数据块，失败时计数并报错 (数据照常返回，由调用者自行处理)
+void MiniFS::_verify_meta_block(int blockNum)
+{
+    // 其它元数据块的校验和存放在超级块中，先确认超级块本身可信
+    if (blockNum != 0 && !csum_verified[0]) {
+        _verify_meta_block(0);
+    }
+    csum_verified[blockNum] = true;
+    csum_verified_count++;
+
+    const superblock* sb = reinterpret_cast<const superblock*>(disk.data());
+    uint32_t expected;
+    uint32_t actual;
+    if (blockNum == 0) {
+        Byte tmp[BLOCK_SIZE];
+        std::memcpy(tmp, disk.data(), BLOCK_SIZE);
+        reinterpret_cast<superblock*>(tmp)->sb_csum = 0;
+        expected = sb->sb_csum;
+        actual = crc32c(tmp, BLOCK_SIZE);
+    } else {
+        expected = sb->meta_csum[blockNum];
+        actual = crc32c(disk.data() + blockNum * BLOCK_SIZE, BLOCK_SIZE);
+    }
+
+    if (actual != expected) {
+        csum_failure_count++;
+        std::cerr << "错误: 元数据块 " << blockNum << " 校验失败 (预期 0x" << std::hex << expected
+                  << ", 实际 0x" << actual << std::dec << ")" << std::endl;
+    }
+}
+
+// 获取校验统计
+MiniFS::ChecksumStats MiniFS::getChecksumStats() const
+{
+    FSLock lock(fs_mutex);
+    ChecksumStats stats;
+    stats.verified = csum_verified_count;
+    stats.failures = csum_failure_count;
+    stats.data_failures = data_csum_failure_count;
+    return stats;
+}
+
+// 立即校验全部元数据块和所有目录块，返回本次发现的失败块数
+int MiniFS::verifyAllMetadata()
+{
+    FSLock lock(fs_mutex);
+    if (!meta_csum_enabled) {
+        return 0;
+    }
+    long failures_before = csum_failure_count;
+    std::fill(csum_verified.begin(), csum_verified.end(), false);
+
+    Byte buf[BLOCK_SIZE];
+    for (int b = 0; b < DATA_START; b++) {
+        readBlock(b, buf);
+    }
+    for (int inum = 1; inum < INODE_NUM; inum++) {
+        dinode node;
+        if (_get_inode(inum, node) && node.type == T_DIR) {
+            dirent entries[BLOCK_SIZE / sizeof(dirent)];
+            _read_dir_block(node, entries);
+        }
+    }
+    return static_cast<int>(csum_failure_count - failures_before);
+}
+
+// 按当前内容重新生成全部元数据校验和 (用于旧版镜像升级)
+void MiniFS::rebuildMetadataChecksums()
+{
+    FSLock lock(fs_mutex);
+    // 当前内容即为可信内容，重建期间的读取不做校验
+    meta_csum_enabled = true;
+    std::fill(csum_verified.begin(), csum_verified.end(), true);
+
+    // 旧版 format 把超级块结构体之后的栈内容也写进了0号块，这里清掉
+    superblock* sb = reinterpret_cast<superblock*>(disk.data());
+    std::memset(disk.data() + offsetof(superblock, magic), 0, BLOCK_SIZE - offsetof(superblock, magic));
+    sb->magic = FS_MAGIC;
+    sb->features = FS_FEATURE_META_CSUM;
+
+    // 目录块的校验和存放在目录i-节点中
+    for (int inum = 1; inum < INODE_NUM; inum++) {
+        dinode node;
+        if (_get_inode(inum, node) && node.type == T_DIR &&
+            node.addrs[0] >= DATA_START && node.addrs[0] < BLOCK_COUNT) {
+            node.dir_csum = crc32c(disk.data() + node.addrs[0] * BLOCK_SIZE, BLOCK_SIZE);
+            csum_verified[node.addrs[0]] = true;
+            _write_inode(inum, node);
+        }
+    }
+    for (int b = 1; b < DATA_START; b++) {
+        _note_meta_write(b);
+    }
 }
 
 // 保存文件系统到本地文件
 int MiniFS::saveFS(const std::string& filename) {
+    FSLock lock(fs_mutex);
+    flushTimes();
     try {
         // 创建备份文件名
         std::string backupFilename = filename + ".bak";
@@ -191,6 +381,9 @@ int MiniFS::saveFS(const std::string& filename) {
             std::cerr << "写入磁盘镜像时出错: 预期写入 " << disk.size() << " 字节" << std::endl;
             return -1;
         }
+        if (backing && filename == backing_path) {
+            std::fill(dirty_blocks.begin(), dirty_blocks.end(), 0); // 已打开的镜像文件与内存一致
+        }
         
         return 0;
     }
@@ -200,33 +393,114 @@ int MiniFS::saveFS(const std::string& filename) {
     }
 }
 
+// 增量写回到镜像文件
+int MiniFS::syncFS(const std::string& filename) {
+    FSLock lock(fs_mutex);
+    flushTimes();
+    bool full = false;
+    // 只读加载的镜像: 重新以读写方式打开，仍不可写时报错返回，内存中的改动保留 (脏块不清除)
+    if (!backing || backing_path != filename || backing->isReadOnly()) {
+        std::string error;
+        std::unique_ptr<BlockDevice> dev = openBlockDevice(filename, BLOCK_SIZE, true, error);
+        if (!dev) {
+            std::cerr << "无法打开镜像文件: " << error << std::endl;
+            return -1;
+        }
+        dev->registerBuffer(disk.data(), disk.size());
+        backing = std::move(dev);
+        backing_path = filename;
+        full = true; // 新打开的文件内容未知，整体写入
+    }
+    if (backing->sizeBytes() != static_cast<long long>(disk.size())) {
+        if (!backing->resize(static_cast<long long>(disk.size()))) {
+            std::cerr << "无法调整镜像文件大小: " << filename << std::endl;
+            return -1;
+        }
+        full = true;
+    }
+
+    bool any_dirty = full || std::find(dirty_blocks.begin(), dirty_blocks.end(), 1) != dirty_blocks.end();
+    if (!any_dirty) {
+        return 0;
+    }
+    dirty_blocks[0] = 1; // 超级块 (含各元数据块的校验和) 会被直接改写，总是一起写回
+
+    // 相邻的脏块合并为一个请求，全部提交后再统一等待
+    int written = 0;
+    for (int b = 0; b < BLOCK_COUNT;) {
+        if (!full && !dirty_blocks[b]) {
+            b++;
+            continue;
+        }
+        int start = b;
+        while (b < BLOCK_COUNT && (full || dirty_blocks[b]) && b - start < BACKING_CHUNK_BLOCKS) {
+            b++;
+        }
+        backing->submitWrite(start, b - start, disk.data() + static_cast<size_t>(start) * BLOCK_SIZE);
+        written += b - start;
+    }
+    if (backing->wait() != 0 || !backing->flush()) {
+        std::cerr << "写回镜像时出错: " << filename << std::endl;
+        return -1;
+    }
+    std::fill(dirty_blocks.begin(), dirty_blocks.end(), 0);
+    return written;
+}
+
+BlockDevice::Stats MiniFS::getBackingStats() const {
+    FSLock lock(fs_mutex);
+    if (!backing) {
+        BlockDevice::Stats empty = {0, 0, 0};
+        return empty;
+    }
+    return backing->getStats();
+}
+
+const char* MiniFS::backingDeviceName() const {
+    FSLock lock(fs_mutex);
+    return backing ? backing->name() : "";
+}
+
 // 加载文件系统到内存
 MiniFS::FSStatus MiniFS::loadFS(const std::string& filename) {
+    FSLock lock(fs_mutex);
     try {
-        std::ifstream inFile(filename, std::ios::binary);
-        if (!inFile) {
+        std::string error;
+        std::unique_ptr<BlockDevice> dev = openBlockDevice(filename, BLOCK_SIZE, false, error);
+        if (!dev) {
             std::cerr << "无法打开文件 " << filename << std::endl;
             return FSStatus::FAIL;
         }
 
         // 检查文件大小
-        inFile.seekg(0, std::ios::end);
-        std::streampos fileSize = inFile.tellg();
-        inFile.seekg(0, std::ios::beg);
-        
+        long long fileSize = dev->sizeBytes();
         if (fileSize != BLOCK_SIZE * BLOCK_COUNT) {
             std::cerr << "文件大小不匹配: 预期 " << (BLOCK_SIZE * BLOCK_COUNT) 
                       << " 字节, 实际 " << fileSize << " 字节" << std::endl;
             return FSStatus::CORRUPT;
         }
         
-        // 读取文件内容到虚拟磁盘
-        inFile.read(reinterpret_cast<char*>(disk.data()), disk.size());
-        if (!inFile || inFile.gcount() != disk.size()) {
-            std::cerr << "读取磁盘镜像时出错: 预期读取 " << disk.size() 
-                      << " 字节, 实际读取 " << inFile.gcount() << " 字节" << std::endl;
+        // 读取文件内容到虚拟磁盘: 整个 disk 登记为固定缓冲区 (disk 构造后不再改变大小)，
+        // 按 BACKING_CHUNK_BLOCKS 块一个请求全部提交后再统一等待
+        dev->registerBuffer(disk.data(), disk.size());
+        for (int b = 0; b < BLOCK_COUNT; b += BACKING_CHUNK_BLOCKS) {
+            int count = std::min(BACKING_CHUNK_BLOCKS, BLOCK_COUNT - b);
+            dev->submitRead(b, count, disk.data() + static_cast<size_t>(b) * BLOCK_SIZE);
+        }
+        _invalidate_attr_cache();
+        std::fill(pending_atime, pending_atime + INODE_NUM, 0);
+        pending_atime_count = 0;
+        if (dev->wait() != 0) {
+            std::cerr << "读取磁盘镜像时出错: 预期读取 " << disk.size() << " 字节" << std::endl;
             return FSStatus::CORRUPT;
         }
+        if (dev->isReadOnly()) {
+            std::cout << "镜像文件 " << filename << " 不可写，以只读方式加载 (syncFS 需要可写的镜像)" << std::endl;
+        }
+        // 之后的改动 (生成校验和、回收孤儿) 相对镜像文件都是脏块
+        backing = std::move(dev);
+        backing_path = filename;
+        std::fill(dirty_blocks.begin(), dirty_blocks.end(), 0);
         
         // 验证超级块基本信息
         superblock sb;
@@ -235,6 +509,27 @@ MiniFS::FSStatus MiniFS::loadFS(const std::string& filename) {
             std::cerr << "文件系统超级块信息不一致，可能已损坏" << std::endl;
             return FSStatus::CORRUPT;
         }
+
+        // 整个镜像被替换，已打开文件的预读缓冲区全部作废
+        for (int i = 0; i < MAX_OPEN_FILES; i++) {
+            fd_table[i].ra_len = 0;
+        }
+
+        // 元数据校验: 新镜像按需校验，旧版镜像没有校验和，按当前内容生成
+        std::fill(csum_verified.begin(), csum_verified.end(), false);
+        if (sb.magic == FS_MAGIC && (sb.features & FS_FEATURE_META_CSUM)) {
+            meta_csum_enabled = true;
+            _verify_meta_block(0);
+        } else {
+            std::cout << "旧版镜像没有元数据校验和，正在生成..." << std::endl;
+            rebuildMetadataChecksums();
+        }
+
+        // 刚加载时没有任何打开的文件，链接数为0的i-节点都是孤儿
+        int orphans = _reclaim_orphans();
+        if (orphans > 0) {
+            std::cout << "已回收 " << orphans << " 个已删除但未释放的i-节点" << std::endl;
+        }
         
         return FSStatus::OK;
     }
@@ -247,9 +542,15 @@ MiniFS::FSStatus MiniFS::loadFS(const std::string& filename) {
 // 格式化文件系统
 void MiniFS::format() 
 {
+    FSLock lock(fs_mutex);
     Byte buf[BLOCK_SIZE];//临时变量，用作初始化
+    // 格式化会重写全部元数据块，写入时顺带生成校验和，期间的读取不做校验
+    meta_csum_enabled = true;
+    std::fill(csum_verified.begin(), csum_verified.end(), true);
+
     // 1. 初始化超级块
-    superblock sb;
+    std::memset(buf, 0, BLOCK_SIZE);
+    superblock& sb = *reinterpret_cast<superblock*>(buf);
     sb.size = BLOCK_COUNT;
     sb.ninodes = INODE_NUM;
     sb.nblocks = DATA_BLOCKS_NUM;
@@ -257,7 +558,9 @@ void MiniFS::format()
     sb.data_start = DATA_START;
     sb.inode_bitmap_start_block = INODE_BITMAP_BLOCK_START;
     sb.data_bitmap_start_block = DATA_BITMAP_BLOCK_START;
-    writeBlock(0, &sb); // 0号块写超级块
+    sb.magic = FS_MAGIC;
+    sb.features = FS_FEATURE_META_CSUM;
+    writeBlock(0, buf); // 0号块写超级块
 
 
     //5.  初始化i节点位图块和数据块位图块，对一块全部置0
@@ -280,6 +583,8 @@ void MiniFS::format()
     dinode inode;
     std::memset(&inode, 0, sizeof(dinode));
     inode.type = T_FREE;
+    std::fill(pending_atime, pending_atime + INODE_NUM, 0);
+    pending_atime_count = 0;
     
     for (int i = 0; i < INODE_NUM; ++i) {
         int block = INODE_START + (i * INODE_SIZE) / BLOCK_SIZE;
@@ -300,27 +605,25 @@ void MiniFS::format()
     rootInode.size = 2 * sizeof(dirent); //先分配两个文件项dirent: 一个给.另一个给..
     rootInode.nlink = 2;
     rootInode.addrs[0] = rootDataBlock;
+    _touch(rootInode, TIME_ATIME | TIME_MTIME | TIME_CTIME);
     set_bit(INODE_BITMAP_BLOCK_START, rootInum);
-
-    //更新Inodes
-    // 写回根目录i-节点，1号结点对应第一块数据块
-    int block = INODE_START + (rootInum * INODE_SIZE) / BLOCK_SIZE;
-    int offset = (rootInum * INODE_SIZE) % BLOCK_SIZE;
-    readBlock(block, buf);
-    std::memcpy(buf + offset, &rootInode, sizeof(dinode));
-    writeBlock(block, buf);
     set_bit(DATA_BITMAP_BLOCK_START, 0);// 标记数据区的第0个块已使用
 
-
     //更新对应的数据块
-    // 4. 初始化根目录数据块
-    dirent entries[2];
+    // 4. 初始化根目录数据块 (先写数据块，得到目录块校验和后再写i-节点)
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    std::memset(entries, 0, sizeof(entries));
     entries[0].inum = rootInum;//当前目录inum是1
+    entries[0].type = T_DIR;
     std::strcpy(entries[0].name, ".");
     entries[1].inum = rootInum;//根目录下，父目录指向本身，所以inum也是1
+    entries[1].type = T_DIR;
     std::strcpy(entries[1].name, "..");
-    writeBlock(rootDataBlock, entries);
+    _write_dir_block(rootInode, entries);
 
+    //更新Inodes
+    // 写回根目录i-节点，1号结点对应第一块数据块
+    _write_inode(rootInum, rootInode);
 
 }
 
@@ -344,6 +647,7 @@ void MiniFS::format()
  */
 int MiniFS::mkdir(int parent_dir_inum, const char* name)
 {
+    FSLock lock(fs_mutex);
     std::cout << "开始创建目录: " << name << " (parent inum: " << parent_dir_inum << ")" << std::endl;
     
     if (strlen(name) >= DIRSIZ) {
@@ -352,14 +656,12 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
     }
 
     // 1. 读取父目录i-节点
-    int parent_block = INODE_START + (parent_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int parent_offset = (parent_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
     //从存放i节点的块中拿出数据，存到parent_inode中
-    Byte buf[BLOCK_SIZE];
-    readBlock(parent_block, buf);
     dinode parent_inode;
-    std::memcpy(&parent_inode, buf + parent_offset, sizeof(dinode));
+    if (!_get_inode(parent_dir_inum, parent_inode)) {
+        std::cerr << "错误: 无法读取父目录i-节点 " << parent_dir_inum << std::endl;
+        return -1;
+    }
     
     // 确认父节点是一个目录
     if (parent_inode.type != T_DIR) {
@@ -370,7 +672,7 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
     // 2. 检查同名冲突,目录项就是个大数组，遍历每一个目录项的名字，查看是否有重名
     int entries_count = parent_inode.size / sizeof(dirent);
     dirent entries[BLOCK_SIZE / sizeof(dirent)];
-    readBlock(parent_inode.addrs[0], entries);  // 简化: 假设目录项都在第一个数据块
+    _read_dir_block(parent_inode, entries);  // 简化: 假设目录项都在第一个数据块
     
     for (int i = 0; i < entries_count; i++) {
         if (std::strcmp(entries[i].name, name) == 0) {
@@ -378,6 +680,10 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
             return -1;
         }
     }
+    if (entries_count >= static_cast<int>(BLOCK_SIZE / sizeof(dirent))) {
+        std::cerr << "错误: 父目录已满 (最多 " << BLOCK_SIZE / sizeof(dirent) << " 项)" << std::endl;
+        return -1;
+    }
     
     // 3. 分配新目录的i-节点
     int child_dir_inum = ialloc(T_DIR);
@@ -387,7 +693,7 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
     }
     
     // 4. 分配新目录的数据块
-    int child_dir_data_block = balloc();
+    int child_dir_data_block = balloc(false); // 下面立即整块写入 . 和 ..
     if (child_dir_data_block == -1) {
         std::cerr << "错误: 无法分配数据块" << std::endl;
         ifree(child_dir_inum); // 释放之前分配的i-节点
@@ -395,44 +701,45 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
     }
     
     // 5. 初始化新目录的i-节点
-    int child_dir_block = INODE_START + (child_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int child_dir_offset = (child_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    readBlock(child_dir_block, buf);
-    dinode* child_dir_inode = reinterpret_cast<dinode*>(buf + child_dir_offset);
-    
-    child_dir_inode->type = T_DIR;
-    child_dir_inode->size = 2 * sizeof(dirent);  // 包含 . 和 .. 两个条目
-    child_dir_inode->nlink = 2;  // 自身的 . 和来自父目录的链接
-    child_dir_inode->addrs[0] = child_dir_data_block;
-    writeBlock(child_dir_block, buf);
+    dinode child_dir_inode;
+    std::memset(&child_dir_inode, 0, sizeof(dinode));
+    child_dir_inode.type = T_DIR;
+    child_dir_inode.size = 2 * sizeof(dirent);  // 包含 . 和 .. 两个条目
+    child_dir_inode.nlink = 2;  // 自身的 . 和来自父目录的链接
+    child_dir_inode.addrs[0] = child_dir_data_block;
+    _touch(child_dir_inode, TIME_ATIME | TIME_MTIME | TIME_CTIME);
     
-    // 6. 初始化新目录的数据块 (创建 . 和 .. 条目)
-    dirent child_dir_entries[2];
+    // 6. 初始化新目录的数据块 (创建 . 和 .. 条目)，写块时得到校验和，再写i-节点
+    dirent child_dir_entries[BLOCK_SIZE / sizeof(dirent)];
+    std::memset(child_dir_entries, 0, sizeof(child_dir_entries));
     // "." 条目，指向自身
     child_dir_entries[0].inum = child_dir_inum;
+    child_dir_entries[0].type = T_DIR;
     std::strcpy(child_dir_entries[0].name, ".");
     // ".." 条目，指向父目录
     child_dir_entries[1].inum = parent_dir_inum;
+    child_dir_entries[1].type = T_DIR;
     std::strcpy(child_dir_entries[1].name, "..");
-    writeBlock(child_dir_data_block, child_dir_entries);
+    _write_dir_block(child_dir_inode, child_dir_entries);
+    _write_inode(child_dir_inum, child_dir_inode);
     
     // 7. 在父目录中添加新目录条目
     // 简化：假设父目录数据块有足够空间
     dirent new_entry;
+    std::memset(&new_entry, 0, sizeof(dirent));
     new_entry.inum = child_dir_inum;
+    new_entry.type = T_DIR;
     std::strcpy(new_entry.name, name);
     entries[entries_count] = new_entry; //增加这个entry
 
     
     // 8. 写回更新后的父目录数据
-    writeBlock(parent_inode.addrs[0], entries);
+    _write_dir_block(parent_inode, entries);
     
     // 9. 写回更新后的父目录i-节点
     parent_inode.size += sizeof(dirent);  // 增加父目录大小
     parent_inode.nlink++;  // 增加父目录链接数 (新目录的 .. 链接到父目录)
-    std::memcpy(buf + parent_offset, &parent_inode, sizeof(dinode));
-    writeBlock(parent_block, buf);
+    _write_inode(parent_dir_inum, parent_inode);
     
     std::cout << "成功创建目录: " << name << " (inum: " << child_dir_inum << ")" << std::endl;
     
@@ -442,42 +749,34 @@ int MiniFS::mkdir(int parent_dir_inum, const char* name)
 // 列出指定目录的内容
 void MiniFS::listDir(int dir_inum) 
 {
+    FSLock lock(fs_mutex);
     std::cout << "正在列出目录内容 (inum: " << dir_inum << ")..." << std::endl;
     
     try {
-        // 1. 读取目录的i-节点
-        int block = INODE_START + (dir_inum * INODE_SIZE) / BLOCK_SIZE;
-        int offset = (dir_inum * INODE_SIZE) % BLOCK_SIZE;
-        
-        Byte buf[BLOCK_SIZE];
-        std::memset(buf, 0, sizeof(buf));
-        readBlock(block, buf);
-        
-        dinode dir_inode;
-        std::memcpy(&dir_inode, buf + offset, sizeof(dinode));
-        
-        // 确保是目录类型
-        if (dir_inode.type != T_DIR) {
-            std::cerr << "错误：i-节点 " << dir_inum << " 不是目录类型 (type: " << dir_inode.type << ")" << std::endl;
+        // 1. 一次读出全部目录项及其i-节点
+        std::vector<DirEntryPlus> items;
+        if (readdirplus(dir_inum, items) < 0) {
             return;
         }
         
-        // 2. 读取目录数据块
-        int entries_count = dir_inode.size / sizeof(dirent);
-        dirent entries[BLOCK_SIZE / sizeof(dirent)];
-        std::memset(entries, 0, sizeof(entries));
-        readBlock(dir_inode.addrs[0], entries);  //假设目录项都在第一个数据块
-        
-        // 3. 打印目录项
-        std::cout << "目录内容 (共 " << entries_count << " 项)：" << std::endl;
-        std::cout << std::left << std::setw(30) << "名称" << "i-节点号" << std::endl;
-        std::cout << std::string(40, '-') << std::endl;
+        // 2. 打印目录项
+        std::cout << "目录内容 (共 " << items.size() << " 项)：" << std::endl;
+        std::cout << std::left << std::setw(30) << "名称" << std::setw(6) << "类型" << std::setw(10) << "i-节点号"
+                  << std::setw(6) << "链接" << std::setw(8) << "大小" << "修改时间" << std::endl;
+        std::cout << std::string(80, '-') << std::endl;
         
         //遍历目录项
-        for (int i = 0; i < entries_count; ++i) 
+        for (const DirEntryPlus& item : items) 
         {
-            std::cout << std::left << std::setw(30) << entries[i].name 
-                      << entries[i].inum << std::endl;
+            const char* type = item.entry.type == T_DIR ? "d" : item.entry.type == T_SYMLINK ? "l" : "-";
+            std::cout << std::left << std::setw(30) << item.entry.name << std::setw(6) << type
+                      << std::setw(10) << item.entry.inum << std::setw(6) << item.attr.nlink << std::setw(8)
+                      << item.attr.size << formatTimestamp(item.attr.mtime);
+            std::string target;
+            if (item.attr.type == T_SYMLINK && _read_symlink(item.attr, target)) {
+                std::cout << "  -> " << target;
+            }
+            std::cout << std::endl;
         }
         
         std::cout << std::endl;
@@ -487,9 +786,310 @@ void MiniFS::listDir(int dir_inum)
     }
 }
 
+int MiniFS::opendir(int dir_inum, DirCursor& cursor)
+{
+    FSLock lock(fs_mutex);
+    cursor.dir_inum = dir_inum;
+    cursor.pos = 0;
+    cursor.entries.clear();
+    dinode dir;
+    if (!_get_inode(dir_inum, dir) || dir.type != T_DIR) {
+        std::cerr << "错误: i-节点 " << dir_inum << " 不是目录" << std::endl;
+        return -1;
+    }
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    if (!_read_dir_block(dir, entries)) {
+        return -1;
+    }
+    // 只有 size 以内的项有效 (删除时用最后一项填补空位，块中之后的内容是旧数据)
+    cursor.entries.assign(entries, entries + dir.size / sizeof(dirent));
+    _touch_atime(dir_inum);
+    return 0;
+}
+
+bool MiniFS::readdir(DirCursor& cursor, DirEntry& out)
+{
+    while (cursor.pos < cursor.entries.size()) {
+        const dirent& e = cursor.entries[cursor.pos++];
+        if (e.inum <= 0 || e.inum >= INODE_NUM) {
+            continue;
+        }
+        out.inum = e.inum;
+        out.type = e.type;
+        out.name.assign(e.name, strnlen(e.name, DIRSIZ));
+        if (out.type != T_FILE && out.type != T_DIR && out.type != T_SYMLINK) {
+            dinode node; // 旧版镜像的目录项
+            out.type = _get_inode(e.inum, node) ? node.type : 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+int MiniFS::readdirplus(int dir_inum, std::vector<DirEntryPlus>& out)
+{
+    FSLock lock(fs_mutex);
+    out.clear();
+    DirCursor cursor;
+    if (opendir(dir_inum, cursor) != 0) {
+        return -1;
+    }
+    // 不经过 readdir: 没有类型的旧目录项不必单独读i-节点，类型由下面取到的属性补齐
+    DirEntryPlus item;
+    std::memset(&item.attr, 0, sizeof(dinode));
+    for (const dirent& e : cursor.entries) {
+        if (e.inum <= 0 || e.inum >= INODE_NUM) {
+            continue;
+        }
+        item.entry.inum = e.inum;
+        item.entry.type = e.type;
+        item.entry.name.assign(e.name, strnlen(e.name, DIRSIZ));
+        out.push_back(item);
+    }
+    // 按i-节点号排序后逐块读取，同一块中的i-节点一起取出
+    std::vector<size_t> order(out.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&out](size_t a, size_t b) { return out[a].entry.inum < out[b].entry.inum; });
+    Byte buf[BLOCK_SIZE];
+    int current_block = -1;
+    for (size_t idx : order) {
+        int inum = out[idx].entry.inum;
+        int block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
+        if (block != current_block) {
+            readBlock(block, buf);
+            current_block = block;
+        }
+        std::memcpy(&out[idx].attr, buf + (inum * INODE_SIZE) % BLOCK_SIZE, sizeof(dinode));
+        if (pending_atime[inum] != 0) {
+            out[idx].attr.atime = pending_atime[inum]; // 与 _get_inode 相同，叠加尚未写回的访问时间
+        }
+        out[idx].entry.type = out[idx].attr.type;
+        if (!attr_block_cached[block - INODE_START]) {
+            _decode_attr_block(block - INODE_START, buf); // 列目录之后紧接着的 stat 直接命中
+        }
+    }
+    return static_cast<int>(out.size());
+}
+
+// 解码一个i-节点块中全部i-节点的属性 (调用者持有 fs_mutex)
+void MiniFS::_decode_attr_block(int inode_block, const Byte* buf)
+{
+    const int per_block = BLOCK_SIZE / INODE_SIZE;
+    for (int i = 0; i < per_block; i++) {
+        dinode node;
+        std::memcpy(&node, buf + i * INODE_SIZE, sizeof(dinode));
+        CachedAttr& a = attr_cache[inode_block * per_block + i];
+        a.type = node.type;
+        a.nlink = node.nlink;
+        a.size = node.size;
+        a.blocks = (node.type == T_FREE) ? 0 : _inode_blocks(node, nullptr);
+        a.atime = node.atime;
+        a.mtime = node.mtime;
+        a.ctime = node.ctime;
+    }
+    attr_block_cached[inode_block] = true;
+}
+
+void MiniFS::_invalidate_attr_cache()
+{
+    std::fill(attr_block_cached, attr_block_cached + INODE_BLOCKS, false);
+}
+
+int MiniFS::statInode(int inum, FileStat& st)
+{
+    FSLock lock(fs_mutex);
+    if (inum <= 0 || inum >= INODE_NUM) {
+        return -1;
+    }
+    int inode_block = (inum * INODE_SIZE) / BLOCK_SIZE;
+    if (attr_block_cached[inode_block]) {
+        io_attr_cache_hits++;
+    } else {
+        io_attr_cache_misses++;
+        Byte buf[BLOCK_SIZE];
+        readBlock(INODE_START + inode_block, buf);
+        _decode_attr_block(inode_block, buf);
+    }
+    const CachedAttr& a = attr_cache[inum];
+    if (a.type == T_FREE) {
+        return -1;
+    }
+    st.st_ino = inum;
+    st.st_type = a.type;
+    st.st_nlink = a.nlink;
+    st.st_size = a.size;
+    st.st_blocks = a.blocks;
+    st.st_blksize = BLOCK_SIZE;
+    st.st_atim = pending_atime[inum] != 0 ? pending_atime[inum] : a.atime;
+    st.st_mtim = a.mtime;
+    st.st_ctim = a.ctime;
+    return 0;
+}
+
+int MiniFS::stat(const std::string& path, FileStat& st, int base_inum)
+{
+    FSLock lock(fs_mutex);
+    int inum = resolve_path_to_inum(path, base_inum, true);
+    return inum == INVALID_INUM_CONST ? -1 : statInode(inum, st);
+}
+
+int MiniFS::lstat(const std::string& path, FileStat& st, int base_inum)
+{
+    FSLock lock(fs_mutex);
+    int inum = resolve_path_to_inum(path, base_inum, false);
+    return inum == INVALID_INUM_CONST ? -1 : statInode(inum, st);
+}
+
+int MiniFS::fstat(int fd, FileStat& st)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    return statInode(fd_table[fd].inum, st);
+}
+
+int MiniFS::setTimes(int inum, uint32_t atime, uint32_t mtime)
+{
+    FSLock lock(fs_mutex);
+    dinode node;
+    if (!_get_inode(inum, node)) {
+        std::cerr << "错误: i-节点 " << inum << " 不存在" << std::endl;
+        return -1;
+    }
+    _drop_pending_atime(inum); // 否则写回时会被暂存的访问时间覆盖
+    node.atime = atime;
+    node.mtime = mtime;
+    _touch(node, TIME_CTIME);
+    _write_inode(inum, node);
+    return 0;
+}
+
+std::string formatTimestamp(uint32_t t)
+{
+    if (t == 0) {
+        return "-";
+    }
+    std::time_t tt = static_cast<std::time_t>(t);
+    char buf[32];
+    std::tm* tm = std::localtime(&tt);
+    if (tm == nullptr || std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", tm) == 0) {
+        return std::to_string(t);
+    }
+    return buf;
+}
+
+uint32_t MiniFS::_now()
+{
+    return static_cast<uint32_t>(std::time(nullptr));
+}
+
+// 把 which 指定的时间戳设为当前时间 (只改内存中的 node，由调用者写回)
+void MiniFS::_touch(dinode& node, int which)
+{
+    uint32_t now = _now();
+    if (which & TIME_ATIME) {
+        node.atime = now;
+    }
+    if (which & TIME_MTIME) {
+        node.mtime = now;
+    }
+    if (which & TIME_CTIME) {
+        node.ctime = now;
+    }
+}
+
+// 读取后按策略记录访问时间: 只写 pending_atime，不写i-节点块 (调用者持有 fs_mutex)
+void MiniFS::_touch_atime(int inum)
+{
+    if (atime_policy == AtimePolicy::NOATIME || inum <= 0 || inum >= INODE_NUM) {
+        return;
+    }
+    uint32_t now = _now();
+    if (atime_policy == AtimePolicy::RELATIME) {
+        FileStat st;
+        if (statInode(inum, st) != 0) {
+            return;
+        }
+        bool stale = st.st_atim <= st.st_mtim || st.st_atim <= st.st_ctim ||
+                     (now > st.st_atim && now - st.st_atim >= RELATIME_INTERVAL);
+        if (!stale) {
+            return;
+        }
+    }
+    if (pending_atime[inum] == 0) {
+        pending_atime_count++;
+    }
+    pending_atime[inum] = now;
+}
+
+void MiniFS::_drop_pending_atime(int inum)
+{
+    if (pending_atime[inum] != 0) {
+        pending_atime[inum] = 0;
+        pending_atime_count--;
+    }
+}
+
+void MiniFS::setAtimePolicy(AtimePolicy policy)
+{
+    FSLock lock(fs_mutex);
+    atime_policy = policy;
+}
+
+MiniFS::AtimePolicy MiniFS::getAtimePolicy() const
+{
+    FSLock lock(fs_mutex);
+    return atime_policy;
+}
+
+int MiniFS::pendingTimes() const
+{
+    FSLock lock(fs_mutex);
+    return pending_atime_count;
+}
+
+// 按i-节点号顺序写回暂存的访问时间，同一块中的i-节点一起写，每块读写一次
+int MiniFS::flushTimes()
+{
+    FSLock lock(fs_mutex);
+    if (pending_atime_count == 0) {
+        return 0;
+    }
+    int written = 0;
+    Byte buf[BLOCK_SIZE];
+    int current_block = -1;
+    for (int inum = 1; inum < INODE_NUM; inum++) {
+        if (pending_atime[inum] == 0) {
+            continue;
+        }
+        int block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
+        if (block != current_block) {
+            if (current_block != -1) {
+                writeBlock(current_block, buf);
+            }
+            readBlock(block, buf);
+            current_block = block;
+        }
+        std::memcpy(buf + (inum * INODE_SIZE) % BLOCK_SIZE + offsetof(dinode, atime), &pending_atime[inum],
+                    sizeof(uint32_t));
+        pending_atime[inum] = 0;
+        written++;
+    }
+    if (current_block != -1) {
+        writeBlock(current_block, buf);
+    }
+    pending_atime_count = 0;
+    return written;
+}
+
 // 列出根目录内容
 void MiniFS::listRoot() 
 {
+    FSLock lock(fs_mutex);
     std::cout << "正在列出根目录内容..." << std::endl;
     
     try {
@@ -522,7 +1122,7 @@ void MiniFS::listRoot()
         std::memset(entries, 0, sizeof(entries)); // 清零缓冲区
         
         std::cout << "读取根目录数据块: " << rootInode.addrs[0] << std::endl;
-        readBlock(rootInode.addrs[0], entries);
+        _read_dir_block(rootInode, entries);
         
         // 安全检查目录项大小
         int entryCount = rootInode.size / sizeof(dirent);
@@ -547,6 +1147,7 @@ void MiniFS::listRoot()
 
 // 检查文件系统一致性
 int MiniFS::checkFSConsistency() {
+    FSLock lock(fs_mutex);
     std::cout << "开始检查文件系统一致性..." << std::endl;
     
     try {
@@ -634,6 +1235,13 @@ int MiniFS::checkFSConsistency() {
             return -1;
         }
         
+        // 校验全部元数据块和目录块的CRC32C
+        int csum_failures = verifyAllMetadata();
+        if (csum_failures > 0) {
+            std::cout << "元数据校验失败: " << csum_failures << " 个块的校验和不匹配" << std::endl;
+            return -1;
+        }
+        
         std::cout << "文件系统一致性检查通过!" << std::endl;
         return 0;
     }
@@ -646,6 +1254,7 @@ int MiniFS::checkFSConsistency() {
 //位图操作函数
 void MiniFS::set_bit(int bitmap_block_start, int index)
 {
+    FSLock lock(fs_mutex);
     int byte_index = index / 8;
     int bit_offset = index % 8;
     int block_offset = byte_index / BLOCK_SIZE;
@@ -659,6 +1268,7 @@ void MiniFS::set_bit(int bitmap_block_start, int index)
 
 void MiniFS::clear_bit(int bitmap_block_start, int index)
 {
+    FSLock lock(fs_mutex);
     int byte_index = index / 8;
     int bit_offset = index % 8;
     int block_offset = byte_index / BLOCK_SIZE;
@@ -672,6 +1282,7 @@ void MiniFS::clear_bit(int bitmap_block_start, int index)
 
 bool MiniFS::test_bit(int bitmap_block_start, int index)
 {
+    FSLock lock(fs_mutex);
     //index是inum，也可以是数据块号
     int byte_index = index / 8;
     int bit_offset = index % 8;
@@ -683,8 +1294,22 @@ bool MiniFS::test_bit(int bitmap_block_start, int index)
     return (buf[byte_in_block] & (1 << bit_offset)) != 0;
 }
 
+// 统计空闲数据块个数
+int MiniFS::countFreeBlocks()
+{
+    FSLock lock(fs_mutex);
+    int free_blocks = 0;
+    for (int i = 0; i < DATA_BLOCKS_NUM; i++) {
+        if (!test_bit(DATA_BITMAP_BLOCK_START, i)) {
+            free_blocks++;
+        }
+    }
+    return free_blocks;
+}
+
 int MiniFS::find_free_bit(int bitmap_block_start, int total_bits, int min_allowed_index)
 {
+    FSLock lock(fs_mutex);
     // total_bits 指的是: 此位图管理的总项目数 (例如: INODE_NUM 或 DATA_ZONE_NUM)
     // min_allowed_index: 允许返回的最小索引号 (例如，对于 inode 可能是 1，对于 data block 可能是 0)
 
@@ -731,36 +1356,213 @@ int MiniFS::find_free_bit(int bitmap_block_start, int total_bits, int min_allowe
 
 
 // 分配一个空闲的数据块,返回值是绝对数据块号
-int MiniFS::balloc()
+int MiniFS::balloc(bool zero)
 {
-    int free_block_index = find_free_bit(DATA_BITMAP_BLOCK_START, DATA_BLOCKS_NUM, 0);
-    if (free_block_index == -1) {
+    FSLock lock(fs_mutex);
+    std::vector<BlockSpan> spans;
+    if (balloc_n(1, 0, spans, zero) != 1) {
         std::cerr << "错误：没有空闲的数据块" << std::endl;
         return -1;
     }
-    
-    set_bit(DATA_BITMAP_BLOCK_START, free_block_index);
-    int absolute_block_num = DATA_START + free_block_index;
-    
-    // 清空新分配的数据块
-    Byte zero_buf[BLOCK_SIZE] = {0};
-    writeBlock(absolute_block_num, zero_buf);
-    
-    return absolute_block_num;
+    return spans[0].start;
 }
 
-// 释放一个数据块
-void MiniFS::bfree(int absolute_block_num)
+// 在位图中找 count 个空闲位并置1 (调用者持有 fs_mutex)
+// 位图块整体读入一次，按64位字跳过全满的区域，找到的连续空闲位作为一个区间整段用掩码置位，
+// 每个被修改的位图块只写回一次
+// goal 为位下标，从 goal 向后找，到末尾后从 min_index 绕回；返回实际置位的个数
+int MiniFS::_alloc_bit_runs(int bitmap_block_start, int bitmap_blocks, int total_bits, int min_index,
+                            int count, int goal, std::vector<BlockSpan>& out_runs)
 {
-    if (absolute_block_num < DATA_START || absolute_block_num >= BLOCK_COUNT) {
-        std::cerr << "错误：非法的数据块号 " << absolute_block_num << std::endl;
-        return;
+    const int words_per_block = BLOCK_SIZE / sizeof(uint64_t);
+    std::vector<uint64_t> words(bitmap_blocks * words_per_block);
+    for (int b = 0; b < bitmap_blocks; b++) {
+        readBlock(bitmap_block_start + b, &words[b * words_per_block]); // 位 i 位于字节 i/8 的第 i%8 位，小端序下即字 i/64 的第 i%64 位
     }
-    
-    int block_index = absolute_block_num - DATA_START;
+    std::vector<bool> dirty(bitmap_blocks, false);
+
+    if (goal < min_index || goal >= total_bits) {
+        goal = min_index;
+    }
+    int allocated = 0;
+    // 第一遍 [goal, total_bits)，第二遍 [min_index, goal)
+    for (int pass = 0; pass < 2 && allocated < count; pass++) {
+        int i = pass == 0 ? goal : min_index;
+        int limit = pass == 0 ? total_bits : goal;
+        while (i < limit && allocated < count) {
+            if (i % 64 == 0 && words[i / 64] == ~0ULL) {
+                i += 64; // 整个字都已占用
+                continue;
+            }
+            if (words[i / 64] & (1ULL << (i % 64))) {
+                i++;
+                continue;
+            }
+            // 找到空闲位，向后延伸成一段连续区间
+            int run_start = i;
+            while (i < limit && allocated < count && !(words[i / 64] & (1ULL << (i % 64)))) {
+                i++;
+                allocated++;
+            }
+            // 按字整段置位
+            for (int w = run_start / 64; w <= (i - 1) / 64; w++) {
+                int lo = std::max(run_start, w * 64) - w * 64;
+                int hi = std::min(i, w * 64 + 64) - w * 64;
+                uint64_t mask = (hi - lo == 64) ? ~0ULL : (((1ULL << (hi - lo)) - 1) << lo);
+                words[w] |= mask;
+                dirty[w / words_per_block] = true;
+            }
+            BlockSpan run = {run_start, i - run_start};
+            out_runs.push_back(run);
+        }
+    }
+
+    for (int b = 0; b < bitmap_blocks; b++) {
+        if (dirty[b]) {
+            writeBlock(bitmap_block_start + b, &words[b * words_per_block]);
+        }
+    }
+    return allocated;
+}
+
+// 批量分配数据块: 返回实际分配的块数 (磁盘空间不足时可能小于 count)
+int MiniFS::balloc_n(int count, int goal, std::vector<BlockSpan>& out_spans, bool zero)
+{
+    FSLock lock(fs_mutex);
+    if (count <= 0) {
+        return 0;
+    }
+    int goal_index = goal >= DATA_START ? goal - DATA_START : 0;
+    size_t first = out_spans.size();
+    int allocated = _alloc_bit_runs(DATA_BITMAP_BLOCK_START, DATA_BITMAP_BLOCK_COUNT, DATA_BLOCKS_NUM, 0,
+                                    count, goal_index, out_spans);
+
+    Byte zero_buf[BLOCK_SIZE] = {0};
+    for (size_t k = first; k < out_spans.size(); k++) {
+        out_spans[k].start += DATA_START; // 位下标转成绝对块号
+        // 清空新分配的数据块；文件数据块改为记录在i-节点的 unwritten 位图中，第一次写入时才落盘
+        for (int b = 0; zero && b < out_spans[k].count; b++) {
+            writeBlock(out_spans[k].start + b, zero_buf);
+        }
+    }
+    return allocated;
+}
+
+// 批量分配i-节点: 位图只读写一次，同一个i-节点块里的新i-节点一起初始化
+int MiniFS::ialloc_n(int count, int16_t type, std::vector<int>& out_inums)
+{
+    FSLock lock(fs_mutex);
+    if (count <= 0) {
+        return 0;
+    }
+    std::vector<BlockSpan> runs;
+    int allocated = _alloc_bit_runs(INODE_BITMAP_BLOCK_START, INODE_BITMAP_BLOCK_COUNT, INODE_NUM, 1,
+                                    count, 1, runs);
+
+    int current_block = -1;
+    Byte buf[BLOCK_SIZE];
+    for (const BlockSpan& run : runs) {
+        for (int inum = run.start; inum < run.start + run.count; inum++) {
+            int block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
+            if (block != current_block) {
+                if (current_block != -1) {
+                    writeBlock(current_block, buf);
+                }
+                readBlock(block, buf);
+                current_block = block;
+            }
+            dinode* inode = reinterpret_cast<dinode*>(buf + (inum * INODE_SIZE) % BLOCK_SIZE);
+            std::memset(inode, 0, sizeof(dinode));
+            inode->type = type;
+            _touch(*inode, TIME_ATIME | TIME_MTIME | TIME_CTIME);
+            _drop_pending_atime(inum); // 上一个使用者留下的
+            out_inums.push_back(inum);
+        }
+    }
+    if (current_block != -1) {
+        writeBlock(current_block, buf);
+    }
+    return allocated;
+}
+
+// 释放一个数据块
+void MiniFS::bfree(int absolute_block_num)
+{
+    FSLock lock(fs_mutex);
+    if (absolute_block_num < DATA_START || absolute_block_num >= BLOCK_COUNT) {
+        std::cerr << "错误：非法的数据块号 " << absolute_block_num << std::endl;
+        return;
+    }
+    
+    int block_index = absolute_block_num - DATA_START;
     clear_bit(DATA_BITMAP_BLOCK_START, block_index);
 }
 
+// 批量清除位图中的位 (调用者持有 fs_mutex): 排序后每个位图块读写一次
+void MiniFS::_free_bits(int bitmap_block_start, int bitmap_blocks, std::vector<int>& bits)
+{
+    std::sort(bits.begin(), bits.end());
+    const int bits_per_block = BLOCK_SIZE * 8;
+    Byte buf[BLOCK_SIZE];
+    int current = -1;
+    for (int bit : bits) {
+        int block = bit / bits_per_block;
+        if (block < 0 || block >= bitmap_blocks) {
+            continue;
+        }
+        if (block != current) {
+            if (current != -1) {
+                writeBlock(bitmap_block_start + current, buf);
+            }
+            readBlock(bitmap_block_start + block, buf);
+            current = block;
+        }
+        int in_block = bit % bits_per_block;
+        buf[in_block / 8] &= ~(1 << (in_block % 8));
+    }
+    if (current != -1) {
+        writeBlock(bitmap_block_start + current, buf);
+    }
+}
+
+// 批量释放数据块
+void MiniFS::bfree_n(std::vector<int>& blocks)
+{
+    FSLock lock(fs_mutex);
+    std::vector<int> bits;
+    bits.reserve(blocks.size());
+    for (int b : blocks) {
+        if (b < DATA_START || b >= BLOCK_COUNT) {
+            std::cerr << "错误：非法的数据块号 " << b << std::endl;
+            continue;
+        }
+        bits.push_back(b - DATA_START);
+    }
+    _free_bits(DATA_BITMAP_BLOCK_START, DATA_BITMAP_BLOCK_COUNT, bits);
+}
+
+// 批量释放i-节点: i-节点按块成批标记为空闲，再成批清除位图
+void MiniFS::ifree_n(std::vector<int>& inums)
+{
+    FSLock lock(fs_mutex);
+    std::vector<std::pair<int, dinode> > freed;
+    std::vector<int> bits;
+    for (int inum : inums) {
+        if (inum <= 0 || inum >= INODE_NUM) {
+            std::cerr << "错误：非法的i-节点号 " << inum << std::endl;
+            continue;
+        }
+        dinode node;
+        std::memset(&node, 0, sizeof(dinode));
+        node.type = T_FREE;
+        _drop_pending_atime(inum);
+        freed.push_back(std::make_pair(inum, node));
+        bits.push_back(inum);
+    }
+    _write_inodes(freed);
+    _free_bits(INODE_BITMAP_BLOCK_START, INODE_BITMAP_BLOCK_COUNT, bits);
+}
+
 /**
  * @brief 分配一个空闲的i-节点并初始化
  * 
@@ -786,34 +1588,20 @@ void MiniFS::bfree(int absolute_block_num)
 // 分配一个i-节点,给定类型，是普通文件还是目录，返回inum
 int MiniFS::ialloc(int16_t type)
 {
-    int free_inode_index = find_free_bit(INODE_BITMAP_BLOCK_START, INODE_NUM, 1);
-    if (free_inode_index == -1) {
+    FSLock lock(fs_mutex);
+    // 与批量分配共用同一套位图扫描和i-节点初始化
+    std::vector<int> inums;
+    if (ialloc_n(1, type, inums) != 1) {
         std::cerr << "错误：没有空闲的i-节点" << std::endl;
         return -1;
     }
-    
-    set_bit(INODE_BITMAP_BLOCK_START, free_inode_index);
-    
-    // 初始化新i-节点
-    int block = INODE_START + (free_inode_index * INODE_SIZE) / BLOCK_SIZE;
-    int offset = (free_inode_index * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte buf[BLOCK_SIZE];
-    readBlock(block, buf);
-    
-    //用指针操纵这块指定区域
-    dinode* inode = reinterpret_cast<dinode*>(buf + offset);
-    std::memset(inode, 0, sizeof(dinode));
-    inode->type = type;
-    
-    writeBlock(block, buf);
-    
-    return free_inode_index;
+    return inums[0];
 }
 
 // 释放一个i-节点
 void MiniFS::ifree(int inum)
 {
+    FSLock lock(fs_mutex);
     if (inum < 0 || inum >= INODE_NUM) {
         std::cerr << "错误：非法的i-节点号 " << inum << std::endl;
         return;
@@ -828,6 +1616,7 @@ void MiniFS::ifree(int inum)
     
     dinode* inode = reinterpret_cast<dinode*>(buf + offset);
     inode->type = T_FREE;
+    _drop_pending_atime(inum);
     
     writeBlock(block, buf);
     
@@ -846,6 +1635,7 @@ void MiniFS::ifree(int inum)
  */
 // 辅助函数：读取i-节点信息 (现在改为public)
 bool MiniFS::_get_inode(int inum, dinode& node_out) {
+    FSLock lock(fs_mutex);
     if (inum <= 0 || inum >= INODE_NUM) 
     { 
         // 0号i-节点通常不用，或作为NIL
@@ -871,9 +1661,99 @@ bool MiniFS::_get_inode(int inum, dinode& node_out) {
         // std::cerr << "调试: _get_inode i-节点 " << inum << " 是空闲的." << std::endl;
         return false; 
     }
+    if (pending_atime[inum] != 0) {
+        node_out.atime = pending_atime[inum];
+    }
+    return true;
+}
+
+// 辅助函数：把i-节点写回i-节点区 (读-改-写所在的块)
+void MiniFS::_write_inode(int inum, const dinode& node) {
+    FSLock lock(fs_mutex);
+    if (inum <= 0 || inum >= INODE_NUM) {
+        std::cerr << "错误: _write_inode 无效的 i-节点号 " << inum << std::endl;
+        return;
+    }
+    int block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
+    int offset = (inum * INODE_SIZE) % BLOCK_SIZE;
+
+    Byte buf[BLOCK_SIZE];
+    readBlock(block, buf);
+    std::memcpy(buf + offset, &node, sizeof(dinode));
+    if (pending_atime[inum] != 0) {
+        // 暂存的访问时间随这次写回一起落盘
+        std::memcpy(buf + offset + offsetof(dinode, atime), &pending_atime[inum], sizeof(uint32_t));
+        _drop_pending_atime(inum);
+    }
+    writeBlock(block, buf);
+}
+
+// 成批写回i-节点: 按i-节点号排序后同一块里的i-节点一起写，每块只读写一次
+void MiniFS::_write_inodes(std::vector<std::pair<int, dinode> >& nodes) {
+    FSLock lock(fs_mutex);
+    std::sort(nodes.begin(), nodes.end(),
+              [](const std::pair<int, dinode>& a, const std::pair<int, dinode>& b) { return a.first < b.first; });
+    Byte buf[BLOCK_SIZE];
+    int current_block = -1;
+    for (const std::pair<int, dinode>& entry : nodes) {
+        if (entry.first <= 0 || entry.first >= INODE_NUM) {
+            std::cerr << "错误: _write_inodes 无效的 i-节点号 " << entry.first << std::endl;
+            continue;
+        }
+        int block = INODE_START + (entry.first * INODE_SIZE) / BLOCK_SIZE;
+        if (block != current_block) {
+            if (current_block != -1) {
+                writeBlock(current_block, buf);
+            }
+            readBlock(block, buf);
+            current_block = block;
+        }
+        Byte* slot = buf + (entry.first * INODE_SIZE) % BLOCK_SIZE;
+        std::memcpy(slot, &entry.second, sizeof(dinode));
+        if (pending_atime[entry.first] != 0 && entry.second.type != T_FREE) {
+            std::memcpy(slot + offsetof(dinode, atime), &pending_atime[entry.first], sizeof(uint32_t));
+            _drop_pending_atime(entry.first);
+        }
+    }
+    if (current_block != -1) {
+        writeBlock(current_block, buf);
+    }
+}
+
+// 读取目录的数据块，首次读取时按目录i-节点中记录的校验和校验
+bool MiniFS::_read_dir_block(const dinode& dir, dirent* entries) {
+    FSLock lock(fs_mutex);
+    int block = dir.addrs[0];
+    if (block < DATA_START || block >= BLOCK_COUNT) {
+        std::memset(entries, 0, BLOCK_SIZE);
+        return false;
+    }
+    readBlock(block, entries);
+
+    if (meta_csum_enabled && !csum_verified[block]) {
+        csum_verified[block] = true;
+        csum_verified_count++;
+        uint32_t actual = crc32c(entries, BLOCK_SIZE);
+        if (actual != dir.dir_csum) {
+            csum_failure_count++;
+            std::cerr << "错误: 目录块 " << block << " 校验失败 (预期 0x" << std::hex << dir.dir_csum
+                      << ", 实际 0x" << actual << std::dec << ")" << std::endl;
+        }
+    }
     return true;
 }
 
+// 写目录的数据块，并把新的校验和记入 dir (调用者随后写回该i-节点)
+void MiniFS::_write_dir_block(dinode& dir, const dirent* entries) {
+    FSLock lock(fs_mutex);
+    writeBlock(dir.addrs[0], entries);
+    dir.dir_csum = crc32c(entries, BLOCK_SIZE);
+    _touch(dir, TIME_MTIME | TIME_CTIME); // 目录项有增删改
+    if (dir.addrs[0] >= 0 && dir.addrs[0] < BLOCK_COUNT) {
+        csum_verified[dir.addrs[0]] = true;
+    }
+}
+
 
 /**
  * @brief 在指定目录中查找指定名称的目录条目
@@ -888,6 +1768,7 @@ bool MiniFS::_get_inode(int inum, dinode& node_out) {
  * @note 名称比较是精确匹配，区分大小写
  */
 int MiniFS::_lookup_in_directory(int dir_inum, const std::string& name) {
+    FSLock lock(fs_mutex);
      //重点就是：遍历dir_node的目录条目，进行名称匹配：
      //   - 跳过无效条目（inum为0或INVALID_INUM_CONST）
      //   - 精确比较名称（区分大小写）
@@ -920,7 +1801,7 @@ int MiniFS::_lookup_in_directory(int dir_inum, const std::string& name) {
 
 
     Byte block_buf[BLOCK_SIZE];
-    readBlock(dir_node.addrs[0], block_buf);
+    _read_dir_block(dir_node, reinterpret_cast<dirent*>(block_buf));
 
     int num_entries_possible = BLOCK_SIZE / sizeof(dirent); // 一个块最多能放多少个
     int actual_entries = dir_node.size / sizeof(dirent); //实际放了多少个，检测下是否超出第一块
@@ -957,9 +1838,10 @@ int MiniFS::_lookup_in_directory(int dir_inum, const std::string& name) {
 // 将路径字符串解析到i-节点号
 //它接收一个字符串形式的路径(如 /home/user 或 docs/report.txt) 和  一个当前工作目录的 i-节点号(默认为根目录 1)
 //拿到最终访问该文件/文件夹的inum号
-int MiniFS::resolve_path_to_inum(const std::string& path, int base_inum) {
+int MiniFS::resolve_path_to_inum(const std::string& path, int base_inum, bool follow_last) {
+    FSLock lock(fs_mutex);
     std::string current_path_str = path;
-    std::vector<std::string> components;//分割路径每两个/之间的内容, 这是个栈，存segment
+    std::deque<std::string> components;//分割路径每两个/之间的内容, 遇到符号链接时把目标的组件插回队首
 
     // 1. 规范化路径：移除末尾的一个或者多个'/' (除非路径就是 "/")
     // /home/user/ → /home/user
@@ -1025,8 +1907,11 @@ int MiniFS::resolve_path_to_inum(const std::string& path, int base_inum) {
 
     // 4. 逐级解析
     dinode current_node_obj; // 临时变量，用于临时存储i节点信息
-    for (const std::string& comp : components) 
+    int links_followed = 0;
+    while (!components.empty()) 
     {
+        std::string comp = components.front();
+        components.pop_front();
         if (comp.empty()) continue; //防一下：是否有空格被入栈components里面了
         if (!_get_inode(current_inum, current_node_obj)) 
         {
@@ -1068,6 +1953,35 @@ int MiniFS::resolve_path_to_inum(const std::string& path, int base_inum) {
                 // std::cerr << "路径解析错误: 在目录 " << current_inum << " 中未找到 '" << comp << "'." << std::endl;
                 return INVALID_INUM_CONST; // Not found, return error
             }
+
+            // 符号链接: 中间组件总是跟随，最后一个组件由 follow_last 决定
+            dinode found_node;
+            if (_get_inode(found_inum, found_node) && found_node.type == T_SYMLINK &&
+                (follow_last || !components.empty()))
+            {
+                if (++links_followed > MAX_SYMLINK_FOLLOW) {
+                    std::cerr << "路径解析错误: 符号链接层数过多 (超过 " << MAX_SYMLINK_FOLLOW << " 层，可能存在循环)" << std::endl;
+                    return INVALID_INUM_CONST;
+                }
+                std::string target;
+                if (!_read_symlink(found_node, target)) {
+                    return INVALID_INUM_CONST;
+                }
+                // 目标的各组件放回队首继续解析；相对目标从链接所在目录开始，绝对目标从根目录开始
+                std::stringstream target_ss(target);
+                std::string target_segment;
+                std::vector<std::string> target_components;
+                while (std::getline(target_ss, target_segment, '/')) {
+                    if (!target_segment.empty()) {
+                        target_components.push_back(target_segment);
+                    }
+                }
+                components.insert(components.begin(), target_components.begin(), target_components.end());
+                if (target[0] == '/') {
+                    current_inum = ROOT_INUM_CONST;
+                }
+                continue;
+            }
             current_inum = found_inum;
         }
     }
@@ -1094,6 +2008,7 @@ int MiniFS::resolve_path_to_inum(const std::string& path, int base_inum) {
  */
 int MiniFS::create(int parent_dir_inum, const char* name)
 {    
+    FSLock lock(fs_mutex);
     // 检查文件名长度
     if (strlen(name) >= DIRSIZ) {
         std::cerr << "错误: 文件名称过长 (最大长度: " << DIRSIZ-1 << " 字符)" << std::endl;
@@ -1101,13 +2016,11 @@ int MiniFS::create(int parent_dir_inum, const char* name)
     }
 
     // 1. 读取父目录i-节点
-    int parent_block = INODE_START + (parent_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int parent_offset = (parent_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte buf[BLOCK_SIZE];
-    readBlock(parent_block, buf);
     dinode parent_inode;
-    std::memcpy(&parent_inode, buf + parent_offset, sizeof(dinode));
+    if (!_get_inode(parent_dir_inum, parent_inode)) {
+        std::cerr << "错误: 无法读取父目录i-节点 " << parent_dir_inum << std::endl;
+        return INVALID_INUM_CONST;
+    }
     
     // 确认父节点是一个目录
     if (parent_inode.type != T_DIR) {
@@ -1118,7 +2031,7 @@ int MiniFS::create(int parent_dir_inum, const char* name)
     // 2. 检查同名冲突
     int entries_count = parent_inode.size / sizeof(dirent);
     dirent entries[BLOCK_SIZE / sizeof(dirent)];
-    readBlock(parent_inode.addrs[0], entries);  // 简化: 假设目录项都在第一个数据块
+    _read_dir_block(parent_inode, entries);  // 简化: 假设目录项都在第一个数据块
     
     for (int i = 0; i < entries_count; i++) {
         if (std::strcmp(entries[i].name, name) == 0) {
@@ -1126,6 +2039,10 @@ int MiniFS::create(int parent_dir_inum, const char* name)
             return INVALID_INUM_CONST;
         }
     }
+    if (entries_count >= static_cast<int>(BLOCK_SIZE / sizeof(dirent))) {
+        std::cerr << "错误: 父目录已满 (最多 " << BLOCK_SIZE / sizeof(dirent) << " 项)" << std::endl;
+        return INVALID_INUM_CONST;
+    }
     
     // 3. 分配新文件的i-节点
     int file_inum = ialloc(T_FILE);
@@ -1134,45 +2051,31 @@ int MiniFS::create(int parent_dir_inum, const char* name)
         return INVALID_INUM_CONST;
     }
     
-    // 4. 分配新文件的第一个数据块
-    int file_data_block = balloc();
-    if (file_data_block == -1) {
-        std::cerr << "错误: 无法分配数据块" << std::endl;
-        ifree(file_inum); // 释放之前分配的i-节点
-        return INVALID_INUM_CONST;
-    }
-    
-    // 5. 初始化新文件的i-节点
-    int file_block = INODE_START + (file_inum * INODE_SIZE) / BLOCK_SIZE;
-    int file_offset = (file_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    readBlock(file_block, buf);
-    dinode* file_inode = reinterpret_cast<dinode*>(buf + file_offset);
-    
-    file_inode->type = T_FILE;
-    file_inode->size = 0;  // 新创建的文件大小为0
-    file_inode->nlink = 1; // 只有父目录的一个链接
-    file_inode->addrs[0] = file_data_block;
-    writeBlock(file_block, buf);
-    
-    // 6. 初始化文件数据块（全为0）
-    // 实际上 balloc 已经做了数据块清零操作，这里可以不需要
-    // Byte zero_buf[BLOCK_SIZE] = {0};
-    // writeBlock(file_data_block, zero_buf);
+    // 4. 初始化新文件的i-节点
+    // 新文件以内联方式存放，不分配数据块，写入超过 INLINE_DATA_MAX 字节时才迁出
+    dinode file_inode;
+    std::memset(&file_inode, 0, sizeof(dinode));
+    file_inode.type = T_FILE;
+    file_inode.size = 0;  // 新创建的文件大小为0
+    file_inode.nlink = 1; // 只有父目录的一个链接
+    file_inode.flags = INODE_FLAG_INLINE;
+    _touch(file_inode, TIME_ATIME | TIME_MTIME | TIME_CTIME);
+    _write_inode(file_inum, file_inode);
     
     // 7. 在父目录中添加新文件条目
     dirent new_entry;
+    std::memset(&new_entry, 0, sizeof(dirent));
     new_entry.inum = file_inum;
+    new_entry.type = T_FILE;
     std::strcpy(new_entry.name, name);//名字赋值
     entries[entries_count] = new_entry; // 这行是必要的，添加新目录项
     
     // 8. 写回更新后的父目录数据
-    writeBlock(parent_inode.addrs[0], entries);
+    _write_dir_block(parent_inode, entries);
     
     // 9. 写回更新后的父目录i-节点（只更新大小，不增加链接数）
     parent_inode.size += sizeof(dirent);  // 增加父目录大小
-    std::memcpy(buf + parent_offset, &parent_inode, sizeof(dinode));
-    writeBlock(parent_block, buf);
+    _write_inode(parent_dir_inum, parent_inode);
     std::cout << "成功创建文件: " << name << " (inum: " << file_inum << ")" << std::endl;
     return file_inum;
 }
@@ -1186,6 +2089,7 @@ int MiniFS::create(int parent_dir_inum, const char* name)
 // 返回值: 成功返回文件描述符，失败返回-1
 int MiniFS::open(int parent_dir_inum, const char* name, int flags) 
 {
+    FSLock lock(fs_mutex);
     std::cout << "尝试打开文件: " << name << " (parent inum: " << parent_dir_inum << ")" << std::endl;
 
     // 检查文件名长度
@@ -1195,13 +2099,11 @@ int MiniFS::open(int parent_dir_inum, const char* name, int flags)
     }
 
     // 1. 读取父目录i-节点
-    int parent_block = INODE_START + (parent_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int parent_offset = (parent_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte buf[BLOCK_SIZE];
-    readBlock(parent_block, buf);
     dinode parent_inode;
-    std::memcpy(&parent_inode, buf + parent_offset, sizeof(dinode));
+    if (!_get_inode(parent_dir_inum, parent_inode)) {
+        std::cerr << "错误: 无法读取父目录i-节点 " << parent_dir_inum << std::endl;
+        return -1;
+    }
     
     // 确认父节点是一个目录
     if (parent_inode.type != T_DIR) {
@@ -1212,7 +2114,7 @@ int MiniFS::open(int parent_dir_inum, const char* name, int flags)
     // 2. 在父目录中查找文件
     int entries_count = parent_inode.size / sizeof(dirent);
     dirent entries[BLOCK_SIZE / sizeof(dirent)];
-    readBlock(parent_inode.addrs[0], entries);  // 简化: 假设目录项都在第一个数据块
+    _read_dir_block(parent_inode, entries);  // 简化: 假设目录项都在第一个数据块
     
     int file_inum = -1;
     for (int i = 0; i < entries_count; i++) {
@@ -1239,19 +2141,48 @@ int MiniFS::open(int parent_dir_inum, const char* name, int flags)
     }
     
     // 4. 检查文件类型
-    int file_block = INODE_START + (file_inum * INODE_SIZE) / BLOCK_SIZE;
-    int file_offset = (file_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    readBlock(file_block, buf);
     dinode file_inode;
-    std::memcpy(&file_inode, buf + file_offset, sizeof(dinode));
+    if (!_get_inode(file_inum, file_inode)) {
+        std::cerr << "错误: 无法读取文件i-节点 " << file_inum << std::endl;
+        return -1;
+    }
+    
+    // 符号链接: 按链接目标打开 (相对目标从链接所在目录开始解析)
+    if (file_inode.type == T_SYMLINK) {
+        std::string target;
+        if (!_read_symlink(file_inode, target)) {
+            return -1;
+        }
+        file_inum = resolve_path_to_inum(target, parent_dir_inum);
+        if (file_inum == INVALID_INUM_CONST || !_get_inode(file_inum, file_inode)) {
+            std::cerr << "错误: 符号链接 '" << name << "' 的目标 '" << target << "' 不存在" << std::endl;
+            return -1;
+        }
+    }
     
+    // 5. 按i-节点打开
+    int fd = openInode(file_inum, flags);
+    if (fd >= 0) {
+        std::cout << "成功打开文件: " << name << " (fd: " << fd << ", inum: " << file_inum << ")" << std::endl;
+    }
+    return fd;
+}
+
+// 按i-节点号打开普通文件 (不经过路径解析，也不跟随符号链接)，返回文件描述符，失败返回-1
+int MiniFS::openInode(int inum, int flags)
+{
+    FSLock lock(fs_mutex);
+    dinode file_inode;
+    if (!_get_inode(inum, file_inode)) {
+        std::cerr << "错误: 无法读取文件i-节点 " << inum << std::endl;
+        return -1;
+    }
     if (file_inode.type != T_FILE) {
         std::cerr << "错误: 不是一个文件类型 (type = " << file_inode.type << ")" << std::endl;
         return -1;
     }
     
-    // 5. 分配文件描述符
+    // 分配文件描述符
     int fd = -1;
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         if (!fd_table[i].is_used) {
@@ -1265,13 +2196,21 @@ int MiniFS::open(int parent_dir_inum, const char* name, int flags)
         return -1;
     }
     
-    // 6. 设置文件描述符
-    fd_table[fd].inum = file_inum;
-    fd_table[fd].mode = flags & (O_RDONLY | O_WRONLY | O_RDWR); // 仅保留读写模式位，这里顺带保存了O_CREATE位
+    // O_TRUNC 只对可写的打开方式生效 (O_RDONLY 为 0x1 也落在 O_RDWR 中，只能看写位 O_WRONLY)
+    if ((flags & O_TRUNC) && (flags & O_WRONLY) && file_inode.size > 0) {
+        if (truncate(inum, 0) != 0) {
+            return -1;
+        }
+    }
+    
+    // 设置文件描述符
+    fd_table[fd].inum = inum;
+    fd_table[fd].mode = flags & (O_RDONLY | O_WRONLY | O_RDWR | O_APPEND); // 保留读写模式位与 O_APPEND
     fd_table[fd].position = 0; // 从文件开始处读写
     fd_table[fd].is_used = true;
-    
-    std::cout << "成功打开文件: " << name << " (fd: " << fd << ", inum: " << file_inum << ")" << std::endl;
+    fd_table[fd].ra_next = 0;  // 从文件开头读视为顺序读
+    fd_table[fd].ra_window = 0;
+    fd_table[fd].ra_len = 0;
     return fd;
 }
 
@@ -1280,6 +2219,7 @@ int MiniFS::open(int parent_dir_inum, const char* name, int flags)
 // 返回值: 成功返回0，失败返回-1
 int MiniFS::close(int fd)
 {
+    FSLock lock(fs_mutex);
     // 检查文件描述符是否有效
     if (fd < 0 || fd >= MAX_OPEN_FILES) {
         std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
@@ -1295,6 +2235,15 @@ int MiniFS::close(int fd)
     // 关闭文件（标记为未使用）
     fd_table[fd].is_used = false;
     std::cout << "成功关闭文件描述符 " << fd << std::endl;
+
+    // 文件已被删除 (链接数为0)，最后一个打开者关闭时释放
+    int inum = fd_table[fd].inum;
+    dinode node;
+    if (_get_inode(inum, node) && node.nlink <= 0 && _open_refs(inum) == 0) {
+        _release_inode(inum, node);
+        _adjust_orphan_count(-1);
+        std::cout << "已释放被删除文件的 i-节点 " << inum << std::endl;
+    }
     
     return 0;
 }
@@ -1307,6 +2256,7 @@ int MiniFS::close(int fd)
 //拿到文件描述符，得到关联节点inum，就有了inum->address
 int MiniFS::read(int fd, void* buf, int count)
 {
+    FSLock lock(fs_mutex);
     // 检查文件描述符是否有效
     if (fd < 0 || fd >= MAX_OPEN_FILES) {
         std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
@@ -1325,150 +2275,537 @@ int MiniFS::read(int fd, void* buf, int count)
         return -1;
     }
     
-    // 获取关联的i-节点
-    int inum = fd_table[fd].inum;
-    int inode_block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
-    int inode_offset = (inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte block_buf[BLOCK_SIZE];
-    readBlock(inode_block, block_buf);
-    dinode file_inode;
-    std::memcpy(&file_inode, block_buf + inode_offset, sizeof(dinode));
-    
-    // 检查文件大小
-    int file_size = file_inode.size;
-    
     // 修改：始终从文件开头读取，但仍保留文件位置用于写操作
-    // 原来是：int bytes_available = file_size - fd_table[fd].position;
-    // 修改为总是从文件开头读取指定数量的字节
-    int bytes_available = file_size; // 从文件开头读取
+    // 需要从其它位置读取时使用 pread
+    int bytes_read = _read_with_readahead(fd, static_cast<char*>(buf), 0, count);
+    if (bytes_read < 0) {
+        return -1;
+    }
+    if (count > 0) {
+        _touch_atime(fd_table[fd].inum);
+    }
     
-    if (bytes_available <= 0) 
-    {
-        // 文件为空
+    // 修改：不更新文件位置，position仅用于写入操作
+    // fd_table[fd].position += bytes_read;
+    
+    std::cout << "成功从文件描述符 " << fd << " 读取 " << bytes_read << " 字节" << std::endl;
+    //返回读取的字节数
+    return bytes_read;
+}
+
+// 从文件的 offset 处读取最多 count 字节到 dst (调用者持有 fs_mutex)
+// 空洞读出为0；开启了数据校验的文件核对每个读到的数据块
+// 返回值: 读取的字节数，数据校验失败返回-1
+int MiniFS::_readi(int inum, const dinode& node, char* dst, int offset, int count)
+{
+    if (offset < 0 || offset >= node.size || count <= 0) {
         return 0;
     }
-    
-    // 确定要读取的字节数
-    int bytes_to_read = std::min(bytes_available, count);
+    int bytes_to_read = std::min(node.size - offset, count);
+
+    // 内联文件: 数据就在i-节点里，不需要读数据块
+    if (node.flags & INODE_FLAG_INLINE) {
+        std::memcpy(dst, reinterpret_cast<const char*>(node.addrs) + offset, bytes_to_read);
+        return bytes_to_read;
+    }
+
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    if (node.csum_block != 0) {
+        readBlock(node.csum_block, csums);
+    }
+
     int bytes_read = 0;
-    
-    // 读取数据,用字符指针逐个读取
-    char* dest_buf = static_cast<char*>(buf);
-    
-    // 修改：总是从文件开头读取，不使用文件位置
-    // int curr_pos = fd_table[fd].position;
-    int curr_pos = 0; // 从文件开头开始
-    
+    int curr_pos = offset;
     while (bytes_to_read > 0) {
-        // 计算当前位置对应的数据块索引和偏移量
         int block_index = curr_pos / BLOCK_SIZE;
         int block_offset = curr_pos % BLOCK_SIZE;
-        
-        // 确保数据块索引合法
         if (block_index >= 8) {
             std::cerr << "错误: 文件读取超出支持的最大文件大小" << std::endl;
             break;
         }
-        
-        // 获取数据块
-        int data_block_num = file_inode.addrs[block_index];
-        if (data_block_num == 0) {
-            // 没有分配的数据块，可能是文件有空洞
-            break;
-        }
-        
-        // 读取数据块
-        Byte data_buf[BLOCK_SIZE];
-        readBlock(data_block_num, data_buf);
-        
-        // 计算在当前块中可以读取的字节数
         int block_bytes = std::min(bytes_to_read, BLOCK_SIZE - block_offset);
-        
-        // 复制数据
-        std::memcpy(dest_buf + bytes_read, data_buf + block_offset, block_bytes);
-        
-        // 更新计数和位置
+
+        int data_block_num = node.addrs[block_index];
+        if (data_block_num == 0 || (node.unwritten & (1u << block_index))) {
+            // 空洞或已分配但未写入的块: 不读盘，直接填0
+            std::memset(dst + bytes_read, 0, block_bytes);
+        } else {
+            Byte data_buf[BLOCK_SIZE];
+            readBlock(data_block_num, data_buf);
+            if (node.csum_block != 0 && crc32c(data_buf, BLOCK_SIZE) != csums[block_index]) {
+                data_csum_failure_count++;
+                std::cerr << "错误: 文件 (inum " << inum << ") 第 " << block_index << " 块 (块号 "
+                          << data_block_num << ") 数据校验失败" << std::endl;
+                return -1;
+            }
+            std::memcpy(dst + bytes_read, data_buf + block_offset, block_bytes);
+        }
+
         bytes_read += block_bytes;
         bytes_to_read -= block_bytes;
         curr_pos += block_bytes;
     }
-    
-    // 修改：不更新文件位置，position仅用于写入操作
-    // fd_table[fd].position += bytes_read;
-    
-    std::cout << "成功从文件描述符 " << fd << " 读取 " << bytes_read << " 字节" << std::endl;
-    //返回读取的字节数
     return bytes_read;
 }
 
-// 写入文件函数
-// fd: 文件描述符
-// buf: 要写入的数据
-// count: 要写入的字节数
-// 返回值: 成功返回实际写入的字节数，失败返回-1
-int MiniFS::write(int fd, const void* buf, int count)
+// 从预读缓冲区读取，未命中返回 -1 (缓冲区读到了文件末尾时，越过末尾的部分按短读处理)
+int MiniFS::_read_from_readahead(file_descriptor& f, char* dst, int offset, int count)
 {
-    // 检查文件描述符是否有效
-    if (fd < 0 || fd >= MAX_OPEN_FILES) {
-        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+    if (f.ra_len <= 0 || f.ra_epoch != io_meta_writes + io_data_writes || offset < f.ra_start) {
         return -1;
     }
-    
-    // 检查文件描述符是否在使用中
-    if (!fd_table[fd].is_used) {
-        std::cerr << "错误: 文件描述符 " << fd << " 未使用" << std::endl;
+    int end = f.ra_start + f.ra_len;
+    if (offset + count > end && !(f.ra_eof && offset <= end)) {
         return -1;
     }
-    
-    // 检查是否有写权限
-    if (!(fd_table[fd].mode & (O_WRONLY | O_RDWR))) {
-        std::cerr << "错误: 文件描述符 " << fd << " 没有写权限" << std::endl;
-        return -1;
+    int n = std::min(count, end - offset);
+    std::memcpy(dst, &f.ra_buf[offset - f.ra_start], n);
+    f.ra_next = offset + n;
+    io_readahead_hits++;
+    return n;
+}
+
+// 带预读的读取 (调用者持有 fs_mutex，并已检查文件描述符与读权限)
+// 从上次读取的结束位置继续读视为顺序读: 每次顺序读未命中时窗口翻倍 (READAHEAD_MIN_BLOCKS 到
+// READAHEAD_MAX_BLOCKS)，一次读入并校验窗口内的全部块 (校验和边车块也只读一次)，
+// 之后落在窗口内的读取直接从缓冲区复制；随机读关闭预读并清空窗口
+int MiniFS::_read_with_readahead(int fd, char* dst, int offset, int count)
+{
+    file_descriptor& f = fd_table[fd];
+    if (offset < 0 || count <= 0) {
+        return 0;
     }
-    
-    // 获取关联的i-节点,拿到inum，下一步定位当前数据块和块偏移
-    int inum = fd_table[fd].inum;
-    int inode_block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
-    int inode_offset = (inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte block_buf[BLOCK_SIZE];
-    readBlock(inode_block, block_buf);
-    dinode file_inode;
-    std::memcpy(&file_inode, block_buf + inode_offset, sizeof(dinode));
-    
-    // 如果要写入的数据超出文件大小，可能需要扩展文件
-    int target_size = fd_table[fd].position + count;
-    int needed_blocks = (target_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    
-    if (needed_blocks > 8) {
-        std::cerr << "错误: 所需的块数 " << needed_blocks << " 超出了支持的最大值 8" << std::endl;
-        // 只写入能够容纳的数据
-        needed_blocks = 8;
-        count = needed_blocks * BLOCK_SIZE - fd_table[fd].position;
+    long epoch = io_meta_writes + io_data_writes;
+
+    // 1. 命中预读缓冲区
+    int hit = _read_from_readahead(f, dst, offset, count);
+    if (hit >= 0) {
+        return hit;
     }
-    
-    // 分配必要的数据块
-    int current_blocks = (file_inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    for (int i = current_blocks; i < needed_blocks; i++) {
-        int new_block = balloc();
-        if (new_block == -1) {
+
+    dinode node;
+    if (!_get_inode(f.inum, node)) {
+        return -1;
+    }
+    f.ra_len = 0;
+    bool sequential = (offset == f.ra_next) && !(node.flags & INODE_FLAG_INLINE);
+    f.ra_window = !sequential ? 0
+                : (f.ra_window == 0 ? READAHEAD_MIN_BLOCKS : std::min(f.ra_window * 2, READAHEAD_MAX_BLOCKS));
+
+    // 2. 从 offset 所在块起读入整个窗口；窗口不比本次请求大时直接读
+    int fill_start = offset - offset % BLOCK_SIZE;
+    int fill_end = std::min(std::max(fill_start + f.ra_window * BLOCK_SIZE, offset + count), node.size);
+    if (!sequential || fill_end <= offset + count) {
+        int n = _readi(f.inum, node, dst, offset, count);
+        if (n >= 0) {
+            f.ra_next = offset + n;
+        }
+        return n;
+    }
+    f.ra_buf.resize(READAHEAD_MAX_BLOCKS * BLOCK_SIZE);
+    int got = _readi(f.inum, node, &f.ra_buf[0], fill_start, fill_end - fill_start);
+    if (got < 0) {
+        return -1;
+    }
+    io_readahead_fills++;
+    f.ra_start = fill_start;
+    f.ra_len = got;
+    f.ra_eof = (fill_start + got >= node.size);
+    f.ra_epoch = epoch;
+
+    int n = std::min(count, fill_start + got - offset);
+    std::memcpy(dst, &f.ra_buf[offset - fill_start], n);
+    f.ra_next = offset + n;
+    return n;
+}
+
+// 把内联文件的数据迁出到数据块 (调用者持有 fs_mutex 并负责写回i-节点)
+// 空文件不分配数据块，只清除内联标志
+bool MiniFS::_spill_inline(dinode& node)
+{
+    Byte data_buf[BLOCK_SIZE];
+    std::memset(data_buf, 0, sizeof(data_buf));
+    std::memcpy(data_buf, node.addrs, std::min(node.size, INLINE_DATA_MAX));
+
+    int block = 0;
+    if (node.size > 0) {
+        block = balloc(false); // 随后整块写入，不必先清零
+        if (block == -1) {
+            std::cerr << "错误: 无法分配数据块，内联数据迁出失败" << std::endl;
+            return false;
+        }
+        writeBlock(block, data_buf);
+        if (node.csum_block != 0) {
+            uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+            readBlock(node.csum_block, csums);
+            csums[0] = crc32c(data_buf, BLOCK_SIZE);
+            writeBlock(node.csum_block, csums);
+        }
+    }
+    std::memset(node.addrs, 0, sizeof(node.addrs));
+    node.addrs[0] = block;
+    node.unwritten = 0;
+    node.flags &= ~INODE_FLAG_INLINE;
+    return true;
+}
+
+// 从指定偏移读取，不改变文件位置
+// 返回值: 成功返回读取的字节数 (到达文件末尾时为0)，失败返回-1
+int MiniFS::pread(int fd, void* buf, int count, int offset)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    if (!(fd_table[fd].mode & (O_RDONLY | O_RDWR))) {
+        std::cerr << "错误: 文件描述符 " << fd << " 没有读权限" << std::endl;
+        return -1;
+    }
+    int n = _read_with_readahead(fd, static_cast<char*>(buf), offset, count);
+    if (n >= 0 && count > 0) {
+        _touch_atime(fd_table[fd].inum);
+    }
+    return n;
+}
+
+// 只读预读缓冲区中已有的数据: 不读块，锁被占用时也不等待
+// 命中时 result 为读到的字节数并返回 true；否则返回 false，调用者改用 pread (可能需要读块)
+bool MiniFS::tryReadCached(int fd, void* buf, int count, int offset, int& result)
+{
+    std::unique_lock<std::recursive_mutex> lock(fs_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used ||
+        !(fd_table[fd].mode & (O_RDONLY | O_RDWR)) || offset < 0 || count <= 0) {
+        return false;
+    }
+    int n = _read_from_readahead(fd_table[fd], static_cast<char*>(buf), offset, count);
+    if (n < 0) {
+        return false;
+    }
+    // 填充预读缓冲区的那次读取已经把属性读进缓存，这里只改内存
+    _touch_atime(fd_table[fd].inum);
+    result = n;
+    return true;
+}
+
+// 在指定偏移写入，不改变文件位置 (O_APPEND 打开时仍写到文件末尾)
+int MiniFS::pwrite(int fd, const void* buf, int count, int offset)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    // 先比较再相加: 远程客户端传来的 offset 可能接近 INT_MAX，offset + count 会溢出
+    if (offset < 0 || count < 0 || offset > 8 * BLOCK_SIZE - count) {
+        std::cerr << "错误: 无效的写入范围 offset=" << offset << " count=" << count << std::endl;
+        return -1;
+    }
+    int saved_position = fd_table[fd].position;
+    fd_table[fd].position = offset;
+    int written = write(fd, buf, count);
+    fd_table[fd].position = saved_position;
+    return written;
+}
+
+// 设置文件位置
+// LSEEK_DATA/LSEEK_HOLE 按块粒度查找，offset 不小于文件大小时失败 (对应 ENXIO)
+// 返回值: 成功返回新的文件位置，失败返回-1
+int MiniFS::lseek(int fd, int offset, int whence)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    dinode node;
+    if (!_get_inode(fd_table[fd].inum, node)) {
+        return -1;
+    }
+
+    int new_pos = -1;
+    switch (whence) {
+    case LSEEK_SET:
+        new_pos = offset;
+        break;
+    case LSEEK_CUR:
+        new_pos = fd_table[fd].position + offset;
+        break;
+    case LSEEK_END:
+        new_pos = node.size + offset;
+        break;
+    case LSEEK_DATA:
+    case LSEEK_HOLE:
+        if (offset < 0 || offset >= node.size) {
+            return -1;
+        }
+        new_pos = node.size; // 找不到数据时失败，找不到空洞时为文件末尾的隐式空洞
+        if (node.flags & INODE_FLAG_INLINE) {
+            new_pos = whence == LSEEK_DATA ? offset : node.size; // 内联文件没有空洞
+            break;
+        }
+        for (int i = offset / BLOCK_SIZE; i * BLOCK_SIZE < node.size; i++) {
+            bool is_data = node.addrs[i] != 0;
+            if (is_data == (whence == LSEEK_DATA)) {
+                new_pos = std::max(offset, i * BLOCK_SIZE);
+                break;
+            }
+        }
+        if (whence == LSEEK_DATA && new_pos == node.size) {
+            return -1;
+        }
+        break;
+    default:
+        std::cerr << "错误: 无效的 whence " << whence << std::endl;
+        return -1;
+    }
+
+    if (new_pos < 0 || new_pos > 8 * BLOCK_SIZE) {
+        std::cerr << "错误: 文件位置 " << new_pos << " 超出范围" << std::endl;
+        return -1;
+    }
+    fd_table[fd].position = new_pos;
+    return new_pos;
+}
+
+// 预分配或打洞
+// mode 为0或 FALLOC_KEEP_SIZE 时为 [offset, offset+length) 内的空洞分配清零的数据块；
+// FALLOC_PUNCH_HOLE 释放范围内的整块，首尾部分覆盖的块只清零对应部分
+// 返回值: 成功返回0，失败返回-1
+int MiniFS::fallocate(int fd, int mode, int offset, int length)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    if (!(fd_table[fd].mode & O_WRONLY)) { // O_WRONLY 与 O_RDWR 都含写位
+        std::cerr << "错误: 文件描述符 " << fd << " 没有写权限" << std::endl;
+        return -1;
+    }
+    if (offset < 0 || length <= 0 || offset > 8 * BLOCK_SIZE || length > 8 * BLOCK_SIZE - offset) {
+        std::cerr << "错误: fallocate 范围无效 (offset " << offset << ", length " << length << ")" << std::endl;
+        return -1;
+    }
+
+    int inum = fd_table[fd].inum;
+    dinode node;
+    if (!_get_inode(inum, node)) {
+        return -1;
+    }
+    int end = offset + length;
+
+    // 内联文件: 打洞只需把内联区对应部分清零；预分配范围仍在内联区内时无需分配，否则先迁出
+    if (node.flags & INODE_FLAG_INLINE) {
+        if (mode & FALLOC_PUNCH_HOLE) {
+            if (offset < node.size) {
+                std::memset(reinterpret_cast<char*>(node.addrs) + offset, 0, std::min(end, node.size) - offset);
+                _touch(node, TIME_MTIME | TIME_CTIME);
+                _write_inode(inum, node);
+            }
+            return 0;
+        }
+        if (end <= INLINE_DATA_MAX) {
+            if (!(mode & FALLOC_KEEP_SIZE) && end > node.size) {
+                node.size = end;
+                _touch(node, TIME_MTIME | TIME_CTIME);
+                _write_inode(inum, node);
+            }
+            return 0;
+        }
+        if (!_spill_inline(node)) {
+            return -1;
+        }
+    }
+
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    if (node.csum_block != 0) {
+        readBlock(node.csum_block, csums);
+    }
+
+    int first_block = offset / BLOCK_SIZE;
+    int last_block = (end - 1) / BLOCK_SIZE;
+
+    // 预分配: 先数出空洞，一次批量分配
+    std::vector<int> new_blocks;
+    if (!(mode & FALLOC_PUNCH_HOLE)) {
+        int holes = 0;
+        for (int i = first_block; i <= last_block; i++) {
+            holes += node.addrs[i] == 0 ? 1 : 0;
+        }
+        std::vector<BlockSpan> spans;
+        balloc_n(holes, 0, spans, false);
+        for (const BlockSpan& span : spans) {
+            for (int b = 0; b < span.count; b++) {
+                new_blocks.push_back(span.start + b);
+            }
+        }
+    }
+    size_t next_new = 0;
+
+    for (int i = first_block; i <= last_block; i++) {
+        int block_start = i * BLOCK_SIZE;
+        int from = std::max(offset, block_start) - block_start;
+        int to = std::min(end, block_start + BLOCK_SIZE) - block_start;
+
+        if (mode & FALLOC_PUNCH_HOLE) {
+            if (node.addrs[i] == 0) {
+                continue;
+            }
+            if (from == 0 && to == BLOCK_SIZE) {
+                bfree(node.addrs[i]);
+                node.addrs[i] = 0;
+                node.unwritten &= ~(1u << i);
+                csums[i] = 0;
+            } else if (!(node.unwritten & (1u << i))) { // 未写入的块本来就读出为0
+                Byte data_buf[BLOCK_SIZE];
+                readBlock(node.addrs[i], data_buf);
+                std::memset(data_buf + from, 0, to - from);
+                writeBlock(node.addrs[i], data_buf);
+                csums[i] = crc32c(data_buf, BLOCK_SIZE);
+            }
+        } else if (node.addrs[i] == 0) {
+            // 预分配只占位不清零，标记为未写入
+            if (next_new >= new_blocks.size()) {
+                std::cerr << "错误: 无法分配数据块，磁盘空间不足" << std::endl;
+                break; // 已分配的块保留，写回i-节点
+            }
+            node.addrs[i] = new_blocks[next_new++];
+            node.unwritten |= (1u << i);
+            csums[i] = 0;
+        }
+    }
+
+    if (!(mode & (FALLOC_KEEP_SIZE | FALLOC_PUNCH_HOLE)) && end > node.size) {
+        node.size = end;
+    }
+    if (node.csum_block != 0) {
+        writeBlock(node.csum_block, csums);
+    }
+    _touch(node, TIME_MTIME | TIME_CTIME);
+    _write_inode(inum, node);
+    return 0;
+}
+
+// 写入文件函数
+// fd: 文件描述符
+// buf: 要写入的数据
+// count: 要写入的字节数
+// 返回值: 成功返回实际写入的字节数，失败返回-1
+int MiniFS::write(int fd, const void* buf, int count)
+{
+    FSLock lock(fs_mutex);
+    // 检查文件描述符是否有效
+    if (fd < 0 || fd >= MAX_OPEN_FILES) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    
+    // 检查文件描述符是否在使用中
+    if (!fd_table[fd].is_used) {
+        std::cerr << "错误: 文件描述符 " << fd << " 未使用" << std::endl;
+        return -1;
+    }
+    
+    // 检查是否有写权限
+    if (!(fd_table[fd].mode & (O_WRONLY | O_RDWR))) {
+        std::cerr << "错误: 文件描述符 " << fd << " 没有写权限" << std::endl;
+        return -1;
+    }
+    
+    if (count < 0 || fd_table[fd].position < 0 || fd_table[fd].position > 8 * BLOCK_SIZE) {
+        std::cerr << "错误: 无效的写入位置 " << fd_table[fd].position << " 或长度 " << count << std::endl;
+        return -1;
+    }
+
+    // 获取关联的i-节点,拿到inum，下一步定位当前数据块和块偏移
+    int inum = fd_table[fd].inum;
+    int inode_block = INODE_START + (inum * INODE_SIZE) / BLOCK_SIZE;
+    int inode_offset = (inum * INODE_SIZE) % BLOCK_SIZE;
+    
+    Byte block_buf[BLOCK_SIZE];
+    readBlock(inode_block, block_buf);
+    dinode file_inode;
+    std::memcpy(&file_inode, block_buf + inode_offset, sizeof(dinode));
+
+    // O_APPEND: 在持有文件系统锁的情况下取文件末尾，多个追加者不会互相覆盖
+    if (fd_table[fd].mode & O_APPEND) {
+        fd_table[fd].position = file_inode.size;
+    }
+
+    // 内联文件: 写完仍不超过 INLINE_DATA_MAX 时只改i-节点，否则先迁出到数据块
+    if (file_inode.flags & INODE_FLAG_INLINE) {
+        // position 已限定在 [0, 8*BLOCK_SIZE]，用减法比较避免 position + count 溢出
+        if (fd_table[fd].position <= INLINE_DATA_MAX && count <= INLINE_DATA_MAX - fd_table[fd].position) {
+            int end = fd_table[fd].position + count;
+            std::memcpy(reinterpret_cast<char*>(file_inode.addrs) + fd_table[fd].position, buf, count);
+            fd_table[fd].position = end;
+            file_inode.size = std::max(file_inode.size, end);
+            _touch(file_inode, TIME_MTIME | TIME_CTIME);
+            _write_inode(inum, file_inode);
+            std::cout << "成功向文件描述符 " << fd << " 写入 " << count << " 字节 (内联)" << std::endl;
+            return count;
+        }
+        if (!_spill_inline(file_inode)) {
+            return -1;
+        }
+    }
+    
+    // 如果要写入的数据超出文件大小，可能需要扩展文件
+    // 超出 8 个块时只写入能够容纳的数据 (先截断 count，再计算 target_size，避免溢出)
+    if (count > 8 * BLOCK_SIZE - fd_table[fd].position) {
+        std::cerr << "错误: 写入范围超出了支持的最大值 8 个块" << std::endl;
+        count = 8 * BLOCK_SIZE - fd_table[fd].position;
+    }
+    int target_size = fd_table[fd].position + count;
+    int needed_blocks = (target_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    
+    // 分配必要的数据块 (只为尚未分配的位置分配；已有的块和截断后保留的块直接复用)
+    // 缺少的块一次批量分配，目标紧跟在前一个已分配块之后，尽量连续
+    int first_index = fd_table[fd].position / BLOCK_SIZE;
+    std::vector<int> missing;
+    for (int i = first_index; i < needed_blocks; i++) {
+        if (file_inode.addrs[i] == 0) {
+            missing.push_back(i);
+        }
+    }
+    if (!missing.empty()) {
+        int goal = 0;
+        for (int i = missing[0] - 1; i >= 0 && goal == 0; i--) {
+            goal = file_inode.addrs[i] != 0 ? file_inode.addrs[i] + 1 : 0;
+        }
+        std::vector<BlockSpan> spans;
+        int allocated = balloc_n(static_cast<int>(missing.size()), goal, spans, false); // 不清零，下面写入时按未写入块处理
+        size_t k = 0;
+        for (const BlockSpan& span : spans) {
+            for (int b = 0; b < span.count; b++, k++) {
+                file_inode.addrs[missing[k]] = span.start + b;
+                file_inode.unwritten |= (1u << missing[k]);
+            }
+        }
+        if (allocated < static_cast<int>(missing.size())) {
             std::cerr << "错误: 无法分配数据块，磁盘空间不足" << std::endl;
-            // 只写入已分配的块
-            needed_blocks = i;
-            count = (i * BLOCK_SIZE) - fd_table[fd].position;
+            // 只写入到第一个没有分配到的块之前
+            needed_blocks = missing[allocated];
+            count = (needed_blocks * BLOCK_SIZE) - fd_table[fd].position;
             if (count <= 0) {
+                std::memcpy(block_buf + inode_offset, &file_inode, sizeof(dinode));
+                writeBlock(inode_block, block_buf);
                 return 0; // 无法写入任何数据
             }
-            break;
         }
-        file_inode.addrs[i] = new_block;
     }
     
     // 开始写入数据
     int bytes_written = 0;
     int curr_pos = fd_table[fd].position;
     const char* src_buf = static_cast<const char*>(buf);
+
+    // 开启了数据校验的文件: 写每个块时顺带算出新的CRC32C，最后一次性写回边车块
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    if (file_inode.csum_block != 0) {
+        readBlock(file_inode.csum_block, csums);
+    }
     
     while (bytes_written < count) {
         // 计算当前位置对应的数据块索引和偏移量
@@ -1478,33 +2815,49 @@ int MiniFS::write(int fd, const void* buf, int count)
         // 获取数据块
         int data_block_num = file_inode.addrs[block_index];
         
-        // 读取当前块内容
-        Byte data_buf[BLOCK_SIZE];
-        readBlock(data_block_num, data_buf);
-        
         // 计算在当前块中可以写入的字节数
         int block_bytes = std::min(count - bytes_written, BLOCK_SIZE - block_offset);
         
+        // 读取当前块内容: 整块覆盖时不需要旧内容；未写入的块旧内容视为全0，不读盘
+        Byte data_buf[BLOCK_SIZE];
+        uint8_t block_bit = static_cast<uint8_t>(1u << block_index);
+        if (file_inode.unwritten & block_bit) {
+            if (block_bytes < BLOCK_SIZE) {
+                std::memset(data_buf, 0, BLOCK_SIZE);
+            }
+            file_inode.unwritten &= ~block_bit;
+        } else if (block_bytes < BLOCK_SIZE) {
+            readBlock(data_block_num, data_buf);
+        }
+        
         // 复制数据
         std::memcpy(data_buf + block_offset, src_buf + bytes_written, block_bytes);
         
         // 写回数据块
         writeBlock(data_block_num, data_buf);
+        if (file_inode.csum_block != 0) {
+            csums[block_index] = crc32c(data_buf, BLOCK_SIZE);
+        }
         
         // 更新计数和位置
         bytes_written += block_bytes;
         curr_pos += block_bytes;
     }
     
+    if (file_inode.csum_block != 0) {
+        writeBlock(file_inode.csum_block, csums);
+    }
+
     // 更新文件位置
     fd_table[fd].position += bytes_written;
     
     // 更新文件大小
-    if (target_size > file_inode.size) {
-        file_inode.size = target_size;
+    if (curr_pos > file_inode.size) {
+        file_inode.size = curr_pos;
     }
     
     // 更新i-节点
+    _touch(file_inode, TIME_MTIME | TIME_CTIME);
     std::memcpy(block_buf + inode_offset, &file_inode, sizeof(dinode));
     writeBlock(inode_block, block_buf);
     
@@ -1518,6 +2871,7 @@ int MiniFS::write(int fd, const void* buf, int count)
 // 返回值: 成功返回0，失败返回-1
 int MiniFS::rmdir(int parent_dir_inum, const char* name)
 {
+    FSLock lock(fs_mutex);
     std::cout << "开始删除目录: " << name << " (parent inum: " << parent_dir_inum << ")" << std::endl;
     
     if (strlen(name) >= DIRSIZ) {
@@ -1526,13 +2880,11 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
     }
 
     // 1. 读取父目录i-节点
-    int parent_block = INODE_START + (parent_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int parent_offset = (parent_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte buf[BLOCK_SIZE];
-    readBlock(parent_block, buf);
     dinode parent_inode;
-    std::memcpy(&parent_inode, buf + parent_offset, sizeof(dinode));
+    if (!_get_inode(parent_dir_inum, parent_inode)) {
+        std::cerr << "错误: 无法读取父目录i-节点 " << parent_dir_inum << std::endl;
+        return -1;
+    }
     
     // 确认父节点是一个目录
     if (parent_inode.type != T_DIR) {
@@ -1543,7 +2895,7 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
     // 2. 在父目录中查找目标目录的i-节点号
     int entries_count = parent_inode.size / sizeof(dirent);
     dirent entries[BLOCK_SIZE / sizeof(dirent)];
-    readBlock(parent_inode.addrs[0], entries);
+    _read_dir_block(parent_inode, entries);
     
     int target_index = -1;
     int target_inum = -1;
@@ -1562,12 +2914,11 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
     }
     
     // 3. 读取要删除的目录的i-节点
-    int target_block = INODE_START + (target_inum * INODE_SIZE) / BLOCK_SIZE;
-    int target_offset = (target_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    readBlock(target_block, buf);
     dinode target_inode;
-    std::memcpy(&target_inode, buf + target_offset, sizeof(dinode));
+    if (!_get_inode(target_inum, target_inode)) {
+        std::cerr << "错误: 无法读取目录 '" << name << "' 的i-节点" << std::endl;
+        return -1;
+    }
     
     // 确认目标是一个目录
     if (target_inode.type != T_DIR) {
@@ -1578,7 +2929,7 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
     // 4. 检查目录是否为空（只包含 . 和 ..）
     if (target_inode.size > 2 * sizeof(dirent)) {
         dirent dir_entries[BLOCK_SIZE / sizeof(dirent)];
-        readBlock(target_inode.addrs[0], dir_entries);
+        _read_dir_block(target_inode, dir_entries);
         int dir_entries_count = target_inode.size / sizeof(dirent);
         
         // 只有 . 和 .. 时才能删除
@@ -1593,7 +2944,10 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
         entries[target_index] = entries[entries_count - 1];
     }
     parent_inode.size -= sizeof(dirent);
-    parent_inode.nlink--; // 减少父目录的链接数
+    // 减少父目录的链接数 (子目录的 .. 不再指向它)；目录自身的 . 和父目录中的条目至少占 2
+    if (parent_inode.nlink > 2) {
+        parent_inode.nlink--;
+    }
     
     // 6. 释放目录的数据块
     for (int i = 0; i < 8; i++) {
@@ -1606,9 +2960,8 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
     ifree(target_inum);
     
     // 8. 更新父目录的i-节点和数据
-    writeBlock(parent_inode.addrs[0], entries);
-    std::memcpy(buf + parent_offset, &parent_inode, sizeof(dinode));
-    writeBlock(parent_block, buf);
+    _write_dir_block(parent_inode, entries);
+    _write_inode(parent_dir_inum, parent_inode);
     
     std::cout << "成功删除目录: " << name << std::endl;
     return 0;
@@ -1618,23 +2971,36 @@ int MiniFS::rmdir(int parent_dir_inum, const char* name)
 // parent_dir_inum: 父目录的i-节点号
 // name: 要删除的文件名
 // 返回值: 成功返回0，失败返回-1
+// 只删除目录项；最后一个链接被删除且没有打开的文件描述符时才真正释放文件
 int MiniFS::rm(int parent_dir_inum, const char* name)
 {
+    FSLock lock(fs_mutex);
     std::cout << "开始删除文件: " << name << " (parent inum: " << parent_dir_inum << ")" << std::endl;
-    
+
+    if (unlink(parent_dir_inum, name) != 0) {
+        return -1;
+    }
+
+    std::cout << "成功删除文件: " << name << std::endl;
+    return 0;
+}
+
+// 删除目录项并减少链接数
+// 返回值: 成功返回0，失败返回-1
+int MiniFS::unlink(int parent_dir_inum, const char* name)
+{
+    FSLock lock(fs_mutex);
     if (strlen(name) >= DIRSIZ) {
         std::cerr << "错误: 文件名称过长 (最大长度: " << DIRSIZ-1 << " 字符)" << std::endl;
         return -1;
     }
 
     // 1. 读取父目录i-节点
-    int parent_block = INODE_START + (parent_dir_inum * INODE_SIZE) / BLOCK_SIZE;
-    int parent_offset = (parent_dir_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    Byte buf[BLOCK_SIZE];
-    readBlock(parent_block, buf);
     dinode parent_inode;
-    std::memcpy(&parent_inode, buf + parent_offset, sizeof(dinode));
+    if (!_get_inode(parent_dir_inum, parent_inode)) {
+        std::cerr << "错误: 无法读取父目录i-节点 " << parent_dir_inum << std::endl;
+        return -1;
+    }
     
     // 确认父节点是一个目录
     if (parent_inode.type != T_DIR) {
@@ -1645,68 +3011,1373 @@ int MiniFS::rm(int parent_dir_inum, const char* name)
     // 2. 在父目录中查找目标文件的i-节点号
     int entries_count = parent_inode.size / sizeof(dirent);
     dirent entries[BLOCK_SIZE / sizeof(dirent)];
-    readBlock(parent_inode.addrs[0], entries);
-    
-    int target_index = -1;
-    int target_inum = -1;
-    
-    for (int i = 0; i < entries_count; i++) {
-        if (std::strcmp(entries[i].name, name) == 0) {
-            target_index = i;
-            target_inum = entries[i].inum;
-            break;
-        }
-    }
+    _read_dir_block(parent_inode, entries);
     
-    if (target_index == -1 || target_inum == -1) {
+    int target_index = _find_dir_entry(entries, entries_count, name);
+    if (target_index == -1) {
         std::cerr << "错误: 文件 '" << name << "' 不存在" << std::endl;
         return -1;
     }
+    int target_inum = entries[target_index].inum;
     
     // 3. 读取要删除的文件i-节点
-    int target_block = INODE_START + (target_inum * INODE_SIZE) / BLOCK_SIZE;
-    int target_offset = (target_inum * INODE_SIZE) % BLOCK_SIZE;
-    
-    readBlock(target_block, buf);
     dinode target_inode;
-    std::memcpy(&target_inode, buf + target_offset, sizeof(dinode));
-    
-    // 确认目标是一个文件
-    if (target_inode.type != T_FILE) {
-        std::cerr << "错误: 目标 '" << name << "' 不是一个文件 (type = " << target_inode.type << ")" << std::endl;
+    if (!_get_inode(target_inum, target_inode)) {
+        std::cerr << "错误: 无法读取文件 '" << name << "' 的i-节点" << std::endl;
         return -1;
     }
     
-    // 4. 检查该文件是否正在被使用
-    for (int i = 0; i < MAX_OPEN_FILES; i++) {
-        if (fd_table[i].is_used && fd_table[i].inum == target_inum) {
-            std::cerr << "错误: 文件 '" << name << "' 正在被文件描述符 " << i << " 使用中" << std::endl;
-            return -1;
-        }
+    // 确认目标不是目录 (目录用 rmdir 删除)
+    if (target_inode.type == T_DIR) {
+        std::cerr << "错误: 目标 '" << name << "' 是一个目录，请使用 rmdir" << std::endl;
+        return -1;
     }
     
-    // 5. 从父目录中移除该文件条目
+    // 4. 从父目录中移除该文件条目
     if (target_index < entries_count - 1) {
         entries[target_index] = entries[entries_count - 1];
     }
     parent_inode.size -= sizeof(dirent);
+    _write_dir_block(parent_inode, entries);
+    _write_inode(parent_dir_inum, parent_inode);
     
-    // 6. 释放文件的数据块
-    for (int i = 0; i < 8; i++) {
-        if (target_inode.addrs[i] != 0) {
-            bfree(target_inode.addrs[i]);
+    // 5. 减少链接数；没有名字也没有打开者时释放，仍被打开时推迟到最后一次 close
+    if (target_inode.nlink > 0) {
+        target_inode.nlink--;
+    }
+    _touch(target_inode, TIME_CTIME);
+    if (target_inode.nlink > 0) {
+        _write_inode(target_inum, target_inode);
+    } else if (_open_refs(target_inum) > 0) {
+        _write_inode(target_inum, target_inode);
+        _adjust_orphan_count(1);
+        std::cout << "文件 '" << name << "' 仍被打开，将在最后一次关闭时释放" << std::endl;
+    } else {
+        _release_inode(target_inum, target_inode);
+    }
+    return 0;
+}
+
+// 为已有文件在 new_dir_inum 目录下增加一个名为 name 的硬链接
+// 返回值: 成功返回0，失败返回-1
+int MiniFS::link(int old_inum, int new_dir_inum, const char* name)
+{
+    FSLock lock(fs_mutex);
+    dinode old_inode;
+    if (!_get_inode(old_inum, old_inode)) {
+        std::cerr << "错误: 无法读取i-节点 " << old_inum << std::endl;
+        return -1;
+    }
+    // 目录不允许硬链接，否则目录树会出现环
+    if (old_inode.type == T_DIR) {
+        std::cerr << "错误: 不能为目录创建硬链接" << std::endl;
+        return -1;
+    }
+    if (old_inode.nlink >= INT16_MAX) {
+        std::cerr << "错误: i-节点 " << old_inum << " 的链接数已达上限" << std::endl;
+        return -1;
+    }
+
+    if (_add_dir_entry(new_dir_inum, name, old_inum) != 0) {
+        return -1;
+    }
+    old_inode.nlink++;
+    _touch(old_inode, TIME_CTIME);
+    _write_inode(old_inum, old_inode);
+    std::cout << "成功创建硬链接: " << name << " -> i-节点 " << old_inum
+              << " (链接数: " << old_inode.nlink << ")" << std::endl;
+    return 0;
+}
+
+// 截断函数: 把文件大小设置为 length
+// 缩小时释放 length 之后的整块并把最后一块的尾部清零 (之后再扩展时读出的是0而不是旧数据)；
+// 扩展时只修改大小，新增部分为空洞
+// 返回值: 成功返回0，失败返回-1
+int MiniFS::truncate(int inum, int length)
+{
+    FSLock lock(fs_mutex);
+    dinode node;
+    if (!_get_inode(inum, node) || node.type != T_FILE) {
+        std::cerr << "错误: i-节点 " << inum << " 不是文件，无法截断" << std::endl;
+        return -1;
+    }
+    if (length < 0 || length > 8 * BLOCK_SIZE) {
+        std::cerr << "错误: 截断长度 " << length << " 超出范围 (0-" << 8 * BLOCK_SIZE << ")" << std::endl;
+        return -1;
+    }
+
+    // 内联文件: 在内联范围内只需清掉 length 之后的字节 (保持内联区超出 size 的部分为0)
+    if (node.flags & INODE_FLAG_INLINE) {
+        if (length <= INLINE_DATA_MAX) {
+            if (length < node.size) {
+                std::memset(reinterpret_cast<char*>(node.addrs) + length, 0, node.size - length);
+            }
+            node.size = length;
+            _touch(node, TIME_MTIME | TIME_CTIME);
+            _write_inode(inum, node);
+            return 0;
+        }
+        if (!_spill_inline(node)) {
+            return -1;
         }
     }
-    
-    // 7. 释放文件的i-节点
-    ifree(target_inum);
-    
-    // 8. 更新父目录的i-节点和数据
-    writeBlock(parent_inode.addrs[0], entries);
-    std::memcpy(buf + parent_offset, &parent_inode, sizeof(dinode));
-    writeBlock(parent_block, buf);
-    
-    std::cout << "成功删除文件: " << name << std::endl;
+
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    if (node.csum_block != 0) {
+        readBlock(node.csum_block, csums);
+    }
+
+    int keep_blocks = (length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (length < node.size) {
+        // 释放尾部整块
+        for (int i = keep_blocks; i < 8; i++) {
+            if (node.addrs[i] != 0) {
+                bfree(node.addrs[i]);
+                node.addrs[i] = 0;
+                node.unwritten &= ~(1u << i);
+                csums[i] = 0;
+            }
+        }
+        // 最后一块只保留 length 之前的部分
+        int tail = length % BLOCK_SIZE;
+        if (tail != 0 && node.addrs[keep_blocks - 1] != 0 && !(node.unwritten & (1u << (keep_blocks - 1)))) {
+            Byte data_buf[BLOCK_SIZE];
+            readBlock(node.addrs[keep_blocks - 1], data_buf);
+            std::memset(data_buf + tail, 0, BLOCK_SIZE - tail);
+            writeBlock(node.addrs[keep_blocks - 1], data_buf);
+            csums[keep_blocks - 1] = crc32c(data_buf, BLOCK_SIZE);
+        }
+    }
+    // 扩展时不分配数据块，新增部分是空洞，读出为0
+    // 截断为0后所有块都已释放，重新以内联方式存放
+    if (length == 0) {
+        node.flags |= INODE_FLAG_INLINE;
+    }
+    if (node.csum_block != 0) {
+        writeBlock(node.csum_block, csums);
+    }
+    node.size = length;
+    _touch(node, TIME_MTIME | TIME_CTIME);
+    _write_inode(inum, node);
+    return 0;
+}
+
+// 按文件描述符截断，要求以可写方式打开
+int MiniFS::ftruncate(int fd, int length)
+{
+    FSLock lock(fs_mutex);
+    if (fd < 0 || fd >= MAX_OPEN_FILES || !fd_table[fd].is_used) {
+        std::cerr << "错误: 无效的文件描述符 " << fd << std::endl;
+        return -1;
+    }
+    if (!(fd_table[fd].mode & O_WRONLY)) { // O_WRONLY 与 O_RDWR 都含写位
+        std::cerr << "错误: 文件描述符 " << fd << " 没有写权限" << std::endl;
+        return -1;
+    }
+    return truncate(fd_table[fd].inum, length);
+}
+
+// 重命名函数: 把 src_dir_inum 下的 src_name 改名/移动为 dst_dir_inum 下的 dst_name
+// 先写入新目录项再删除旧目录项，任何时刻文件至少有一个名字；目标已存在时直接改写其目录项，
+// 不存在"目标消失"的窗口
+// 返回值: 成功返回0，失败返回-1
+int MiniFS::rename(int src_dir_inum, const char* src_name, int dst_dir_inum, const char* dst_name)
+{
+    FSLock lock(fs_mutex);
+    const int max_entries = BLOCK_SIZE / sizeof(dirent);
+    if (std::strcmp(src_name, ".") == 0 || std::strcmp(src_name, "..") == 0 ||
+        std::strcmp(dst_name, ".") == 0 || std::strcmp(dst_name, "..") == 0) {
+        std::cerr << "错误: 不能重命名 '.' 或 '..'" << std::endl;
+        return -1;
+    }
+    if (strlen(dst_name) == 0 || strlen(dst_name) >= DIRSIZ) {
+        std::cerr << "错误: 名称长度无效 (最大长度: " << DIRSIZ-1 << " 字符)" << std::endl;
+        return -1;
+    }
+
+    // 1. 读取源目录与目标目录
+    dinode src_dir, dst_dir;
+    if (!_get_inode(src_dir_inum, src_dir) || src_dir.type != T_DIR ||
+        !_get_inode(dst_dir_inum, dst_dir) || dst_dir.type != T_DIR) {
+        std::cerr << "错误: 源或目标父i-节点不是目录" << std::endl;
+        return -1;
+    }
+    bool same_dir = src_dir_inum == dst_dir_inum;
+    dirent src_entries[BLOCK_SIZE / sizeof(dirent)];
+    dirent dst_buf[BLOCK_SIZE / sizeof(dirent)];
+    _read_dir_block(src_dir, src_entries);
+    if (!same_dir) {
+        _read_dir_block(dst_dir, dst_buf);
+    }
+    // 同一目录内重命名时两边操作同一份目录项
+    dinode& dd = same_dir ? src_dir : dst_dir;
+    dirent* dst_entries = same_dir ? src_entries : dst_buf;
+
+    // 2. 查找源条目
+    int src_index = _find_dir_entry(src_entries, src_dir.size / sizeof(dirent), src_name);
+    if (src_index == -1) {
+        std::cerr << "错误: '" << src_name << "' 不存在" << std::endl;
+        return -1;
+    }
+    int inum = src_entries[src_index].inum;
+    dinode node;
+    if (!_get_inode(inum, node)) {
+        std::cerr << "错误: 无法读取i-节点 " << inum << std::endl;
+        return -1;
+    }
+
+    // 3. 目录不能移动到自己或自己的子孙目录下: 从目标目录沿 .. 向上走到根
+    if (node.type == T_DIR && !same_dir) {
+        int cur = dst_dir_inum;
+        while (true) {
+            if (cur == inum) {
+                std::cerr << "错误: 不能把目录移动到它自己的子目录中" << std::endl;
+                return -1;
+            }
+            if (cur == ROOT_INUM_CONST) {
+                break;
+            }
+            int parent = _lookup_in_directory(cur, "..");
+            if (parent == INVALID_INUM_CONST || parent == cur) {
+                break;
+            }
+            cur = parent;
+        }
+    }
+
+    // 4. 目标已存在: 检查类型是否可以替换
+    int dst_count = dd.size / sizeof(dirent);
+    int dst_index = _find_dir_entry(dst_entries, dst_count, dst_name);
+    int replaced_inum = INVALID_INUM_CONST;
+    dinode replaced;
+    if (dst_index != -1) {
+        replaced_inum = dst_entries[dst_index].inum;
+        if (replaced_inum == inum) {
+            return 0; // 两个名字指向同一个i-节点，什么也不做
+        }
+        if (!_get_inode(replaced_inum, replaced)) {
+            std::cerr << "错误: 无法读取目标i-节点 " << replaced_inum << std::endl;
+            return -1;
+        }
+        if (replaced.type == T_DIR && node.type != T_DIR) {
+            std::cerr << "错误: 不能用非目录覆盖目录 '" << dst_name << "'" << std::endl;
+            return -1;
+        }
+        if (replaced.type != T_DIR && node.type == T_DIR) {
+            std::cerr << "错误: 不能用目录覆盖非目录 '" << dst_name << "'" << std::endl;
+            return -1;
+        }
+        if (replaced.type == T_DIR && replaced.size > static_cast<int>(2 * sizeof(dirent))) {
+            std::cerr << "错误: 目标目录 '" << dst_name << "' 非空" << std::endl;
+            return -1;
+        }
+    } else if (dst_count >= max_entries) {
+        std::cerr << "错误: 目标目录已满 (最多 " << max_entries << " 项)" << std::endl;
+        return -1;
+    }
+
+    // 5. 修改目录项: 先让新名字指向该i-节点，再删除旧名字
+    if (dst_index != -1) {
+        dst_entries[dst_index].inum = inum;
+        dst_entries[dst_index].type = static_cast<uint8_t>(node.type);
+    } else {
+        std::memset(&dst_entries[dst_count], 0, sizeof(dirent));
+        dst_entries[dst_count].inum = inum;
+        dst_entries[dst_count].type = static_cast<uint8_t>(node.type);
+        std::strcpy(dst_entries[dst_count].name, dst_name);
+        dd.size += sizeof(dirent);
+    }
+    int src_count = src_dir.size / sizeof(dirent);
+    if (src_index < src_count - 1) {
+        src_entries[src_index] = src_entries[src_count - 1];
+    }
+    src_dir.size -= sizeof(dirent);
+
+    // 6. 链接数: 跨目录移动目录时 .. 改指向新父目录；被替换的空目录的 .. 随之消失
+    if (node.type == T_DIR && !same_dir) {
+        if (src_dir.nlink > 2) {
+            src_dir.nlink--;
+        }
+        dd.nlink++;
+    }
+    if (replaced_inum != INVALID_INUM_CONST && replaced.type == T_DIR && dd.nlink > 2) {
+        dd.nlink--;
+    }
+
+    if (!same_dir) {
+        _write_dir_block(dst_dir, dst_entries);
+        _write_inode(dst_dir_inum, dst_dir);
+    }
+    _write_dir_block(src_dir, src_entries);
+    _write_inode(src_dir_inum, src_dir);
+
+    // 被移动的i-节点更新改变时间 (跨目录移动目录时随 .. 的修改一起写回)
+    bool node_written = false;
+    if (node.type == T_DIR && !same_dir) {
+        dirent child_entries[BLOCK_SIZE / sizeof(dirent)];
+        _read_dir_block(node, child_entries);
+        int dotdot = _find_dir_entry(child_entries, node.size / sizeof(dirent), "..");
+        if (dotdot != -1) {
+            child_entries[dotdot].inum = dst_dir_inum;
+            _write_dir_block(node, child_entries);
+            _write_inode(inum, node);
+            node_written = true;
+        }
+    }
+    if (!node_written) {
+        _touch(node, TIME_CTIME);
+        _write_inode(inum, node);
+    }
+
+    // 7. 释放被替换的目标
+    if (replaced_inum != INVALID_INUM_CONST) {
+        if (replaced.type == T_DIR) {
+            _release_inode(replaced_inum, replaced);
+        } else {
+            if (replaced.nlink > 0) {
+                replaced.nlink--;
+            }
+            _touch(replaced, TIME_CTIME);
+            if (replaced.nlink > 0) {
+                _write_inode(replaced_inum, replaced);
+            } else if (_open_refs(replaced_inum) > 0) {
+                _write_inode(replaced_inum, replaced);
+                _adjust_orphan_count(1);
+            } else {
+                _release_inode(replaced_inum, replaced);
+            }
+        }
+    }
+
+    std::cout << "成功重命名: " << src_name << " -> " << dst_name << " (inum: " << inum << ")" << std::endl;
+    return 0;
+}
+
+// 在 parent_dir_inum 目录下创建名为 name、指向 target 的符号链接
+// 目标不要求存在；短目标内联在i-节点中，长目标占用一个数据块
+// 返回值: 成功返回新i-节点号，失败返回 INVALID_INUM_CONST
+int MiniFS::symlink(int parent_dir_inum, const char* name, const char* target)
+{
+    FSLock lock(fs_mutex);
+    int target_len = static_cast<int>(strlen(target));
+    if (target_len == 0 || target_len > SYMLINK_MAX) {
+        std::cerr << "错误: 链接目标长度无效 (1-" << SYMLINK_MAX << " 字节)" << std::endl;
+        return INVALID_INUM_CONST;
+    }
+
+    int link_inum = ialloc(T_SYMLINK);
+    if (link_inum == -1) {
+        std::cerr << "错误: 无法分配i-节点" << std::endl;
+        return INVALID_INUM_CONST;
+    }
+
+    dinode link_inode;
+    std::memset(&link_inode, 0, sizeof(dinode));
+    link_inode.type = T_SYMLINK;
+    link_inode.nlink = 1;
+    link_inode.size = target_len;
+    _touch(link_inode, TIME_ATIME | TIME_MTIME | TIME_CTIME);
+    if (target_len <= SYMLINK_INLINE_MAX) {
+        std::memcpy(link_inode.addrs, target, target_len);
+    } else {
+        int block = balloc(false); // 随后整块写入目标路径
+        if (block == -1) {
+            std::cerr << "错误: 无法分配数据块" << std::endl;
+            ifree(link_inum);
+            return INVALID_INUM_CONST;
+        }
+        Byte buf[BLOCK_SIZE];
+        std::memset(buf, 0, sizeof(buf));
+        std::memcpy(buf, target, target_len);
+        writeBlock(block, buf);
+        link_inode.addrs[0] = block;
+    }
+
+    if (_add_dir_entry(parent_dir_inum, name, link_inum) != 0) {
+        _release_inode(link_inum, link_inode);
+        return INVALID_INUM_CONST;
+    }
+    _write_inode(link_inum, link_inode);
+    std::cout << "成功创建符号链接: " << name << " -> " << target << " (inum: " << link_inum
+              << (target_len <= SYMLINK_INLINE_MAX ? ", 内联" : "") << ")" << std::endl;
+    return link_inum;
+}
+
+// 读取符号链接的目标，返回目标长度，不是符号链接时返回-1
+int MiniFS::readlink(int inum, std::string& target_out)
+{
+    FSLock lock(fs_mutex);
+    dinode node;
+    if (!_get_inode(inum, node) || node.type != T_SYMLINK) {
+        std::cerr << "错误: i-节点 " << inum << " 不是符号链接" << std::endl;
+        return -1;
+    }
+    if (!_read_symlink(node, target_out)) {
+        return -1;
+    }
+    _touch_atime(inum);
+    return static_cast<int>(target_out.size());
+}
+
+// 取出符号链接i-节点中的目标字符串: 内联目标不需要读数据块
+bool MiniFS::_read_symlink(const dinode& node, std::string& target_out)
+{
+    if (node.size <= 0 || node.size > SYMLINK_MAX) {
+        std::cerr << "错误: 符号链接长度无效 (" << node.size << ")" << std::endl;
+        return false;
+    }
+    if (node.size <= SYMLINK_INLINE_MAX) {
+        target_out.assign(reinterpret_cast<const char*>(node.addrs), node.size);
+        return true;
+    }
+    if (node.addrs[0] < DATA_START || node.addrs[0] >= BLOCK_COUNT) {
+        std::cerr << "错误: 符号链接数据块号 " << node.addrs[0] << " 无效" << std::endl;
+        return false;
+    }
+    Byte buf[BLOCK_SIZE];
+    readBlock(node.addrs[0], buf);
+    target_out.assign(reinterpret_cast<const char*>(buf), node.size);
+    return true;
+}
+
+// 在目录项数组中按名称查找，返回下标，未找到返回-1
+int MiniFS::_find_dir_entry(const dirent* entries, int entries_count, const char* name)
+{
+    for (int i = 0; i < entries_count; i++) {
+        if (std::strcmp(entries[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 在目录中追加一个目录项 (检查重名与容量)，成功返回0，失败返回-1
+int MiniFS::_add_dir_entry(int dir_inum, const char* name, int inum)
+{
+    if (strlen(name) == 0 || strlen(name) >= DIRSIZ) {
+        std::cerr << "错误: 名称长度无效 (最大长度: " << DIRSIZ-1 << " 字符)" << std::endl;
+        return -1;
+    }
+    dinode dir_inode;
+    if (!_get_inode(dir_inum, dir_inode) || dir_inode.type != T_DIR) {
+        std::cerr << "错误: i-节点 " << dir_inum << " 不是目录" << std::endl;
+        return -1;
+    }
+
+    int entries_count = dir_inode.size / sizeof(dirent);
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    _read_dir_block(dir_inode, entries);
+    if (_find_dir_entry(entries, entries_count, name) != -1) {
+        std::cerr << "错误: 目录中已存在同名项 '" << name << "'" << std::endl;
+        return -1;
+    }
+    if (entries_count >= static_cast<int>(BLOCK_SIZE / sizeof(dirent))) {
+        std::cerr << "错误: 目录已满 (最多 " << BLOCK_SIZE / sizeof(dirent) << " 项)" << std::endl;
+        return -1;
+    }
+
+    dinode target;
+    std::memset(&entries[entries_count], 0, sizeof(dirent));
+    entries[entries_count].inum = inum;
+    entries[entries_count].type = _get_inode(inum, target) ? static_cast<uint8_t>(target.type) : 0;
+    std::strcpy(entries[entries_count].name, name);
+    dir_inode.size += sizeof(dirent);
+    _write_dir_block(dir_inode, entries);
+    _write_inode(dir_inum, dir_inode);
+    return 0;
+}
+
+// 统计引用该i-节点的打开文件描述符个数
+int MiniFS::_open_refs(int inum)
+{
+    int refs = 0;
+    for (int i = 0; i < MAX_OPEN_FILES; i++) {
+        if (fd_table[i].is_used && fd_table[i].inum == inum) {
+            refs++;
+        }
+    }
+    return refs;
+}
+
+// 释放文件占用的全部数据块 (含数据校验边车块) 和i-节点本身
+void MiniFS::_release_inode(int inum, const dinode& node)
+{
+    // 快速符号链接和内联文件的 addrs 区域存放的是数据而不是块号
+    bool inline_data = (node.type == T_SYMLINK && node.size <= SYMLINK_INLINE_MAX) ||
+                       (node.flags & INODE_FLAG_INLINE);
+    for (int i = 0; i < 8 && !inline_data; i++) {
+        if (node.addrs[i] != 0) {
+            bfree(node.addrs[i]);
+        }
+    }
+    if (node.csum_block != 0) {
+        bfree(node.csum_block);
+    }
+    ifree(inum);
+}
+
+// 回收链接数为0的孤儿i-节点 (文件被删除时仍处于打开状态，之后镜像被保存)
+// 只有超级块记录了孤儿时才扫描i-节点表，平时加载不触碰i-节点块
+int MiniFS::_reclaim_orphans()
+{
+    Byte buf[BLOCK_SIZE];
+    readBlock(0, buf);
+    superblock sb;
+    std::memcpy(&sb, buf, sizeof(superblock));
+    if (sb.orphan_count <= 0) {
+        return 0;
+    }
+    int reclaimed = 0;
+    for (int inum = 1; inum < INODE_NUM; inum++) {
+        dinode node;
+        if (_get_inode(inum, node) && node.type != T_DIR && node.nlink <= 0 && _open_refs(inum) == 0) {
+            _release_inode(inum, node);
+            reclaimed++;
+        }
+    }
+    _adjust_orphan_count(-sb.orphan_count);
+    return reclaimed;
+}
+
+// 修改超级块中的孤儿计数
+void MiniFS::_adjust_orphan_count(int delta)
+{
+    Byte buf[BLOCK_SIZE];
+    readBlock(0, buf);
+    superblock* sb = reinterpret_cast<superblock*>(buf);
+    sb->orphan_count = std::max(0, sb->orphan_count + delta);
+    writeBlock(0, buf);
+}
+
+/**
+ * @brief 为文件开启或关闭数据块校验
+ *
+ * 开启时分配一个边车块，按块下标存放每个数据块的CRC32C，并为已有数据块算好校验和；
+ * 之后 write 会同步更新，read 和巡检会核对。关闭时释放边车块。
+ *
+ * @return 成功返回0，失败返回-1
+ */
+int MiniFS::setDataChecksums(int inum, bool enable)
+{
+    FSLock lock(fs_mutex);
+    dinode node;
+    if (!_get_inode(inum, node) || node.type != T_FILE) {
+        std::cerr << "错误: i-节点 " << inum << " 不是文件，无法设置数据校验" << std::endl;
+        return -1;
+    }
+
+    if (!enable) {
+        if (node.csum_block != 0) {
+            bfree(node.csum_block);
+            node.csum_block = 0;
+            _touch(node, TIME_CTIME);
+            _write_inode(inum, node);
+        }
+        return 0;
+    }
+    if (node.csum_block != 0) {
+        return 0; // 已经开启
+    }
+
+    int csum_block = balloc(false); // 随后整块写入全部校验和
+    if (csum_block == -1) {
+        std::cerr << "错误: 无法为数据校验和分配边车块" << std::endl;
+        return -1;
+    }
+    // 内联数据由i-节点块的元数据校验覆盖，边车块从迁出时开始使用
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    std::memset(csums, 0, sizeof(csums));
+    for (int i = 0; i < 8 && !(node.flags & INODE_FLAG_INLINE); i++) {
+        if (node.addrs[i] != 0 && !(node.unwritten & (1u << i))) {
+            Byte data_buf[BLOCK_SIZE];
+            readBlock(node.addrs[i], data_buf);
+            csums[i] = crc32c(data_buf, BLOCK_SIZE);
+        }
+    }
+    writeBlock(csum_block, csums);
+    node.csum_block = csum_block;
+    _touch(node, TIME_CTIME);
+    _write_inode(inum, node);
+    return 0;
+}
+
+// 巡检一个文件的全部数据块，返回不匹配的块数；不是开启数据校验的文件时返回-1
+int MiniFS::_scrub_file(int inum, long& blocks_checked)
+{
+    // 在锁内复制校验和与数据块，锁外计算 CRC32C，多个文件可以同时计算
+    dinode node;
+    uint32_t csums[BLOCK_SIZE / sizeof(uint32_t)];
+    Byte data[8][BLOCK_SIZE];
+    bool present[8] = {false};
+    {
+        FSLock lock(fs_mutex);
+        if (!_get_inode(inum, node) || node.type != T_FILE || node.csum_block == 0) {
+            return -1;
+        }
+        readBlock(node.csum_block, csums);
+        for (int i = 0; i < 8 && !(node.flags & INODE_FLAG_INLINE); i++) {
+            if (node.addrs[i] == 0 || (node.unwritten & (1u << i))) {
+                continue;
+            }
+            readBlock(node.addrs[i], data[i]);
+            present[i] = true;
+        }
+    }
+
+    int mismatches = 0;
+    for (int i = 0; i < 8; i++) {
+        if (!present[i]) {
+            continue;
+        }
+        blocks_checked++;
+        if (crc32c(data[i], BLOCK_SIZE) != csums[i]) {
+            mismatches++;
+            std::cerr << "巡检: 文件 (inum " << inum << ") 第 " << i << " 块 (块号 "
+                      << node.addrs[i] << ") 数据校验失败" << std::endl;
+        }
+    }
+    return mismatches;
+}
+
+// 同步执行一次完整巡检: 每个i-节点一个任务，在内部线程池上并行校验
+int MiniFS::scrubOnce()
+{
+    std::atomic<int> mismatches(0);
+    TaskTree tree(_work_pool());
+    for (int inum = 1; inum < INODE_NUM; inum++) {
+        tree.spawn([this, inum, &mismatches](TaskTree::Node&) {
+            long blocks = 0;
+            int bad = _scrub_file(inum, blocks);
+            if (bad < 0) {
+                return;
+            }
+            scrub_files++;
+            scrub_blocks += blocks;
+            scrub_mismatches += bad;
+            data_csum_failure_count += bad;
+            mismatches += bad;
+        });
+    }
+    tree.wait();
+    int total = mismatches + verifyAllMetadata();
+    scrub_passes++;
+    return total;
+}
+
+// 并行遍历目录树: 每个目录的任务用 readdirplus 读出全部目录项及其i-节点，锁外回调并为子目录派生任务
+long MiniFS::walkTree(int dir_inum, const TreeVisitor& visit)
+{
+    dinode top;
+    if (!_get_inode(dir_inum, top) || top.type != T_DIR) {
+        std::cerr << "错误: i-节点 " << dir_inum << " 不是目录" << std::endl;
+        return -1;
+    }
+    struct Child {
+        std::string name;
+        int inum;
+        dinode node;
+    };
+    std::atomic<long> visited(0);
+    std::function<void(TaskTree::Node&, int)> walk_dir;
+    walk_dir = [&](TaskTree::Node& task, int inum) {
+        std::vector<Child> children;
+        std::vector<DirEntryPlus> items;
+        if (readdirplus(inum, items) < 0) {
+            return;
+        }
+        for (const DirEntryPlus& item : items) {
+            if (item.entry.name == "." || item.entry.name == ".." || item.attr.type == T_FREE) {
+                continue;
+            }
+            Child c;
+            c.name = item.entry.name;
+            c.inum = item.entry.inum;
+            c.node = item.attr;
+            children.push_back(c);
+        }
+        for (const Child& c : children) {
+            visit(inum, c.name, c.inum, c.node);
+            visited++;
+            if (c.node.type == T_DIR) {
+                int sub = c.inum;
+                task.spawn([&walk_dir, sub](TaskTree::Node& n) { walk_dir(n, sub); });
+            }
+        }
+    };
+    TaskTree tree(_work_pool());
+    tree.spawn([&walk_dir, dir_inum](TaskTree::Node& n) { walk_dir(n, dir_inum); });
+    tree.wait();
+    return visited;
+}
+
+// 后台巡检线程: 逐个文件校验，每校验 N 个块就按速率睡眠，一轮结束后稍作休息再开始下一轮
+void MiniFS::_scrubber_main(int blocks_per_sec)
+{
+    std::unique_lock<std::mutex> lk(scrub_mutex);
+    while (!scrub_stop) {
+        for (int inum = 1; inum < INODE_NUM && !scrub_stop; inum++) {
+            long blocks = 0;
+            lk.unlock();
+            int bad = _scrub_file(inum, blocks);
+            if (bad >= 0) {
+                scrub_files++;
+                scrub_blocks += blocks;
+                scrub_mismatches += bad;
+                data_csum_failure_count += bad;
+            }
+            lk.lock();
+            if (blocks > 0) {
+                scrub_cv.wait_for(lk, std::chrono::microseconds(blocks * 1000000L / blocks_per_sec),
+                                  [this] { return scrub_stop; });
+            }
+        }
+        if (scrub_stop) {
+            break;
+        }
+        lk.unlock();
+        scrub_mismatches += verifyAllMetadata();
+        lk.lock();
+        scrub_passes++;
+        scrub_cv.wait_for(lk, std::chrono::seconds(1), [this] { return scrub_stop; });
+    }
+}
+
+// 启动后台巡检线程
+bool MiniFS::startScrubber(int blocks_per_sec)
+{
+    std::lock_guard<std::mutex> lk(scrub_mutex);
+    if (scrub_thread.joinable()) {
+        std::cerr << "巡检线程已在运行" << std::endl;
+        return false;
+    }
+    if (blocks_per_sec <= 0) {
+        blocks_per_sec = 1;
+    }
+    scrub_stop = false;
+    scrub_thread = std::thread(&MiniFS::_scrubber_main, this, blocks_per_sec);
+    std::cout << "后台巡检已启动 (限速 " << blocks_per_sec << " 块/秒)" << std::endl;
+    return true;
+}
+
+// 停止后台巡检线程并等待其退出
+void MiniFS::stopScrubber()
+{
+    {
+        std::lock_guard<std::mutex> lk(scrub_mutex);
+        if (!scrub_thread.joinable()) {
+            return;
+        }
+        scrub_stop = true;
+    }
+    scrub_cv.notify_all();
+    scrub_thread.join();
+    std::cout << "后台巡检已停止" << std::endl;
+}
+
+// 获取巡检统计
+MiniFS::ScrubStats MiniFS::getScrubStats() const
+{
+    ScrubStats stats;
+    stats.passes = scrub_passes;
+    stats.files = scrub_files;
+    stats.blocks = scrub_blocks;
+    stats.mismatches = scrub_mismatches;
+    std::lock_guard<std::mutex> lk(scrub_mutex);
+    stats.running = scrub_thread.joinable();
+    return stats;
+}
+
+// 获取块I/O计数
+MiniFS::IOStats MiniFS::getIOStats() const
+{
+    IOStats stats;
+    stats.meta_reads = io_meta_reads;
+    stats.meta_writes = io_meta_writes;
+    stats.data_reads = io_data_reads;
+    stats.data_writes = io_data_writes;
+    stats.readahead_fills = io_readahead_fills;
+    stats.readahead_hits = io_readahead_hits;
+    stats.attr_cache_hits = io_attr_cache_hits;
+    stats.attr_cache_misses = io_attr_cache_misses;
+    return stats;
+}
+
+// 文件内容按块切分后某一块是否全为0 (全0块导入为空洞，不占用数据块)
+static bool bulk_chunk_is_zero(const std::string& data, int block_index)
+{
+    size_t begin = static_cast<size_t>(block_index) * BLOCK_SIZE;
+    size_t end = std::min(data.size(), begin + BLOCK_SIZE);
+    for (size_t i = begin; i < end; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 检查目录 dir 的子树能否放进镜像 (名称长度、目录容量、文件大小)，并累计需要的i-节点数和数据块数；
+// 未加载内容的文件按大小估计最多需要的块数，累计到 deferred_blocks
+bool MiniFS::_bulk_plan(const HostNode& dir, int& inodes_needed, int& blocks_needed, int& deferred_blocks)
+{
+    for (size_t i = 0; i < dir.children.size(); i++) {
+        const HostNode& child = dir.children[i];
+        for (size_t j = 0; j < i; j++) {
+            if (dir.children[j].name == child.name) {
+                std::cerr << "错误: 同一目录下有重名项 '" << child.name << "'" << std::endl;
+                return false;
+            }
+        }
+        if (child.name.empty() || child.name.size() >= static_cast<size_t>(DIRSIZ) ||
+            child.name == "." || child.name == ".." || child.name.find('/') != std::string::npos) {
+            std::cerr << "错误: 名称 '" << child.name << "' 无效 (最大长度: " << DIRSIZ-1 << " 字符)" << std::endl;
+            return false;
+        }
+        inodes_needed++;
+        switch (child.kind) {
+        case HostNode::DIR_NODE:
+            if (child.children.size() + 2 > BLOCK_SIZE / sizeof(dirent)) {
+                std::cerr << "错误: 目录 '" << child.name << "' 有 " << child.children.size()
+                          << " 项，超过上限 " << BLOCK_SIZE / sizeof(dirent) - 2 << std::endl;
+                return false;
+            }
+            blocks_needed++;
+            if (!_bulk_plan(child, inodes_needed, blocks_needed, deferred_blocks)) {
+                return false;
+            }
+            break;
+        case HostNode::FILE_NODE: {
+            if (child.fileSize() > 8 * BLOCK_SIZE) {
+                std::cerr << "错误: 文件 '" << child.name << "' 大小 " << child.fileSize()
+                          << " 超过上限 " << 8 * BLOCK_SIZE << " 字节" << std::endl;
+                return false;
+            }
+            int size = static_cast<int>(child.fileSize());
+            if (child.data.empty()) {
+                deferred_blocks += size > INLINE_DATA_MAX ? (size + BLOCK_SIZE - 1) / BLOCK_SIZE : 0;
+            } else if (size > INLINE_DATA_MAX) {
+                for (int b = 0; b * BLOCK_SIZE < size; b++) {
+                    if (!bulk_chunk_is_zero(child.data, b)) {
+                        blocks_needed++;
+                    }
+                }
+            }
+            break;
+        }
+        case HostNode::SYMLINK_NODE:
+            if (child.data.empty() || child.data.size() > static_cast<size_t>(SYMLINK_MAX)) {
+                std::cerr << "错误: 符号链接 '" << child.name << "' 的目标长度无效 (1-" << SYMLINK_MAX
+                          << " 字节)" << std::endl;
+                return false;
+            }
+            if (child.data.size() > static_cast<size_t>(SYMLINK_INLINE_MAX)) {
+                blocks_needed++;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+// 生成目录 dir 的全部子项: 目录项写入 entries[first_slot...]，数据块直接落盘，
+// 新i-节点收集到 inodes_out 中由调用者成批写回；返回子目录个数 (用于父目录的链接数)
+int MiniFS::_bulk_build_children(const HostNode& dir, int dir_inum, dirent* entries, int first_slot,
+                                 const std::vector<int>& inums, size_t& next_inum,
+                                 const std::vector<int>& blocks, size_t& next_block,
+                                 std::vector<std::pair<int, dinode> >& inodes_out,
+                                 std::vector<BulkFile>* deferred_files)
+{
+    // 同一目录的子项先连续编号，再逐个生成内容 (子目录的子项排在后面)
+    size_t base = next_inum;
+    next_inum += dir.children.size();
+
+    int subdirs = 0;
+    for (size_t i = 0; i < dir.children.size(); i++) {
+        const HostNode& child = dir.children[i];
+        int inum = inums[base + i];
+        std::memset(&entries[first_slot + i], 0, sizeof(dirent));
+        entries[first_slot + i].inum = inum;
+        entries[first_slot + i].type = child.kind == HostNode::DIR_NODE ? T_DIR
+                                     : child.kind == HostNode::SYMLINK_NODE ? T_SYMLINK : T_FILE;
+        std::strcpy(entries[first_slot + i].name, child.name.c_str());
+
+        dinode node;
+        std::memset(&node, 0, sizeof(dinode));
+        node.nlink = 1;
+        node.size = static_cast<int>(child.data.size());
+        _touch(node, TIME_ATIME | TIME_MTIME | TIME_CTIME);
+        Byte buf[BLOCK_SIZE];
+
+        switch (child.kind) {
+        case HostNode::FILE_NODE:
+            node.type = T_FILE;
+            if (child.data.empty() && child.size > 0) {
+                // 内容稍后由调用者填入，先生成空的内联文件
+                BulkFile deferred = { &child, inum };
+                deferred_files->push_back(deferred);
+                node.size = 0;
+                node.flags = INODE_FLAG_INLINE;
+                break;
+            }
+            if (node.size <= INLINE_DATA_MAX) {
+                node.flags = INODE_FLAG_INLINE;
+                std::memcpy(node.addrs, child.data.data(), node.size);
+                break;
+            }
+            for (int b = 0; b * BLOCK_SIZE < node.size; b++) {
+                if (bulk_chunk_is_zero(child.data, b)) {
+                    continue; // 空洞
+                }
+                int chunk = std::min(BLOCK_SIZE, node.size - b * BLOCK_SIZE);
+                std::memset(buf, 0, sizeof(buf));
+                std::memcpy(buf, child.data.data() + b * BLOCK_SIZE, chunk);
+                node.addrs[b] = blocks[next_block++];
+                writeBlock(node.addrs[b], buf);
+            }
+            break;
+
+        case HostNode::SYMLINK_NODE:
+            node.type = T_SYMLINK;
+            if (node.size <= SYMLINK_INLINE_MAX) {
+                std::memcpy(node.addrs, child.data.data(), node.size);
+            } else {
+                std::memset(buf, 0, sizeof(buf));
+                std::memcpy(buf, child.data.data(), node.size);
+                node.addrs[0] = blocks[next_block++];
+                writeBlock(node.addrs[0], buf);
+            }
+            break;
+
+        case HostNode::DIR_NODE: {
+            node.type = T_DIR;
+            node.addrs[0] = blocks[next_block++];
+            dirent sub_entries[BLOCK_SIZE / sizeof(dirent)];
+            std::memset(sub_entries, 0, sizeof(sub_entries));
+            sub_entries[0].inum = inum;
+            sub_entries[0].type = T_DIR;
+            std::strcpy(sub_entries[0].name, ".");
+            sub_entries[1].inum = dir_inum;
+            sub_entries[1].type = T_DIR;
+            std::strcpy(sub_entries[1].name, "..");
+            int sub_dirs = _bulk_build_children(child, inum, sub_entries, 2, inums, next_inum,
+                                                blocks, next_block, inodes_out, deferred_files);
+            node.size = static_cast<int>((2 + child.children.size()) * sizeof(dirent));
+            node.nlink = static_cast<int16_t>(2 + sub_dirs);
+            _write_dir_block(node, sub_entries);
+            subdirs++;
+            break;
+        }
+        }
+        inodes_out.push_back(std::make_pair(inum, node));
+    }
+    return subdirs;
+}
+
+int MiniFS::bulkImport(const HostNode& tree, int dest_dir_inum, std::vector<BulkFile>* deferred_files)
+{
+    FSLock lock(fs_mutex);
+    if (tree.kind != HostNode::DIR_NODE) {
+        std::cerr << "错误: 批量导入的源必须是目录" << std::endl;
+        return -1;
+    }
+    dinode dest;
+    if (!_get_inode(dest_dir_inum, dest) || dest.type != T_DIR) {
+        std::cerr << "错误: i-节点 " << dest_dir_inum << " 不是目录" << std::endl;
+        return -1;
+    }
+    int entries_count = dest.size / sizeof(dirent);
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    _read_dir_block(dest, entries);
+    if (entries_count + tree.children.size() > BLOCK_SIZE / sizeof(dirent)) {
+        std::cerr << "错误: 目标目录放不下 " << tree.children.size() << " 个新项 (最多 "
+                  << BLOCK_SIZE / sizeof(dirent) << " 项)" << std::endl;
+        return -1;
+    }
+    for (const HostNode& child : tree.children) {
+        if (_find_dir_entry(entries, entries_count, child.name.c_str()) != -1) {
+            std::cerr << "错误: 目标目录中已存在同名项 '" << child.name << "'" << std::endl;
+            return -1;
+        }
+    }
+
+    // 1. 规划: 检查整棵树并统计需要的资源
+    int inodes_needed = 0;
+    int blocks_needed = 0;
+    int deferred_blocks = 0;
+    if (!_bulk_plan(tree, inodes_needed, blocks_needed, deferred_blocks)) {
+        return -1;
+    }
+    if (deferred_blocks > 0 && deferred_files == nullptr) {
+        std::cerr << "错误: 批量导入的文件内容未加载" << std::endl;
+        return -1;
+    }
+    if (blocks_needed + deferred_blocks > countFreeBlocks()) {
+        std::cerr << "错误: 数据块不足 (需要 " << blocks_needed + deferred_blocks << " 个)" << std::endl;
+        return -1;
+    }
+
+    // 2. 一次性分配: 位图各读写一次，数据块尽量连续
+    std::vector<int> inums;
+    if (ialloc_n(inodes_needed, T_FILE, inums) < inodes_needed) {
+        std::cerr << "错误: i-节点不足 (需要 " << inodes_needed << " 个)" << std::endl;
+        for (int inum : inums) {
+            ifree(inum);
+        }
+        return -1;
+    }
+    std::vector<BlockSpan> spans;
+    if (balloc_n(blocks_needed, 0, spans, false) < blocks_needed) {
+        std::cerr << "错误: 数据块不足 (需要 " << blocks_needed << " 个)" << std::endl;
+        for (const BlockSpan& span : spans) {
+            for (int b = 0; b < span.count; b++) {
+                bfree(span.start + b);
+            }
+        }
+        for (int inum : inums) {
+            ifree(inum);
+        }
+        return -1;
+    }
+    std::vector<int> blocks;
+    for (const BlockSpan& span : spans) {
+        for (int b = 0; b < span.count; b++) {
+            blocks.push_back(span.start + b);
+        }
+    }
+
+    // 3. 生成: 数据块和目录块各写一次，i-节点按块成批写回
+    size_t next_inum = 0;
+    size_t next_block = 0;
+    std::vector<std::pair<int, dinode> > new_inodes;
+    int subdirs = _bulk_build_children(tree, dest_dir_inum, entries, entries_count, inums, next_inum,
+                                       blocks, next_block, new_inodes, deferred_files);
+    _write_inodes(new_inodes);
+
+    // 4. 把第一层子项挂到目标目录
+    dest.size += static_cast<int>(tree.children.size() * sizeof(dirent));
+    dest.nlink += subdirs;
+    _write_dir_block(dest, entries);
+    _write_inode(dest_dir_inum, dest);
+
+    std::cout << "批量导入完成: " << inodes_needed << " 个i-节点, " << blocks_needed << " 个数据块 ("
+              << spans.size() << " 段连续区间)" << std::endl;
+    return inodes_needed;
+}
+
+int MiniFS::bulkLayoutFile(const std::string& data, int goal, dinode& node_out, std::vector<int>& blocks_out)
+{
+    FSLock lock(fs_mutex);
+    int size = static_cast<int>(data.size());
+    if (data.size() > static_cast<size_t>(8 * BLOCK_SIZE)) {
+        std::cerr << "错误: 文件大小 " << data.size() << " 超过上限 " << 8 * BLOCK_SIZE << " 字节" << std::endl;
+        return -1;
+    }
+    std::memset(&node_out, 0, sizeof(dinode));
+    node_out.type = T_FILE;
+    node_out.nlink = 1;
+    node_out.size = size;
+    _touch(node_out, TIME_ATIME | TIME_MTIME | TIME_CTIME);
+    blocks_out.clear();
+    if (size <= INLINE_DATA_MAX) {
+        node_out.flags = INODE_FLAG_INLINE;
+        std::memcpy(node_out.addrs, data.data(), size);
+        return 0;
+    }
+
+    int nblocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int needed = 0;
+    for (int b = 0; b < nblocks; b++) {
+        needed += bulk_chunk_is_zero(data, b) ? 0 : 1;
+    }
+    std::vector<BlockSpan> spans;
+    if (balloc_n(needed, goal, spans, false) < needed) {
+        std::cerr << "错误: 数据块不足 (需要 " << needed << " 个)" << std::endl;
+        for (const BlockSpan& span : spans) {
+            for (int b = 0; b < span.count; b++) {
+                bfree(span.start + b);
+            }
+        }
+        return -1;
+    }
+    size_t span_index = 0;
+    int span_offset = 0;
+    for (int b = 0; b < nblocks; b++) {
+        if (bulk_chunk_is_zero(data, b)) {
+            blocks_out.push_back(0);
+            continue;
+        }
+        node_out.addrs[b] = spans[span_index].start + span_offset;
+        blocks_out.push_back(node_out.addrs[b]);
+        if (++span_offset == spans[span_index].count) {
+            span_index++;
+            span_offset = 0;
+        }
+    }
+    return 0;
+}
+
+int MiniFS::bulkExport(int inum, HostNode& out)
+{
+    FSLock lock(fs_mutex);
+    dinode node;
+    if (!_get_inode(inum, node)) {
+        std::cerr << "错误: 无法读取i-节点 " << inum << std::endl;
+        return -1;
+    }
+    out.children.clear();
+    out.data.clear();
+
+    switch (node.type) {
+    case T_DIR: {
+        out.kind = HostNode::DIR_NODE;
+        int entries_count = node.size / sizeof(dirent);
+        dirent entries[BLOCK_SIZE / sizeof(dirent)];
+        if (!_read_dir_block(node, entries)) {
+            return -1;
+        }
+        for (int i = 0; i < entries_count; i++) {
+            if (std::strcmp(entries[i].name, ".") == 0 || std::strcmp(entries[i].name, "..") == 0) {
+                continue;
+            }
+            HostNode child;
+            child.name = entries[i].name;
+            if (bulkExport(entries[i].inum, child) != 0) {
+                return -1;
+            }
+            out.children.push_back(child);
+        }
+        std::sort(out.children.begin(), out.children.end(),
+                  [](const HostNode& a, const HostNode& b) { return a.name < b.name; });
+        return 0;
+    }
+    case T_FILE:
+        out.kind = HostNode::FILE_NODE;
+        out.size = node.size;
+        out.data.resize(node.size);
+        if (node.size > 0 && _readi(inum, node, &out.data[0], 0, node.size) != node.size) {
+            std::cerr << "错误: 读取文件 (inum " << inum << ") 失败" << std::endl;
+            return -1;
+        }
+        return 0;
+    case T_SYMLINK:
+        out.kind = HostNode::SYMLINK_NODE;
+        return _read_symlink(node, out.data) ? 0 : -1;
+    default:
+        std::cerr << "错误: i-节点 " << inum << " 类型未知 (" << node.type << ")" << std::endl;
+        return -1;
+    }
+}
+
+// 节点占用的数据块个数 (内联数据不占块)；out 非空时追加块号
+int MiniFS::_inode_blocks(const dinode& node, std::vector<int>* out)
+{
+    bool inline_data = (node.type == T_SYMLINK && node.size <= SYMLINK_INLINE_MAX) ||
+                       (node.flags & INODE_FLAG_INLINE);
+    int count = 0;
+    for (int i = 0; i < 8 && !inline_data; i++) {
+        if (node.addrs[i] != 0) {
+            count++;
+            if (out) {
+                out->push_back(node.addrs[i]);
+            }
+        }
+    }
+    if (node.csum_block != 0) {
+        count++;
+        if (out) {
+            out->push_back(node.csum_block);
+        }
+    }
+    return count;
+}
+
+int MiniFS::removeTree(int parent_dir_inum, const char* name)
+{
+    FSLock lock(fs_mutex);
+    dinode parent;
+    if (!_get_inode(parent_dir_inum, parent) || parent.type != T_DIR) {
+        std::cerr << "错误: i-节点 " << parent_dir_inum << " 不是目录" << std::endl;
+        return -1;
+    }
+    if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+        std::cerr << "错误: 不能删除 '" << name << "'" << std::endl;
+        return -1;
+    }
+    int entries_count = parent.size / sizeof(dirent);
+    dirent entries[BLOCK_SIZE / sizeof(dirent)];
+    _read_dir_block(parent, entries);
+    int target_index = _find_dir_entry(entries, entries_count, name);
+    if (target_index == -1) {
+        std::cerr << "错误: '" << name << "' 不存在" << std::endl;
+        return -1;
+    }
+    int target_inum = entries[target_index].inum;
+    dinode target;
+    if (!_get_inode(target_inum, target)) {
+        std::cerr << "错误: 无法读取 '" << name << "' 的i-节点" << std::endl;
+        return -1;
+    }
+    if (target.type != T_DIR) {
+        return unlink(parent_dir_inum, name) == 0 ? 1 : -1; // 单个文件: 与 unlink 相同
+    }
+
+    // 1. 收集: 子树中的目录全部释放；其他i-节点统计子树内的链接数
+    std::vector<int> dirs;
+    std::vector<int> others;
+    std::vector<int> links_inside(INODE_NUM, 0);
+    std::vector<int> stack(1, target_inum);
+    while (!stack.empty()) {
+        int inum = stack.back();
+        stack.pop_back();
+        dirs.push_back(inum);
+        dinode dir;
+        dirent sub[BLOCK_SIZE / sizeof(dirent)];
+        if (!_get_inode(inum, dir) || !_read_dir_block(dir, sub)) {
+            std::cerr << "错误: 无法读取目录 (inum " << inum << ")，未做任何修改" << std::endl;
+            return -1;
+        }
+        int n = dir.size / sizeof(dirent);
+        for (int i = 0; i < n; i++) {
+            if (std::strcmp(sub[i].name, ".") == 0 || std::strcmp(sub[i].name, "..") == 0) {
+                continue;
+            }
+            dinode child;
+            if (!_get_inode(sub[i].inum, child)) {
+                continue;
+            }
+            if (child.type == T_DIR) {
+                stack.push_back(sub[i].inum);
+            } else if (links_inside[sub[i].inum]++ == 0) {
+                others.push_back(sub[i].inum);
+            }
+        }
+    }
+
+    // 2. 决定每个i-节点的去留，收集要释放的块
+    std::vector<int> free_blocks;
+    std::vector<int> free_inums;
+    std::vector<std::pair<int, dinode> > updated;
+    int orphans = 0;
+    for (int inum : dirs) {
+        dinode dir;
+        _get_inode(inum, dir);
+        _inode_blocks(dir, &free_blocks);
+        free_inums.push_back(inum);
+    }
+    for (int inum : others) {
+        dinode node;
+        _get_inode(inum, node);
+        node.nlink = static_cast<int16_t>(std::max(0, node.nlink - links_inside[inum]));
+        _touch(node, TIME_CTIME);
+        if (node.nlink > 0) {
+            updated.push_back(std::make_pair(inum, node));
+        } else if (_open_refs(inum) > 0) {
+            updated.push_back(std::make_pair(inum, node));
+            orphans++;
+        } else {
+            _inode_blocks(node, &free_blocks);
+            free_inums.push_back(inum);
+        }
+    }
+
+    // 3. 父目录去掉该项，块和i-节点成批释放
+    if (target_index < entries_count - 1) {
+        entries[target_index] = entries[entries_count - 1];
+    }
+    parent.size -= sizeof(dirent);
+    if (parent.nlink > 2) {
+        parent.nlink--;
+    }
+    _write_dir_block(parent, entries);
+    updated.push_back(std::make_pair(parent_dir_inum, parent));
+    _write_inodes(updated);
+    bfree_n(free_blocks);
+    ifree_n(free_inums);
+    if (orphans > 0) {
+        _adjust_orphan_count(orphans);
+    }
+    std::cout << "成功删除 '" << name << "': 释放 " << free_inums.size() << " 个i-节点, "
+              << free_blocks.size() << " 个数据块" << std::endl;
+    return static_cast<int>(free_inums.size());
+}
+
+int MiniFS::copyTree(int src_inum, int dest_dir_inum, const char* name)
+{
+    FSLock lock(fs_mutex);
+    if (strlen(name) == 0 || strlen(name) >= DIRSIZ) {
+        std::cerr << "错误: 名称长度必须在 1 到 " << DIRSIZ - 1 << " 之间" << std::endl;
+        return -1;
+    }
+    if (_lookup_in_directory(dest_dir_inum, name) != INVALID_INUM_CONST) {
+        std::cerr << "错误: '" << name << "' 已存在" << std::endl;
+        return -1;
+    }
+    // 不能复制到自身的子树中: 沿 .. 从目标目录向上检查
+    for (int cur = dest_dir_inum; ; ) {
+        if (cur == src_inum) {
+            std::cerr << "错误: 不能把目录复制到它自身的子目录中" << std::endl;
+            return -1;
+        }
+        int up = _lookup_in_directory(cur, "..");
+        if (cur == ROOT_INUM_CONST || up == INVALID_INUM_CONST || up == cur) {
+            break;
+        }
+        cur = up;
+    }
+    HostNode wrapper;
+    wrapper.kind = HostNode::DIR_NODE;
+    wrapper.children.push_back(HostNode());
+    if (bulkExport(src_inum, wrapper.children[0]) != 0) {
+        return -1;
+    }
+    wrapper.children[0].name = name;
+    return bulkImport(wrapper, dest_dir_inum);
+}
+
+int MiniFS::diskUsage(int inum, DiskUsage& out)
+{
+    out.files = 0;
+    out.dirs = 0;
+    out.symlinks = 0;
+    out.bytes = 0;
+    out.blocks = 0;
+    dinode top;
+    if (!_get_inode(inum, top)) {
+        std::cerr << "错误: 无法读取i-节点 " << inum << std::endl;
+        return -1;
+    }
+    std::atomic<long> files(0), dirs(0), symlinks(0), blocks(_inode_blocks(top, nullptr));
+    std::atomic<long long> bytes(top.type == T_DIR ? 0 : top.size);
+    if (top.type == T_FILE) {
+        files++;
+    } else if (top.type == T_SYMLINK) {
+        symlinks++;
+    } else {
+        std::vector<std::atomic<bool> > seen(INODE_NUM);
+        for (std::atomic<bool>& s : seen) {
+            s = false;
+        }
+        walkTree(inum, [&](int, const std::string&, int child, const dinode& node) {
+            if (seen[child].exchange(true)) {
+                return; // 硬链接只计一次
+            }
+            blocks += _inode_blocks(node, nullptr);
+            if (node.type == T_DIR) {
+                dirs++;
+                return;
+            }
+            bytes += node.size;
+            if (node.type == T_SYMLINK) {
+                symlinks++;
+            } else {
+                files++;
+            }
+        });
+    }
+    out.files = files;
+    out.dirs = dirs;
+    out.symlinks = symlinks;
+    out.bytes = bytes;
+    out.blocks = blocks;
     return 0;
 }
 
@@ -1742,16 +4413,19 @@ const User& MiniFS::getCurrentUser() const {
 
 // 保存用户数据
 bool MiniFS::saveUserData() {
+    FSLock lock(fs_mutex);
     return userManager.saveUsersToFS(this); // 将 this 指针传递给 UserManager
 }
 
 // 加载用户数据
 bool MiniFS::loadUserData() {
+    FSLock lock(fs_mutex);
     return userManager.loadUsersFromFS(this); // 将 this 指针传递给 UserManager
 }
 
 // 格式化时保留用户
 void MiniFS::formatWithUserPreservation() {
+    FSLock lock(fs_mutex);
     // 1. 保存当前用户数据
     std::string users_data_str = userManager.getUsersDataString();
 
@@ -3,13 +3,24 @@
 #include <iomanip> // std::setw 要用这个头文件
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <memory>
 #include <cstring>
 #include <sstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
 #include "user.hpp" // 包含完整的 user.hpp
+#include "crc32c.hpp"
+#include "host_io.hpp"
+#include "block_device.hpp"
 
 typedef unsigned char Byte;
 //位图块定义
@@ -31,13 +42,30 @@ constexpr int INODE_START = DATA_BITMAP_BLOCK_START + DATA_BITMAP_BLOCK_COUNT; /
 constexpr int DATA_START = (INODE_START + INODE_BLOCKS); //数据区域的起始块号， 总块号-起始块号就是数据块数量：1024-17，即1007，对应1007bit，需要126字节
 constexpr int DATA_BLOCKS_NUM = BLOCK_COUNT - DATA_START;
 constexpr int DIRSIZ = 28; //目录项中文件名的最大长度
+constexpr int BACKING_CHUNK_BLOCKS = 32; //读写镜像文件时单个请求的最大块数 (16KB)
 
 
 
+// 超级块标识与特性标志
+constexpr int FS_MAGIC = 0x3153464D; // "MFS1"，旧版镜像没有该字段
+constexpr int FS_FEATURE_META_CSUM = 0x0001; // 元数据CRC32C校验
+
 // 文件类型常量
 constexpr int T_FREE = 0;
 constexpr int T_FILE = 1; //该i节点表示文件
 constexpr int T_DIR  = 2; //该i节点表示目录
+constexpr int T_SYMLINK = 3; //该i节点表示符号链接
+
+// 内联数据: 带 INODE_FLAG_INLINE 的小文件把内容直接存放在 addrs 区域，不占用数据块；
+// 写入超过 INLINE_DATA_MAX 字节时迁出到数据块
+constexpr int INLINE_DATA_MAX = 8 * sizeof(int);
+constexpr uint8_t INODE_FLAG_INLINE = 0x01;
+
+// 符号链接: 目标不超过 SYMLINK_INLINE_MAX 字节时直接存放在 addrs 区域 (快速符号链接)，
+// 否则占用一个数据块；解析路径时最多跟随 MAX_SYMLINK_FOLLOW 次
+constexpr int SYMLINK_INLINE_MAX = INLINE_DATA_MAX;
+constexpr int SYMLINK_MAX = BLOCK_SIZE - 1;
+constexpr int MAX_SYMLINK_FOLLOW = 8;
 
 // 超级块结构体
 //初始化用上面预先设定好的常量constexpr
@@ -50,6 +78,11 @@ struct superblock {
     //记录新增的位图的信息
     int inode_bitmap_start_block;
     int data_bitmap_start_block;
+    int magic;          // FS_MAGIC
+    int features;       // 特性标志位 (FS_FEATURE_*)
+    uint32_t sb_csum;   // 超级块所在块的CRC32C (计算时本字段按0处理)
+    uint32_t meta_csum[DATA_START]; // 固定元数据块(位图块、i-节点块)的CRC32C，下标为块号，[0]不使用
+    int orphan_count;   // 链接数已为0、等待最后一次关闭才释放的i-节点个数
 };
 
 // 磁盘i-节点结构体
@@ -58,22 +91,56 @@ struct dinode {
     int16_t nlink;      // 链接数
     int size;           // 文件大小
     int addrs[8];       // 数据块指针
+    uint32_t dir_csum;  // 目录: 目录数据块的CRC32C
+    int csum_block;     // 文件: 数据校验和边车块 (按块下标存放各数据块的CRC32C)，0 表示未启用
+    uint8_t flags;      // INODE_FLAG_*，旧版镜像中为0
+    uint8_t unwritten;  // 文件: 已分配但尚未写入的块 (位 i 对应 addrs[i])，读取时按全0处理
+    uint8_t reserved[2];
+    // 时间戳 (Unix 时间，秒)。旧版镜像中为0 (未知)：旧版只写前面的字段，i-节点槽位的其余字节保持格式化时的0
+    uint32_t atime;     // 最后访问 (按 atime 策略更新，见 MiniFS::AtimePolicy)
+    uint32_t mtime;     // 内容最后修改 (文件数据、目录项)
+    uint32_t ctime;     // i-节点最后改变 (内容、链接数、属性)
 };
+static_assert(sizeof(superblock) <= BLOCK_SIZE, "superblock 必须能放进一个块");
+static_assert(sizeof(dinode) <= INODE_SIZE, "dinode 不能超过 INODE_SIZE");
+static_assert(offsetof(dinode, atime) == 52, "时间戳的位置是镜像格式的一部分");
+// 把i-节点时间戳格式化为本地时间 "YYYY-MM-DD HH:MM:SS"，0 (旧版镜像，未知) 显示为 "-"
+std::string formatTimestamp(uint32_t t);
 
 // 目录项结构体,目录就是一堆dirent结构体，组成的链表
+// 旧版镜像的 inum 为 int：小端序下低两字节就是 inum，高两字节为0，读出的 type 为0 (未知，需读i-节点)
 struct dirent {
     //形成(inum, name)对
-    int inum;           // i-节点号
+    int16_t inum;       // i-节点号
+    uint8_t type;       // 所指i-节点的类型 (T_FILE/T_DIR/T_SYMLINK)，0 表示未知
+    uint8_t reserved;
     char name[DIRSIZ];  // 文件名
 };
+static_assert(sizeof(dirent) == 32, "dirent 的大小决定每个目录块的项数，不能改变");
+static_assert(INODE_NUM <= INT16_MAX, "dirent::inum 为 16 位");
 
 // 文件系统类
+class WorkStealingPool; // 见 work_stealing.hpp
+
 class MiniFS {
 public:
     static const int O_RDONLY = 0x0001; // 只读  对应01
     static const int O_WRONLY = 0x0002; // 只写  对应10
     static const int O_RDWR   = 0x0003; // 读写 (O_RDONLY | O_WRONLY)  对应00
     static const int O_CREATE = 0x0100; // 如果不存在则创建
+    static const int O_TRUNC  = 0x0200; // 以可写方式打开时把文件截断为0
+    static const int O_APPEND = 0x0400; // 每次写入前把位置移到文件末尾
+
+    // lseek 的 whence (不直接使用 <cstdio> 的 SEEK_* 宏名)
+    static const int LSEEK_SET  = 0;
+    static const int LSEEK_CUR  = 1;
+    static const int LSEEK_END  = 2;
+    static const int LSEEK_DATA = 3; // 从 offset 起第一个有数据的位置
+    static const int LSEEK_HOLE = 4; // 从 offset 起第一个空洞的位置 (文件末尾视为空洞)
+
+    // fallocate 的 mode
+    static const int FALLOC_KEEP_SIZE  = 0x01; // 预分配但不改变文件大小
+    static const int FALLOC_PUNCH_HOLE = 0x02; // 打洞: 释放范围内的整块，部分覆盖的块清零 (隐含 KEEP_SIZE)
 
 
     enum class FSStatus { OK, FAIL, CORRUPT, NOT_FOUND };
@@ -89,12 +156,75 @@ public:
     
     void readBlock(int blockNum, void* buf);
     void writeBlock(int blockNum, const void* buf);
+    // 不加锁写入已分配的数据块，供批量导入的写块线程并行使用；
+    // 调用者保证该块已分配，且没有其他线程同时读写同一块
+    void writeDataBlockDirect(int blockNum, const void* buf);
     int saveFS(const std::string& filename);
+    // 增量写回: 只把上次加载/写回以来改动过的块写入镜像文件 (经块设备批量异步提交)，并落盘；
+    // 目标不是已打开的镜像时整体写入。返回写出的块数，失败返回-1
+    int syncFS(const std::string& filename);
+    BlockDevice::Stats getBackingStats() const; // 镜像文件块设备的累计请求统计
+    const char* backingDeviceName() const;       // "io_uring"/"pread"，尚未打开镜像时为空串
     FSStatus loadFS(const std::string& filename);
     void format();
     int mkdir(int parent_dir_inum, const char* name); // 创建目录的核心实现
     void listDir(int dir_inum);                       // 列出指定inum目录的内容
     void listRoot();                                  // 列出根目录内容
+
+    // 目录游标: opendir 读入一次目录块作为快照，readdir 逐项返回 (名字, i-节点号, 类型)，
+    // 类型取自目录项本身，不读i-节点 (旧版镜像的目录项没有类型时才读)；包含 . 和 ..
+    struct DirEntry {
+        int inum;
+        int type;            // T_FILE / T_DIR / T_SYMLINK
+        std::string name;
+    };
+    struct DirCursor {
+        int dir_inum;
+        size_t pos;                  // 下一项的下标，可以保存后赋回以继续读取 (telldir/seekdir)
+        std::vector<dirent> entries; // 打开时的目录项
+    };
+    int opendir(int dir_inum, DirCursor& cursor);   // 成功返回0，不是目录返回-1
+    bool readdir(DirCursor& cursor, DirEntry& out); // 读到末尾返回 false
+    // 一次返回目录的全部项及其i-节点: 按i-节点所在块分组，每个i-节点块只读一次
+    struct DirEntryPlus {
+        DirEntry entry;
+        dinode attr;
+    };
+    int readdirplus(int dir_inum, std::vector<DirEntryPlus>& out); // 返回项数，失败返回-1
+
+    // 文件属性 (对应 POSIX stat 的常用字段)，由内存中的属性缓存返回: 同一i-节点块中的属性
+    // 第一次查询时一起解码，之后不再读块；i-节点写回时缓存随之更新
+    struct FileStat {
+        int st_ino;
+        int st_type;      // T_FILE / T_DIR / T_SYMLINK
+        int st_nlink;
+        int st_size;      // 字节数，符号链接为目标长度
+        int st_blocks;    // 占用的块数 (含数据校验边车块，内联数据不占块)
+        int st_blksize;   // BLOCK_SIZE
+        // 时间戳 (秒)；不叫 st_atime 等，它们在 <sys/stat.h> 中是宏
+        uint32_t st_atim;
+        uint32_t st_mtim;
+        uint32_t st_ctim;
+    };
+    int statInode(int inum, FileStat& st); // 成功返回0，i-节点无效或空闲返回-1
+    int stat(const std::string& path, FileStat& st, int base_inum = ROOT_INUM_CONST);  // 跟随符号链接
+    int lstat(const std::string& path, FileStat& st, int base_inum = ROOT_INUM_CONST); // 返回链接本身
+    int fstat(int fd, FileStat& st);
+    // 设置访问/修改时间 (同步工具还原时间戳用)，ctime 设为当前时间
+    int setTimes(int inum, uint32_t atime, uint32_t mtime);
+
+    // 访问时间的更新策略 (对应挂载选项 strictatime / relatime / noatime)，默认 RELATIME
+    // 无论哪种策略，读取都不立即写i-节点块: 新的访问时间暂存在内存中，
+    // 由 flushTimes (syncFS/saveFS 时自动调用) 按i-节点块成批写回
+    enum class AtimePolicy {
+        STRICT,     // 每次读取都更新
+        RELATIME,   // 访问时间不晚于修改/改变时间，或已超过一天时才更新
+        NOATIME     // 从不更新
+    };
+    void setAtimePolicy(AtimePolicy policy);
+    AtimePolicy getAtimePolicy() const;
+    int pendingTimes() const;  // 尚未写回的访问时间个数
+    int flushTimes();          // 写回暂存的访问时间，返回写回的i-节点个数
     int checkFSConsistency();
 
 
@@ -102,40 +232,174 @@ public:
     void set_bit(int bitmap_block_start, int index);
     void clear_bit(int bitmap_block_start, int index);
     bool test_bit(int bitmap_block_start, int index);
+    int countFreeBlocks(); // 数据位图中空闲的数据块个数
     int find_free_bit(int bitmap_block_start, int total_bits, int min_allowed_index = 0);
     
-    int balloc();
+    int balloc(bool zero); // zero 为 false 时不清零新块，由调用者保证读前先写 (见 dinode::unwritten)
     void bfree(int absolute_block_num);
     int ialloc(int16_t type);
     void ifree(int inum);
 
+    // 批量分配: 一次读写位图完成，尽量返回连续的区间
+    struct BlockSpan {
+        int start;  // 起始绝对块号
+        int count;  // 连续块数
+    };
+    // 从 goal (绝对块号，0 表示不指定) 开始向后找，绕回数据区开头；返回实际分配的块数
+    int balloc_n(int count, int goal, std::vector<BlockSpan>& out_spans, bool zero = true);
+    // 分配 count 个同类型的i-节点，返回实际分配的个数
+    int ialloc_n(int count, int16_t type, std::vector<int>& out_inums);
+    // 批量释放: 排序后每个位图块 (i-节点块) 读写一次
+    void bfree_n(std::vector<int>& blocks);
+    void ifree_n(std::vector<int>& inums);
+
     // 路径解析功能
-    int resolve_path_to_inum(const std::string& path, int base_inum = ROOT_INUM_CONST);
+    // follow_last 为 false 时不跟随最后一个组件的符号链接 (用于操作链接本身)
+    int resolve_path_to_inum(const std::string& path, int base_inum = ROOT_INUM_CONST, bool follow_last = true);
     bool _get_inode(int inum, dinode& node_out);
+    void _write_inode(int inum, const dinode& node);
+    void _write_inodes(std::vector<std::pair<int, dinode> >& nodes); // 按块成批写回，每个i-节点块读写一次
     int _lookup_in_directory(int dir_inum, const std::string& name);    //create
+
+    // 目录数据块读写 (带CRC32C校验)
+    bool _read_dir_block(const dinode& dir, dirent* entries);
+    void _write_dir_block(dinode& dir, const dirent* entries); // 会更新 dir.dir_csum，调用者负责写回i-节点
+
+    // 元数据校验和
+    struct ChecksumStats {
+        long verified;      // 已校验的块数
+        long failures;      // 校验失败的块数
+        long data_failures; // 文件数据块校验失败次数 (read 与 scrub)
+    };
+    ChecksumStats getChecksumStats() const;
+    int verifyAllMetadata();          // 立即校验全部元数据，返回失败的块数
+    void rebuildMetadataChecksums();  // 按当前内容重新生成全部元数据校验和
+
+    // 文件数据校验和 (可选，按文件开启)
+    int setDataChecksums(int inum, bool enable); // 成功返回0，失败返回-1
+
+    // 后台巡检 (scrub): 按速率限制遍历镜像，校验文件数据块和元数据
+    struct ScrubStats {
+        long passes;       // 完成的完整遍历次数
+        long files;        // 已校验的文件数
+        long blocks;       // 已校验的数据块数
+        long mismatches;   // 发现的不匹配块数
+        bool running;      // 后台线程是否在运行
+    };
+    int scrubOnce();                          // 同步执行一次完整巡检 (按文件并行)，返回不匹配块数
+    bool startScrubber(int blocks_per_sec = 256);
+    void stopScrubber();
+    ScrubStats getScrubStats() const;
+
+    // 并行遍历 dir_inum 下的整棵目录树: 每个目录一个任务，在内部线程池上执行，不跟随符号链接
+    // visit 对每个目录项 (不含 . 和 ..) 调用一次，可能在多个线程上并发调用，调用时不持有文件系统的锁
+    // 调用者不能持有文件系统的锁。返回访问的目录项数，dir_inum 不是目录时返回-1
+    typedef std::function<void(int parent_inum, const std::string& name, int inum, const dinode& node)> TreeVisitor;
+    long walkTree(int dir_inum, const TreeVisitor& visit);
+    int workerThreads();                      // 内部线程池的线程数
+
+    // 递归删除 parent_dir_inum 下的 name (文件或整棵目录树): 先收集全部要释放的块和i-节点，
+    // 再排序后成批清除位图、成批写回i-节点，父目录块只写一次；返回释放的i-节点个数，失败返回-1
+    // 子树外还有硬链接或仍被打开的文件只减少链接数 (后者成为孤儿，最后一次关闭时释放)
+    int removeTree(int parent_dir_inum, const char* name);
+    // 把 src_inum (文件/目录/符号链接) 整棵复制为 dest_dir_inum 下的 name: 读出子树后
+    // 用批量导入一次性分配全部i-节点和数据块；返回新建的i-节点个数，失败返回-1 (镜像不变)
+    int copyTree(int src_inum, int dest_dir_inum, const char* name);
+    // 统计 inum 子树的空间占用 (目录按目录并行遍历，硬链接只计一次)
+    struct DiskUsage {
+        long files;
+        long dirs;         // 不含 inum 自身
+        long symlinks;
+        long long bytes;   // 文件与符号链接的逻辑大小之和
+        long blocks;       // 占用的数据块 (含目录块与数据校验边车块)
+    };
+    int diskUsage(int inum, DiskUsage& out);
+
+    // 块I/O计数 (按块号区分元数据区与数据区)
+    struct IOStats {
+        long meta_reads;
+        long meta_writes;
+        long data_reads;
+        long data_writes;
+        long readahead_fills;  // 顺序读时一次读入整个预读窗口的次数
+        long readahead_hits;   // 直接从预读缓冲区返回的读取次数
+        long attr_cache_hits;   // 由属性缓存返回的 stat 次数
+        long attr_cache_misses; // 需要读i-节点块的 stat 次数
+    };
+    IOStats getIOStats() const;
     
     
     // 文件描述符结构体
     struct file_descriptor {
         int inum;          // 关联的i-节点号
-        int mode;          // 打开模式(O_RDONLY, O_WRONLY, O_RDWR)
+        int mode;          // 打开模式(O_RDONLY, O_WRONLY, O_RDWR, 可带 O_APPEND)
         int position;      // 当前文件读写位置
         bool is_used;      // 文件描述符是否在使用中
+
+        // 顺序读预读 (见 _read_with_readahead)
+        int ra_next;       // 上次读取的结束位置，从这里继续读视为顺序读
+        int ra_window;     // 当前预读窗口 (块数)，0 表示不在顺序读状态
+        int ra_start;      // 预读缓冲区对应的文件偏移
+        int ra_len;        // 预读缓冲区中的有效字节数，0 表示为空
+        bool ra_eof;       // 缓冲区一直读到了文件末尾
+        long ra_epoch;     // 填充时的块写入计数，之后有任何块被写入则缓冲区作废
+        std::vector<char> ra_buf;
     };
     
     // 文件操作函数
     int create(int parent_dir_inum, const char* name);
     int open(int parent_dir_inum, const char* name, int flags);
+    int openInode(int inum, int flags); // 按i-节点号打开普通文件，不解析路径也不跟随符号链接
     int close(int fd);
     int read(int fd, void* buf, int count);
     int write(int fd, const void* buf, int count);
 
+    // 稀疏文件: 空洞 (addrs[i] == 0) 读出为0且不占用数据块
+    int pread(int fd, void* buf, int count, int offset); // 从指定偏移读取，不改变文件位置
+    bool tryReadCached(int fd, void* buf, int count, int offset, int& result); // 只读预读缓冲区，不读块不等锁
+    int pwrite(int fd, const void* buf, int count, int offset); // 在指定偏移写入，不改变文件位置
+    int lseek(int fd, int offset, int whence);           // 返回新的文件位置，失败返回-1
+    int fallocate(int fd, int mode, int offset, int length);
+
     // 删除目录
     int rmdir(int parent_dir_inum, const char* name);
     
     // 删除文件
     int rm(int parent_dir_inum, const char* name);
 
+    // 硬链接: link 为已有文件增加一个名字，unlink 删除一个名字；
+    // 链接数降为0且没有打开的文件描述符时才释放文件
+    int link(int old_inum, int new_dir_inum, const char* name);
+    int unlink(int parent_dir_inum, const char* name);
+
+    // 截断/扩展文件到 length 字节: 缩小时释放尾部数据块，扩展部分为空洞
+    int truncate(int inum, int length);
+    int ftruncate(int fd, int length);
+
+    // 重命名/移动: 目标已存在时原子地替换 (目标为目录时必须为空)，移动目录会更新其 ..
+    int rename(int src_dir_inum, const char* src_name, int dst_dir_inum, const char* dst_name);
+
+    // 符号链接: symlink 创建，readlink 读取链接目标 (返回目标长度，失败返回-1)
+    int symlink(int parent_dir_inum, const char* name, const char* target);
+    int readlink(int inum, std::string& target_out);
+
+    // 批量导入/导出 (离线建镜像): 先检查整棵树并一次性分配全部i-节点和数据块，
+    // i-节点按目录逐层连续编号，文件数据块连续，目录块在内存中拼好后各写一次
+    // bulkImport 把 tree 的子项导入到 dest_dir_inum 目录下，返回新建的i-节点个数；
+    // 超出镜像限制时返回-1，且不修改镜像
+    // deferred_files 非空时允许未加载内容的文件 (data 为空、size > 0): 只为其分配i-节点 (大小为0)，
+    // 内容由调用者随后用 bulkLayoutFile 分配数据块、写数据块并写回i-节点 (见 import_pipeline)
+    struct BulkFile {
+        const HostNode* node;
+        int inum;
+    };
+    int bulkImport(const HostNode& tree, int dest_dir_inum, std::vector<BulkFile>* deferred_files = nullptr);
+    // 为内容为 data 的文件生成i-节点: 内联或从 goal 开始分配数据块 (全0块为空洞)，
+    // blocks_out[i] 为第 i 块的块号 (空洞为0)；只分配不写盘，失败返回-1
+    int bulkLayoutFile(const std::string& data, int goal, dinode& node_out, std::vector<int>& blocks_out);
+    // bulkExport 把 inum 对应的文件/目录/符号链接子树读成 HostNode 树，成功返回0
+    int bulkExport(int inum, HostNode& out);
+
     // 用户登录
     bool login(const std::string& username, const std::string& password);
 
@@ -168,9 +432,114 @@ public:
 
 private:
     std::vector<Byte> disk;
+
+    // 镜像文件的块设备 (loadFS/syncFS 打开后保持)，及相对它改动过的块 (每块一个字节，可并发置位)
+    std::unique_ptr<BlockDevice> backing;
+    std::string backing_path;
+    std::vector<uint8_t> dirty_blocks;
+
+    // 元数据校验状态: 每个块在首次读取时校验一次
+    bool meta_csum_enabled;
+    std::vector<bool> csum_verified;
+    long csum_verified_count;
+    long csum_failure_count;
+    void _verify_meta_block(int blockNum);
+    void _note_meta_write(int blockNum);
+    void _seal_superblock();
+
+    // 目录项与i-节点生命周期
+    int _find_dir_entry(const dirent* entries, int entries_count, const char* name);
+    int _add_dir_entry(int dir_inum, const char* name, int inum);
+    bool _read_symlink(const dinode& node, std::string& target_out);
+    int _readi(int inum, const dinode& node, char* dst, int offset, int count);
+    int _read_with_readahead(int fd, char* dst, int offset, int count);
+    int _read_from_readahead(file_descriptor& f, char* dst, int offset, int count);
+    bool _spill_inline(dinode& node);
+    int _open_refs(int inum);
+    void _release_inode(int inum, const dinode& node);
+    int _reclaim_orphans();
+    int _alloc_bit_runs(int bitmap_block_start, int bitmap_blocks, int total_bits, int min_index,
+                        int count, int goal, std::vector<BlockSpan>& out_runs);
+    void _adjust_orphan_count(int delta);
+
+    // 批量导入
+    bool _bulk_plan(const HostNode& dir, int& inodes_needed, int& blocks_needed, int& deferred_blocks);
+    int _bulk_build_children(const HostNode& dir, int dir_inum, dirent* entries, int first_slot,
+                             const std::vector<int>& inums, size_t& next_inum,
+                             const std::vector<int>& blocks, size_t& next_block,
+                             std::vector<std::pair<int, dinode> >& inodes_out,
+                             std::vector<BulkFile>* deferred_files);
+
+    // 整个文件系统一把递归锁: 公有操作进入时加锁，内部互相调用可重入
+    typedef std::lock_guard<std::recursive_mutex> FSLock;
+    mutable std::recursive_mutex fs_mutex;
+
+    // 数据校验与巡检
+    std::atomic<long> data_csum_failure_count;
+    int _scrub_file(int inum, long& blocks_checked);
+    void _free_bits(int bitmap_block_start, int bitmap_blocks, std::vector<int>& bits);
+    int _inode_blocks(const dinode& node, std::vector<int>* out);
+    void _scrubber_main(int blocks_per_sec);
+    std::thread scrub_thread;
+    mutable std::mutex scrub_mutex;
+    std::condition_variable scrub_cv;
+    bool scrub_stop;
+    std::atomic<long> scrub_passes;
+    std::atomic<long> scrub_files;
+    std::atomic<long> scrub_blocks;
+    std::atomic<long> scrub_mismatches;
+
+    // 块I/O计数
+    std::atomic<long> io_meta_reads;
+    std::atomic<long> io_meta_writes;
+    std::atomic<long> io_data_reads;
+    std::atomic<long> io_data_writes;
+    std::atomic<long> io_readahead_fills;
+    std::atomic<long> io_readahead_hits;
+    std::atomic<long> io_attr_cache_hits;
+    std::atomic<long> io_attr_cache_misses;
+
+    // i-节点属性缓存: 只保存 stat 需要的字段，按i-节点块整块解码 (每块一个有效标志)；
+    // writeBlock 写i-节点块时从新内容重新解码，加载镜像时全部作废
+    struct CachedAttr {
+        int16_t type;
+        int16_t nlink;
+        int size;
+        int blocks;
+        uint32_t atime;
+        uint32_t mtime;
+        uint32_t ctime;
+    };
+    CachedAttr attr_cache[INODE_NUM];
+    bool attr_block_cached[INODE_BLOCKS];
+    void _decode_attr_block(int inode_block, const Byte* buf);
+    void _invalidate_attr_cache();
+
+    // 时间戳: 修改/改变时间随本来就要写回的i-节点一起写；访问时间按策略暂存在 pending_atime 中
+    // (0 表示没有)，读i-节点 (_get_inode、stat) 时叠加，写回i-节点或 flushTimes 时落盘
+    static const int TIME_ATIME = 0x1;
+    static const int TIME_MTIME = 0x2;
+    static const int TIME_CTIME = 0x4;
+    static const uint32_t RELATIME_INTERVAL = 24 * 60 * 60;
+    static uint32_t _now();
+    void _touch(dinode& node, int which);
+    void _touch_atime(int inum);
+    void _drop_pending_atime(int inum);
+    AtimePolicy atime_policy;
+    uint32_t pending_atime[INODE_NUM];
+    int pending_atime_count;
+
     // 文件描述符表
     static const int MAX_OPEN_FILES = 16;
+    // 预读窗口: 顺序读开始时为 MIN 块，之后每次翻倍，最多 MAX 块 (即最大文件大小)
+    static const int READAHEAD_MIN_BLOCKS = 2;
+    static const int READAHEAD_MAX_BLOCKS = 8;
     file_descriptor fd_table[MAX_OPEN_FILES];
+
+    // 内部工作窃取线程池 (巡检、目录树遍历等批量操作)，首次使用时创建；析构函数中最先停下
+    WorkStealingPool& _work_pool();
+    std::mutex work_pool_mutex;
+    std::unique_ptr<WorkStealingPool> work_pool;
 };
 
 #endif // MiniFS_HPP
@@ -0,0 +1,546 @@
+// MiniFS 的 FUSE 挂载前端 (libfuse3 低层 API)
+// 用法: minifs-fuse <镜像文件> <挂载点> [FUSE 选项...]
+//   -f 前台运行   -s 单线程分发   -d 调试输出   -o <挂载选项>
+// FUSE 的 inode 号直接使用 MiniFS 的i-节点号 (FUSE_ROOT_ID 与 ROOT_INUM_CONST 都是1)，
+// 各操作按i-节点号调用 MiniFS，不再经过路径解析。镜像在内存中修改，fsync 和卸载时把改动过的块写回镜像文件
+#include "minifs.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// minifs.hpp 的 O_* 常量与 <fcntl.h> 的宏同名，必须在包含 FUSE 头文件之前取出
+static const int MFS_O_RDONLY = MiniFS::O_RDONLY;
+static const int MFS_O_WRONLY = MiniFS::O_WRONLY;
+static const int MFS_O_RDWR = MiniFS::O_RDWR;
+static const int MFS_O_APPEND = MiniFS::O_APPEND;
+static const int MFS_O_TRUNC = MiniFS::O_TRUNC;
+
+#define FUSE_USE_VERSION 31
+#include <fuse_lowlevel.h>
+#include <unistd.h>
+
+namespace {
+
+struct FuseContext {
+    MiniFS fs;
+    std::string image;
+};
+
+// 内核对属性和目录项的缓存时间 (秒)。镜像只由本进程修改，缓存不会过期失效，
+// 但i-节点号会被复用 (没有 generation)，所以不设得太长
+const double ATTR_TIMEOUT = 1.0;
+const double ENTRY_TIMEOUT = 1.0;
+
+const int MAX_FILE_SIZE = 8 * BLOCK_SIZE; // 8 个直接块
+
+MiniFS& fsOf(fuse_req_t req) {
+    return static_cast<FuseContext*>(fuse_req_userdata(req))->fs;
+}
+
+void fillStat(const MiniFS::FileStat& attr, struct stat& st) {
+    std::memset(&st, 0, sizeof(st));
+    st.st_ino = static_cast<ino_t>(attr.st_ino);
+    st.st_nlink = attr.st_nlink;
+    st.st_size = attr.st_size;
+    st.st_blksize = attr.st_blksize;
+    st.st_blocks = attr.st_blocks * (BLOCK_SIZE / 512);
+    st.st_atim.tv_sec = attr.st_atim;
+    st.st_mtim.tv_sec = attr.st_mtim;
+    st.st_ctim.tv_sec = attr.st_ctim;
+    switch (attr.st_type) {
+    case T_DIR:
+        st.st_mode = S_IFDIR | 0755;
+        break;
+    case T_SYMLINK:
+        st.st_mode = S_IFLNK | 0777;
+        break;
+    default:
+        st.st_mode = S_IFREG | 0644;
+        break;
+    }
+    // MiniFS 没有属主信息，挂载后显示为挂载者所有
+    st.st_uid = getuid();
+    st.st_gid = getgid();
+}
+
+// getattr/lookup 走属性缓存，不读i-节点块
+bool statInode(MiniFS& fs, int inum, struct stat& st) {
+    MiniFS::FileStat attr;
+    if (fs.statInode(inum, attr) != 0) {
+        return false;
+    }
+    fillStat(attr, st);
+    return true;
+}
+
+void replyEntry(fuse_req_t req, MiniFS& fs, int inum) {
+    struct fuse_entry_param e;
+    std::memset(&e, 0, sizeof(e));
+    if (!statInode(fs, inum, e.attr)) {
+        fuse_reply_err(req, EIO);
+        return;
+    }
+    e.ino = static_cast<fuse_ino_t>(inum);
+    e.attr_timeout = ATTR_TIMEOUT;
+    e.entry_timeout = ENTRY_TIMEOUT;
+    fuse_reply_entry(req, &e);
+}
+
+// MiniFS 失败时只返回-1，按常见原因推断 errno
+int createErrno(MiniFS& fs, fuse_ino_t parent, const char* name) {
+    if (std::strlen(name) >= static_cast<size_t>(DIRSIZ)) {
+        return ENAMETOOLONG;
+    }
+    dinode dir;
+    if (!fs._get_inode(static_cast<int>(parent), dir) || dir.type != T_DIR) {
+        return ENOTDIR;
+    }
+    if (fs._lookup_in_directory(static_cast<int>(parent), name) != MiniFS::INVALID_INUM_CONST) {
+        return EEXIST;
+    }
+    return ENOSPC;
+}
+
+int removeErrno(MiniFS& fs, fuse_ino_t parent, const char* name, bool want_dir) {
+    int inum = fs._lookup_in_directory(static_cast<int>(parent), name);
+    if (inum == MiniFS::INVALID_INUM_CONST) {
+        return ENOENT;
+    }
+    dinode node;
+    if (!fs._get_inode(inum, node)) {
+        return EIO;
+    }
+    if (want_dir && node.type != T_DIR) {
+        return ENOTDIR;
+    }
+    if (!want_dir && node.type == T_DIR) {
+        return EISDIR;
+    }
+    return want_dir ? ENOTEMPTY : EIO;
+}
+
+int toMiniFSFlags(int flags) {
+    int mode;
+    switch (flags & O_ACCMODE) {
+    case O_WRONLY:
+        mode = MFS_O_WRONLY;
+        break;
+    case O_RDWR:
+        mode = MFS_O_RDWR;
+        break;
+    default:
+        mode = MFS_O_RDONLY;
+        break;
+    }
+    if (flags & O_APPEND) {
+        mode |= MFS_O_APPEND;
+    }
+    if (flags & O_TRUNC) {
+        mode |= MFS_O_TRUNC;
+    }
+    return mode;
+}
+
+void mfsDestroy(void* userdata) {
+    FuseContext* ctx = static_cast<FuseContext*>(userdata);
+    ctx->fs.syncFS(ctx->image);
+}
+
+void mfsLookup(fuse_req_t req, fuse_ino_t parent, const char* name) {
+    MiniFS& fs = fsOf(req);
+    int inum = fs._lookup_in_directory(static_cast<int>(parent), name);
+    if (inum == MiniFS::INVALID_INUM_CONST) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+    replyEntry(req, fs, inum);
+}
+
+void mfsGetattr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
+    (void)fi;
+    struct stat st;
+    if (!statInode(fsOf(req), static_cast<int>(ino), st)) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+    fuse_reply_attr(req, &st, ATTR_TIMEOUT);
+}
+
+// 支持改变大小和访问/修改时间 (utimensat)；权限、属主 MiniFS 不保存，静默接受
+void mfsSetattr(fuse_req_t req, fuse_ino_t ino, struct stat* attr, int to_set, struct fuse_file_info* fi) {
+    (void)fi;
+    MiniFS& fs = fsOf(req);
+    if (to_set & FUSE_SET_ATTR_SIZE) {
+        if (fs.truncate(static_cast<int>(ino), static_cast<int>(attr->st_size)) != 0) {
+            fuse_reply_err(req, attr->st_size > MAX_FILE_SIZE ? EFBIG : ENOSPC);
+            return;
+        }
+    }
+    const int time_bits = FUSE_SET_ATTR_ATIME | FUSE_SET_ATTR_MTIME | FUSE_SET_ATTR_ATIME_NOW | FUSE_SET_ATTR_MTIME_NOW;
+    if (to_set & time_bits) {
+        MiniFS::FileStat cur;
+        if (fs.statInode(static_cast<int>(ino), cur) != 0) {
+            fuse_reply_err(req, ENOENT);
+            return;
+        }
+        uint32_t now = static_cast<uint32_t>(std::time(NULL));
+        uint32_t atime = (to_set & FUSE_SET_ATTR_ATIME_NOW) ? now
+                       : (to_set & FUSE_SET_ATTR_ATIME) ? static_cast<uint32_t>(attr->st_atim.tv_sec) : cur.st_atim;
+        uint32_t mtime = (to_set & FUSE_SET_ATTR_MTIME_NOW) ? now
+                       : (to_set & FUSE_SET_ATTR_MTIME) ? static_cast<uint32_t>(attr->st_mtim.tv_sec) : cur.st_mtim;
+        fs.setTimes(static_cast<int>(ino), atime, mtime);
+    }
+    struct stat st;
+    if (!statInode(fs, static_cast<int>(ino), st)) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+    fuse_reply_attr(req, &st, ATTR_TIMEOUT);
+}
+
+void mfsReadlink(fuse_req_t req, fuse_ino_t ino) {
+    std::string target;
+    if (fsOf(req).readlink(static_cast<int>(ino), target) < 0) {
+        fuse_reply_err(req, EINVAL);
+        return;
+    }
+    fuse_reply_readlink(req, target.c_str());
+}
+
+void mfsMkdir(fuse_req_t req, fuse_ino_t parent, const char* name, mode_t mode) {
+    (void)mode;
+    MiniFS& fs = fsOf(req);
+    int inum = fs.mkdir(static_cast<int>(parent), name);
+    if (inum < 0) {
+        fuse_reply_err(req, createErrno(fs, parent, name));
+        return;
+    }
+    replyEntry(req, fs, inum);
+}
+
+void mfsUnlink(fuse_req_t req, fuse_ino_t parent, const char* name) {
+    MiniFS& fs = fsOf(req);
+    if (fs.unlink(static_cast<int>(parent), name) != 0) {
+        fuse_reply_err(req, removeErrno(fs, parent, name, false));
+        return;
+    }
+    fuse_reply_err(req, 0);
+}
+
+void mfsRmdir(fuse_req_t req, fuse_ino_t parent, const char* name) {
+    MiniFS& fs = fsOf(req);
+    if (fs.rmdir(static_cast<int>(parent), name) != 0) {
+        fuse_reply_err(req, removeErrno(fs, parent, name, true));
+        return;
+    }
+    fuse_reply_err(req, 0);
+}
+
+void mfsSymlink(fuse_req_t req, const char* link, fuse_ino_t parent, const char* name) {
+    MiniFS& fs = fsOf(req);
+    int inum = fs.symlink(static_cast<int>(parent), name, link);
+    if (inum == MiniFS::INVALID_INUM_CONST) {
+        fuse_reply_err(req, createErrno(fs, parent, name));
+        return;
+    }
+    replyEntry(req, fs, inum);
+}
+
+void mfsRename(fuse_req_t req, fuse_ino_t parent, const char* name, fuse_ino_t newparent,
+               const char* newname, unsigned int flags) {
+    if (flags != 0) {
+        fuse_reply_err(req, EINVAL); // 不支持 RENAME_NOREPLACE / RENAME_EXCHANGE
+        return;
+    }
+    MiniFS& fs = fsOf(req);
+    if (fs.rename(static_cast<int>(parent), name, static_cast<int>(newparent), newname) != 0) {
+        if (fs._lookup_in_directory(static_cast<int>(parent), name) == MiniFS::INVALID_INUM_CONST) {
+            fuse_reply_err(req, ENOENT);
+        } else if (std::strlen(newname) >= static_cast<size_t>(DIRSIZ)) {
+            fuse_reply_err(req, ENAMETOOLONG);
+        } else {
+            fuse_reply_err(req, EINVAL); // 目标为非空目录、把目录移到自己内部等
+        }
+        return;
+    }
+    fuse_reply_err(req, 0);
+}
+
+void mfsLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent, const char* newname) {
+    MiniFS& fs = fsOf(req);
+    if (fs.link(static_cast<int>(ino), static_cast<int>(newparent), newname) != 0) {
+        dinode node;
+        if (fs._get_inode(static_cast<int>(ino), node) && node.type == T_DIR) {
+            fuse_reply_err(req, EPERM);
+        } else {
+            fuse_reply_err(req, createErrno(fs, newparent, newname));
+        }
+        return;
+    }
+    replyEntry(req, fs, static_cast<int>(ino));
+}
+
+void mfsOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
+    int fd = fsOf(req).openInode(static_cast<int>(ino), toMiniFSFlags(fi->flags));
+    if (fd < 0) {
+        fuse_reply_err(req, EMFILE); // 文件描述符表只有 MAX_OPEN_FILES 项
+        return;
+    }
+    fi->fh = static_cast<uint64_t>(fd);
+    fuse_reply_open(req, fi);
+}
+
+void mfsCreate(fuse_req_t req, fuse_ino_t parent, const char* name, mode_t mode, struct fuse_file_info* fi) {
+    (void)mode;
+    MiniFS& fs = fsOf(req);
+    int inum = fs.create(static_cast<int>(parent), name);
+    if (inum == MiniFS::INVALID_INUM_CONST) {
+        fuse_reply_err(req, createErrno(fs, parent, name));
+        return;
+    }
+    int fd = fs.openInode(inum, toMiniFSFlags(fi->flags));
+    if (fd < 0) {
+        fuse_reply_err(req, EMFILE);
+        return;
+    }
+    struct fuse_entry_param e;
+    std::memset(&e, 0, sizeof(e));
+    statInode(fs, inum, e.attr);
+    e.ino = static_cast<fuse_ino_t>(inum);
+    e.attr_timeout = ATTR_TIMEOUT;
+    e.entry_timeout = ENTRY_TIMEOUT;
+    fi->fh = static_cast<uint64_t>(fd);
+    fuse_reply_create(req, &e, fi);
+}
+
+void mfsRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info* fi) {
+    (void)ino;
+    if (off >= MAX_FILE_SIZE) {
+        fuse_reply_buf(req, NULL, 0);
+        return;
+    }
+    if (size > static_cast<size_t>(MAX_FILE_SIZE)) {
+        size = MAX_FILE_SIZE;
+    }
+    std::vector<char> buf(size);
+    int n = fsOf(req).pread(static_cast<int>(fi->fh), buf.data(), static_cast<int>(size), static_cast<int>(off));
+    if (n < 0) {
+        fuse_reply_err(req, EIO);
+        return;
+    }
+    fuse_reply_buf(req, buf.data(), static_cast<size_t>(n));
+}
+
+void mfsWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size_t size, off_t off, struct fuse_file_info* fi) {
+    (void)ino;
+    if (off + static_cast<off_t>(size) > MAX_FILE_SIZE) {
+        fuse_reply_err(req, EFBIG);
+        return;
+    }
+    int n = fsOf(req).pwrite(static_cast<int>(fi->fh), buf, static_cast<int>(size), static_cast<int>(off));
+    if (n < 0) {
+        fuse_reply_err(req, ENOSPC);
+        return;
+    }
+    fuse_reply_write(req, static_cast<size_t>(n));
+}
+
+void mfsRelease(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
+    (void)ino;
+    fsOf(req).close(static_cast<int>(fi->fh));
+    fuse_reply_err(req, 0);
+}
+
+// 整个镜像在内存中，fsync 把改动过的块写回镜像文件
+void mfsFsync(fuse_req_t req, fuse_ino_t ino, int datasync, struct fuse_file_info* fi) {
+    (void)ino;
+    (void)datasync;
+    (void)fi;
+    FuseContext* ctx = static_cast<FuseContext*>(fuse_req_userdata(req));
+    fuse_reply_err(req, ctx->fs.syncFS(ctx->image) >= 0 ? 0 : EIO);
+}
+
+// off 是目录游标的位置: 返回给内核的下一项偏移为读完该项后的游标位置
+// 内核只用 st_ino 和 st_mode 的类型位，直接取自目录项的类型，不读i-节点
+void mfsReaddir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off, struct fuse_file_info* fi) {
+    (void)fi;
+    MiniFS& fs = fsOf(req);
+    MiniFS::DirCursor cursor;
+    if (fs.opendir(static_cast<int>(ino), cursor) != 0) {
+        fuse_reply_err(req, ENOTDIR);
+        return;
+    }
+    cursor.pos = static_cast<size_t>(off);
+
+    std::vector<char> buf(size);
+    size_t used = 0;
+    MiniFS::DirEntry e;
+    while (fs.readdir(cursor, e)) {
+        struct stat st;
+        std::memset(&st, 0, sizeof(st));
+        st.st_ino = static_cast<ino_t>(e.inum);
+        st.st_mode = e.type == T_DIR ? S_IFDIR : e.type == T_SYMLINK ? S_IFLNK : S_IFREG;
+        size_t len = fuse_add_direntry(req, buf.data() + used, size - used, e.name.c_str(), &st,
+                                       static_cast<off_t>(cursor.pos));
+        if (len > size - used) {
+            break; // 缓冲区满，剩余项留给下一次 readdir
+        }
+        used += len;
+    }
+    fuse_reply_buf(req, buf.data(), used);
+}
+
+void mfsStatfs(fuse_req_t req, fuse_ino_t ino) {
+    (void)ino;
+    MiniFS& fs = fsOf(req);
+    int free_inodes = 0;
+    for (int i = 1; i < INODE_NUM; i++) {
+        if (!fs.test_bit(INODE_BITMAP_BLOCK_START, i)) {
+            free_inodes++;
+        }
+    }
+    struct statvfs st;
+    std::memset(&st, 0, sizeof(st));
+    st.f_bsize = BLOCK_SIZE;
+    st.f_frsize = BLOCK_SIZE;
+    st.f_blocks = DATA_BLOCKS_NUM;
+    st.f_bfree = fs.countFreeBlocks();
+    st.f_bavail = st.f_bfree;
+    st.f_files = INODE_NUM - 1;
+    st.f_ffree = free_inodes;
+    st.f_favail = free_inodes;
+    st.f_namemax = DIRSIZ - 1;
+    fuse_reply_statfs(req, &st);
+}
+
+void printUsage(const char* prog) {
+    std::cout << "用法: " << prog << " <镜像文件> <挂载点> [选项]" << std::endl;
+    std::cout << "  -f            前台运行" << std::endl;
+    std::cout << "  -s            单线程分发请求 (默认多线程)" << std::endl;
+    std::cout << "  -d            FUSE 调试输出 (隐含 -f)" << std::endl;
+    std::cout << "  -o <选项>     挂载选项，如 -o allow_other" << std::endl;
+    std::cout << "  --verbose     保留 MiniFS 的操作日志 (默认关闭)" << std::endl;
+    std::cout << "  --atime=<策略> 访问时间更新策略: strict、relatime (默认) 或 noatime" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argv[1][0] == '-') {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    FuseContext ctx;
+    ctx.image = argv[1];
+
+    // 其余参数交给 FUSE 解析 (去掉镜像文件名、--verbose 和 --atime=)
+    bool verbose = false;
+    std::vector<char*> fuse_argv;
+    fuse_argv.push_back(argv[0]);
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strncmp(argv[i], "--atime=", 8) == 0) {
+            std::string policy = argv[i] + 8;
+            if (policy == "strict") {
+                ctx.fs.setAtimePolicy(MiniFS::AtimePolicy::STRICT);
+            } else if (policy == "noatime") {
+                ctx.fs.setAtimePolicy(MiniFS::AtimePolicy::NOATIME);
+            } else if (policy == "relatime") {
+                ctx.fs.setAtimePolicy(MiniFS::AtimePolicy::RELATIME);
+            } else {
+                std::cerr << "错误: 未知的访问时间策略 '" << policy << "'" << std::endl;
+                return 1;
+            }
+        } else {
+            fuse_argv.push_back(argv[i]);
+        }
+    }
+    struct fuse_args args = FUSE_ARGS_INIT(static_cast<int>(fuse_argv.size()), fuse_argv.data());
+    struct fuse_cmdline_opts opts;
+    if (fuse_parse_cmdline(&args, &opts) != 0) {
+        return 1;
+    }
+    if (opts.show_help) {
+        printUsage(argv[0]);
+        fuse_lowlevel_help();
+        fuse_opt_free_args(&args);
+        return 0;
+    }
+    if (opts.show_version) {
+        fuse_lowlevel_version();
+        fuse_opt_free_args(&args);
+        return 0;
+    }
+    if (opts.mountpoint == NULL) {
+        printUsage(argv[0]);
+        fuse_opt_free_args(&args);
+        return 1;
+    }
+
+    if (ctx.fs.loadFS(ctx.image) != MiniFS::FSStatus::OK) {
+        std::cerr << "错误: 无法加载镜像 " << ctx.image << " (可先用 minifs --mkfs 创建)" << std::endl;
+        free(opts.mountpoint);
+        fuse_opt_free_args(&args);
+        return 1;
+    }
+
+    // MiniFS 每次打开、读写都会往 stdout 打印进度，挂载后默认关闭
+    std::streambuf* saved_cout = std::cout.rdbuf();
+    if (!verbose) {
+        std::cout.rdbuf(NULL);
+    }
+
+    struct fuse_lowlevel_ops ops;
+    std::memset(&ops, 0, sizeof(ops));
+    ops.destroy = mfsDestroy;
+    ops.lookup = mfsLookup;
+    ops.getattr = mfsGetattr;
+    ops.setattr = mfsSetattr;
+    ops.readlink = mfsReadlink;
+    ops.mkdir = mfsMkdir;
+    ops.unlink = mfsUnlink;
+    ops.rmdir = mfsRmdir;
+    ops.symlink = mfsSymlink;
+    ops.rename = mfsRename;
+    ops.link = mfsLink;
+    ops.open = mfsOpen;
+    ops.create = mfsCreate;
+    ops.read = mfsRead;
+    ops.write = mfsWrite;
+    ops.release = mfsRelease;
+    ops.fsync = mfsFsync;
+    ops.readdir = mfsReaddir;
+    ops.statfs = mfsStatfs;
+
+    int ret = 1;
+    struct fuse_session* se = fuse_session_new(&args, &ops, sizeof(ops), &ctx);
+    if (se != NULL) {
+        if (fuse_set_signal_handlers(se) == 0) {
+            if (fuse_session_mount(se, opts.mountpoint) == 0) {
+                fuse_daemonize(opts.foreground);
+                // MiniFS 内部一把递归锁保证一致性，多线程分发让阻塞在锁外的请求 (解析参数、拷贝缓冲区) 并行
+                if (opts.singlethread) {
+                    ret = fuse_session_loop(se);
+                } else {
+                    ret = fuse_session_loop_mt(se, opts.clone_fd);
+                }
+                fuse_session_unmount(se);
+            }
+            fuse_remove_signal_handlers(se);
+        }
+        fuse_session_destroy(se); // 会调用 destroy 写回镜像
+    }
+
+    std::cout.rdbuf(saved_cout);
+    free(opts.mountpoint);
+    fuse_opt_free_args(&args);
+    return ret != 0 ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+#include "rpc_client.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+RpcClient::RpcClient() : sock(-1), next_id(1) {}
+
+RpcClient::~RpcClient() {
+    disconnect();
+}
+
+bool RpcClient::connect(const std::string& socket_path) {
+    disconnect();
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "错误: 套接字路径过长 " << socket_path << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return false;
+    }
+    if (::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "错误: 无法连接 " << socket_path << ": " << std::strerror(errno) << std::endl;
+        ::close(sock);
+        sock = -1;
+        return false;
+    }
+    return true;
+}
+
+void RpcClient::disconnect() {
+    if (sock >= 0) {
+        ::close(sock);
+        sock = -1;
+    }
+}
+
+bool RpcClient::sendAll(const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::send(sock, data, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return false;
+        }
+        data += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+bool RpcClient::recvAll(char* data, size_t n) {
+    while (n > 0) {
+        ssize_t r = ::recv(sock, data, n, 0);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return false;
+        }
+        data += r;
+        n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+int RpcClient::call(uint16_t op, const std::string& payload, std::string* reply) {
+    if (sock < 0) {
+        return RPC_ERR_IO;
+    }
+    uint32_t id = next_id++;
+    RpcWriter frame;
+    frame.putU32(static_cast<uint32_t>(payload.size()));
+    frame.putU16(op);
+    frame.putU16(0);
+    frame.putU32(id);
+    frame.putRaw(payload.data(), payload.size());
+    if (!sendAll(frame.data().data(), frame.data().size())) {
+        disconnect();
+        return RPC_ERR_IO;
+    }
+
+    char header[RPC_HEADER_SIZE];
+    if (!recvAll(header, sizeof(header))) {
+        disconnect();
+        return RPC_ERR_IO;
+    }
+    RpcReader hr(header, sizeof(header));
+    uint32_t len = hr.getU32();
+    int status = hr.getI32();
+    uint32_t reply_id = hr.getU32();
+    if (len > RPC_MAX_PAYLOAD || reply_id != id) {
+        disconnect(); // 应答与请求对不上，连接已不可用
+        return RPC_ERR_IO;
+    }
+    std::string body(len, '\0');
+    if (len > 0 && !recvAll(&body[0], len)) {
+        disconnect();
+        return RPC_ERR_IO;
+    }
+    if (reply != NULL) {
+        reply->swap(body);
+    }
+    return status;
+}
+
+int RpcClient::open(const std::string& path, int flags) {
+    RpcWriter w;
+    w.putStr(path);
+    w.putI32(flags);
+    return call(RPC_OP_OPEN, w.data(), NULL);
+}
+
+int RpcClient::close(int fd) {
+    RpcWriter w;
+    w.putI32(fd);
+    return call(RPC_OP_CLOSE, w.data(), NULL);
+}
+
+int RpcClient::pread(int fd, void* buf, int count, int offset) {
+    RpcWriter w;
+    w.putI32(fd);
+    w.putI32(offset);
+    w.putI32(count);
+    std::string reply;
+    int n = call(RPC_OP_READ, w.data(), &reply);
+    if (n >= 0) {
+        n = std::min(n, static_cast<int>(reply.size()));
+        std::memcpy(buf, reply.data(), static_cast<size_t>(n));
+    }
+    return n;
+}
+
+int RpcClient::pwrite(int fd, const void* buf, int count, int offset) {
+    RpcWriter w;
+    w.putI32(fd);
+    w.putI32(offset);
+    w.putBytes(buf, static_cast<size_t>(count));
+    return call(RPC_OP_WRITE, w.data(), NULL);
+}
+
+int RpcClient::stat(const std::string& path, RpcStat& out) {
+    RpcWriter w;
+    w.putStr(path);
+    std::string reply;
+    int rc = call(RPC_OP_STAT, w.data(), &reply);
+    if (rc >= 0) {
+        RpcReader r(reply.data(), reply.size());
+        out.inum = r.getI32();
+        out.type = r.getI16();
+        out.nlink = r.getI16();
+        out.size = r.getI32();
+        if (!r.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+    }
+    return rc;
+}
+
+int RpcClient::readdir(const std::string& path, std::vector<RpcDirEntry>& out) {
+    RpcWriter w;
+    w.putStr(path);
+    std::string reply;
+    int count = call(RPC_OP_READDIR, w.data(), &reply);
+    out.clear();
+    RpcReader r(reply.data(), reply.size());
+    for (int i = 0; i < count; i++) {
+        RpcDirEntry e;
+        e.inum = r.getI32();
+        e.type = r.getI16();
+        e.name = r.getStr();
+        if (!r.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        out.push_back(e);
+    }
+    return count;
+}
+
+int RpcClient::mkdir(const std::string& path) {
+    RpcWriter w;
+    w.putStr(path);
+    return call(RPC_OP_MKDIR, w.data(), NULL);
+}
+
+int RpcClient::unlink(const std::string& path) {
+    RpcWriter w;
+    w.putStr(path);
+    return call(RPC_OP_UNLINK, w.data(), NULL);
+}
+
+#else // !__linux__
+
+RpcClient::RpcClient() : sock(-1), next_id(1) {}
+RpcClient::~RpcClient() {}
+
+bool RpcClient::connect(const std::string& socket_path) {
+    (void)socket_path;
+    std::cerr << "错误: RPC 客户端只支持 Linux" << std::endl;
+    return false;
+}
+
+void RpcClient::disconnect() {}
+
+int RpcClient::call(uint16_t op, const std::string& payload, std::string* reply) {
+    (void)op;
+    (void)payload;
+    (void)reply;
+    return RPC_ERR_IO;
+}
+
+int RpcClient::open(const std::string&, int) { return RPC_ERR_IO; }
+int RpcClient::close(int) { return RPC_ERR_IO; }
+int RpcClient::pread(int, void*, int, int) { return RPC_ERR_IO; }
+int RpcClient::pwrite(int, const void*, int, int) { return RPC_ERR_IO; }
+int RpcClient::stat(const std::string&, RpcStat&) { return RPC_ERR_IO; }
+int RpcClient::readdir(const std::string&, std::vector<RpcDirEntry>&) { return RPC_ERR_IO; }
+int RpcClient::mkdir(const std::string&) { return RPC_ERR_IO; }
+int RpcClient::unlink(const std::string&) { return RPC_ERR_IO; }
+
+#endif // __linux__
+
+void RpcBatch::add(uint16_t op, RpcWriter& sub) {
+    ops.putU16(op);
+    ops.putBytes(sub.data().data(), sub.data().size());
+    count++;
+}
+
+void RpcBatch::addOpen(const std::string& path, int flags) {
+    RpcWriter w;
+    w.putStr(path);
+    w.putI32(flags);
+    add(RPC_OP_OPEN, w);
+}
+
+void RpcBatch::addClose(int fd) {
+    RpcWriter w;
+    w.putI32(fd);
+    add(RPC_OP_CLOSE, w);
+}
+
+void RpcBatch::addRead(int fd, int offset, int n) {
+    RpcWriter w;
+    w.putI32(fd);
+    w.putI32(offset);
+    w.putI32(n);
+    add(RPC_OP_READ, w);
+}
+
+void RpcBatch::addWrite(int fd, int offset, const void* data, int n) {
+    RpcWriter w;
+    w.putI32(fd);
+    w.putI32(offset);
+    w.putBytes(data, static_cast<size_t>(n));
+    add(RPC_OP_WRITE, w);
+}
+
+void RpcBatch::addStat(const std::string& path) {
+    RpcWriter w;
+    w.putStr(path);
+    add(RPC_OP_STAT, w);
+}
+
+int RpcBatch::execute(RpcClient& client) {
+    RpcWriter w;
+    w.putU32(count);
+    w.putRaw(ops.data().data(), ops.data().size());
+    std::string reply;
+    int rc = client.call(RPC_OP_BATCH, w.data(), &reply);
+    statuses.clear();
+    replies.clear();
+    if (rc < 0) {
+        return rc;
+    }
+    RpcReader r(reply.data(), reply.size());
+    for (int i = 0; i < rc; i++) {
+        statuses.push_back(r.getI32());
+        replies.push_back(r.getBytes());
+    }
+    return r.good() ? rc : RPC_ERR_BAD_REQUEST;
+}
+
+// 负载生成器
+namespace {
+
+typedef std::map<std::string, std::vector<double> > LatencyMap; // 操作名 -> 各次延迟 (微秒)
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// 单个客户端: 在自己的文件上循环 写一块 → 读回 → stat，可选再发一个批量读
+long loadGenClient(const std::string& socket_path, int id, const LoadGenOptions& options, LatencyMap& latencies) {
+    RpcClient client;
+    if (!client.connect(socket_path)) {
+        return options.ops_per_client;
+    }
+    typedef std::chrono::steady_clock Clock;
+    long errors = 0;
+
+    std::string path = "/loadgen_" + std::to_string(id);
+    int fd = client.open(path, RPC_O_RDWR | RPC_O_CREATE | RPC_O_TRUNC);
+    if (fd < 0) {
+        std::cerr << "错误: 客户端 " << id << " 无法创建 " << path << std::endl;
+        return options.ops_per_client;
+    }
+
+    char block[512];
+    char back[512];
+    for (int i = 0; i < options.ops_per_client; i++) {
+        std::memset(block, 'a' + (i + id) % 26, sizeof(block));
+        int offset = (i % 8) * static_cast<int>(sizeof(block));
+
+        Clock::time_point t0 = Clock::now();
+        int rc = client.pwrite(fd, block, sizeof(block), offset);
+        Clock::time_point t1 = Clock::now();
+        latencies["write"].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        errors += (rc != static_cast<int>(sizeof(block)));
+
+        t0 = Clock::now();
+        rc = client.pread(fd, back, sizeof(back), offset);
+        t1 = Clock::now();
+        latencies["read"].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        errors += (rc != static_cast<int>(sizeof(back)) || std::memcmp(block, back, sizeof(back)) != 0);
+
+        RpcStat st;
+        t0 = Clock::now();
+        rc = client.stat(path, st);
+        t1 = Clock::now();
+        latencies["stat"].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        errors += (rc < 0);
+
+        if (options.batch > 0) {
+            RpcBatch batch;
+            for (int k = 0; k < options.batch; k++) {
+                batch.addRead(fd, (k % 8) * static_cast<int>(sizeof(block)), sizeof(block));
+            }
+            t0 = Clock::now();
+            rc = batch.execute(client);
+            t1 = Clock::now();
+            latencies["batch"].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            errors += (rc != options.batch);
+        }
+        if (!client.isConnected()) {
+            return errors + (options.ops_per_client - i - 1);
+        }
+    }
+    client.close(fd);
+    client.unlink(path);
+    return errors;
+}
+
+} // namespace
+
+int runLoadGen(const std::string& socket_path, const LoadGenOptions& options) {
+    std::vector<LatencyMap> per_client(options.clients);
+    std::vector<long> errors(options.clients, 0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.clients; i++) {
+        threads.push_back(std::thread([&, i]() {
+            errors[i] = loadGenClient(socket_path, i, options, per_client[i]);
+        }));
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyMap merged;
+    long total_errors = 0;
+    for (int i = 0; i < options.clients; i++) {
+        total_errors += errors[i];
+        for (LatencyMap::iterator it = per_client[i].begin(); it != per_client[i].end(); ++it) {
+            merged[it->first].insert(merged[it->first].end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    std::ios::fmtflags saved_flags = std::cout.flags();
+    std::streamsize saved_precision = std::cout.precision();
+    long total_ops = 0;
+    std::cout << "\n客户端: " << options.clients << "，每客户端迭代: " << options.ops_per_client
+              << (options.batch > 0 ? "，批量读: " + std::to_string(options.batch) : std::string()) << std::endl;
+    std::cout << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "count"
+              << std::setw(11) << "avg(us)" << std::setw(11) << "p50(us)" << std::setw(11) << "p90(us)"
+              << std::setw(11) << "p99(us)" << std::setw(12) << "p99.9(us)" << std::setw(11) << "max(us)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (LatencyMap::iterator it = merged.begin(); it != merged.end(); ++it) {
+        std::vector<double>& v = it->second;
+        if (v.empty()) {
+            continue;
+        }
+        std::sort(v.begin(), v.end());
+        double sum = 0;
+        for (double x : v) {
+            sum += x;
+        }
+        total_ops += static_cast<long>(v.size());
+        std::cout << std::left << std::setw(8) << it->first << std::right << std::setw(10) << v.size()
+                  << std::setw(11) << sum / v.size() << std::setw(11) << percentile(v, 0.50)
+                  << std::setw(11) << percentile(v, 0.90) << std::setw(11) << percentile(v, 0.99)
+                  << std::setw(12) << percentile(v, 0.999) << std::setw(11) << v.back() << std::endl;
+    }
+    std::cout << "总请求: " << total_ops << "，耗时: " << std::setprecision(3) << seconds << " 秒，吞吐: "
+              << std::setprecision(0) << (seconds > 0 ? total_ops / seconds : 0) << " 请求/秒，错误: "
+              << total_errors << std::endl;
+    std::cout.flags(saved_flags);
+    std::cout.precision(saved_precision);
+    return total_errors == 0 ? 0 : 1;
+}
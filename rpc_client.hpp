@@ -0,0 +1,82 @@
+#ifndef RPC_CLIENT_HPP
+#define RPC_CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rpc_protocol.hpp"
+
+// RPC 客户端: 阻塞式，每次调用发送一帧并等待应答 (仅 Linux)
+// 返回值与服务端状态相同: >= 0 成功，< 0 为 RPC_ERR_*；连接断开时返回 RPC_ERR_IO
+class RpcClient {
+public:
+    RpcClient();
+    ~RpcClient();
+
+    RpcClient(const RpcClient&) = delete;
+    RpcClient& operator=(const RpcClient&) = delete;
+
+    bool connect(const std::string& socket_path);
+    void disconnect();
+    bool isConnected() const { return sock >= 0; }
+
+    int open(const std::string& path, int flags); // flags 为 RPC_O_*，返回服务端的文件描述符
+    int close(int fd);
+    int pread(int fd, void* buf, int count, int offset);
+    int pwrite(int fd, const void* buf, int count, int offset);
+    int stat(const std::string& path, RpcStat& out);
+    int readdir(const std::string& path, std::vector<RpcDirEntry>& out);
+    int mkdir(const std::string& path);
+    int unlink(const std::string& path);
+
+    // 发送任意请求帧并等待应答，reply 可为空
+    int call(uint16_t op, const std::string& payload, std::string* reply);
+
+private:
+    bool sendAll(const char* data, size_t n);
+    bool recvAll(char* data, size_t n);
+
+    int sock;
+    uint32_t next_id;
+};
+
+// 批量请求: 先用 add* 累积子操作，再用 execute 一次往返执行全部子操作
+class RpcBatch {
+public:
+    RpcBatch() : count(0) {}
+
+    void addOpen(const std::string& path, int flags);
+    void addClose(int fd);
+    void addRead(int fd, int offset, int count);
+    void addWrite(int fd, int offset, const void* data, int n);
+    void addStat(const std::string& path);
+
+    size_t size() const { return count; }
+    // 成功返回子操作个数；之后用 status/reply 取各子操作的结果
+    int execute(RpcClient& client);
+    int status(size_t i) const { return statuses[i]; }
+    const std::string& reply(size_t i) const { return replies[i]; }
+
+private:
+    void add(uint16_t op, RpcWriter& sub);
+
+    RpcWriter ops;
+    uint32_t count;
+    std::vector<int> statuses;
+    std::vector<std::string> replies;
+};
+
+// 负载生成器: 多个客户端线程并发发送请求，统计每类操作的延迟分位数
+struct LoadGenOptions {
+    int clients;          // 并发客户端 (线程) 数
+    int ops_per_client;   // 每个客户端的迭代次数
+    int batch;            // 大于0时每次迭代额外发送一个含 batch 个读操作的批量请求
+
+    LoadGenOptions() : clients(4), ops_per_client(1000), batch(0) {}
+};
+
+// 返回0表示全部请求成功
+int runLoadGen(const std::string& socket_path, const LoadGenOptions& options);
+
+#endif // RPC_CLIENT_HPP
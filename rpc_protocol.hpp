@@ -0,0 +1,134 @@
+#ifndef RPC_PROTOCOL_HPP
+#define RPC_PROTOCOL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 本机 RPC 协议 (Unix 域套接字，只在同一台机器上使用，整数按本机字节序编码)
+//
+// 请求帧: [u32 载荷长度][u16 操作码][u16 保留][u32 请求号][载荷]
+// 应答帧: [u32 载荷长度][i32 状态][u32 请求号][载荷]
+// 状态 >= 0 表示成功 (文件描述符、字节数、i-节点号等)，< 0 为 RPC_ERR_*
+// 同一连接上的请求按顺序处理，应答按请求顺序返回
+//
+// 载荷 (str = u16 长度 + 字节，bytes = u32 长度 + 字节):
+//   OPEN    str 路径, i32 打开标志 (RPC_O_*)       → 状态为 fd
+//   CLOSE   i32 fd                                 → 0
+//   READ    i32 fd, i32 偏移, i32 字节数           → 状态为读到的字节数，载荷为数据本身
+//   WRITE   i32 fd, i32 偏移, bytes 数据           → 状态为写入的字节数
+//   STAT    str 路径                               → 载荷 i32 inum, i16 类型, i16 链接数, i32 大小
+//   READDIR str 路径                               → 状态为项数，载荷为若干 {i32 inum, i16 类型, str 名称}
+//   MKDIR   str 路径                               → 状态为新目录的 inum
+//   UNLINK  str 路径                               → 0
+//   BATCH   u32 个数, 若干 {u16 操作码, bytes 子载荷} → 状态为个数，载荷为若干 {i32 状态, bytes 子应答}
+//           批量请求内的操作依次执行，某一项失败不影响其余项；不能嵌套 BATCH
+// 文件描述符属于打开它的连接: 其他连接不能使用，连接断开时服务端自动关闭
+
+enum RpcOp : uint16_t {
+    RPC_OP_OPEN = 1,
+    RPC_OP_CLOSE = 2,
+    RPC_OP_READ = 3,
+    RPC_OP_WRITE = 4,
+    RPC_OP_STAT = 5,
+    RPC_OP_READDIR = 6,
+    RPC_OP_MKDIR = 7,
+    RPC_OP_UNLINK = 8,
+    RPC_OP_BATCH = 9,
+};
+
+const int RPC_ERR_FAILED = -1;      // 文件系统操作失败
+const int RPC_ERR_BAD_REQUEST = -2; // 载荷格式错误
+const int RPC_ERR_UNKNOWN_OP = -3;  // 未知操作码
+const int RPC_ERR_BAD_FD = -4;      // 文件描述符不属于本连接
+const int RPC_ERR_IO = -5;          // 客户端: 连接断开或收发失败
+
+// OPEN 的标志位，取值与 MiniFS::O_* 相同 (客户端不必包含 minifs.hpp)
+const int RPC_O_RDONLY = 0x0001;
+const int RPC_O_WRONLY = 0x0002;
+const int RPC_O_RDWR = 0x0003;
+const int RPC_O_CREATE = 0x0100;
+const int RPC_O_TRUNC = 0x0200;
+const int RPC_O_APPEND = 0x0400;
+
+const size_t RPC_HEADER_SIZE = 12;
+const uint32_t RPC_MAX_PAYLOAD = 1 << 20; // 超过上限的帧视为协议错误，断开连接
+
+// 顺序追加编码
+class RpcWriter {
+public:
+    void putU16(uint16_t v) { putRaw(&v, sizeof(v)); }
+    void putU32(uint32_t v) { putRaw(&v, sizeof(v)); }
+    void putI16(int16_t v) { putRaw(&v, sizeof(v)); }
+    void putI32(int32_t v) { putRaw(&v, sizeof(v)); }
+    void putStr(const std::string& s) {
+        putU16(static_cast<uint16_t>(s.size()));
+        putRaw(s.data(), s.size());
+    }
+    void putBytes(const void* data, size_t n) {
+        putU32(static_cast<uint32_t>(n));
+        putRaw(data, n);
+    }
+    void putRaw(const void* data, size_t n) {
+        buf.append(static_cast<const char*>(data), n);
+    }
+    std::string& data() { return buf; }
+
+private:
+    std::string buf;
+};
+
+// 顺序解码: 越界时置 ok 为 false，后续读取都返回0/空
+class RpcReader {
+public:
+    RpcReader(const char* data, size_t size) : p(data), end(data + size), ok(true) {}
+
+    uint16_t getU16() { uint16_t v = 0; getRaw(&v, sizeof(v)); return v; }
+    uint32_t getU32() { uint32_t v = 0; getRaw(&v, sizeof(v)); return v; }
+    int16_t getI16() { int16_t v = 0; getRaw(&v, sizeof(v)); return v; }
+    int32_t getI32() { int32_t v = 0; getRaw(&v, sizeof(v)); return v; }
+    std::string getStr() { return take(getU16()); }
+    std::string getBytes() { return take(getU32()); }
+    bool good() const { return ok; }
+    bool atEnd() const { return p == end; }
+
+private:
+    void getRaw(void* out, size_t n) {
+        if (!ok || static_cast<size_t>(end - p) < n) {
+            ok = false;
+            return;
+        }
+        std::memcpy(out, p, n);
+        p += n;
+    }
+    std::string take(size_t n) {
+        if (!ok || static_cast<size_t>(end - p) < n) {
+            ok = false;
+            return std::string();
+        }
+        std::string s(p, n);
+        p += n;
+        return s;
+    }
+
+    const char* p;
+    const char* end;
+    bool ok;
+};
+
+// 目录项与文件属性 (客户端解码结果)
+struct RpcStat {
+    int inum;
+    int type;
+    int nlink;
+    int size;
+};
+
+struct RpcDirEntry {
+    int inum;
+    int type;
+    std::string name;
+};
+
+#endif // RPC_PROTOCOL_HPP
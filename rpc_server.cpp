@@ -0,0 +1,460 @@
+#include "rpc_server.hpp"
+#include "minifs.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static_assert(RPC_O_RDONLY == MiniFS::O_RDONLY && RPC_O_WRONLY == MiniFS::O_WRONLY &&
+              RPC_O_RDWR == MiniFS::O_RDWR && RPC_O_CREATE == MiniFS::O_CREATE &&
+              RPC_O_TRUNC == MiniFS::O_TRUNC && RPC_O_APPEND == MiniFS::O_APPEND,
+              "RPC_O_* 必须与 MiniFS::O_* 一致");
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+RpcServer::RpcServer(MiniFS& fs)
+    : fs(fs), listen_fd(-1), epoll_fd(-1), wake_fd(-1), stopping(false) {
+    stats.connections = 0;
+    stats.requests = 0;
+    stats.ops = 0;
+}
+
+RpcServer::~RpcServer() {
+    while (!sessions.empty()) {
+        closeSession(sessions.begin()->first);
+    }
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+    }
+    if (wake_fd >= 0) {
+        ::close(wake_fd);
+    }
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+bool RpcServer::listen(const std::string& socket_path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "错误: 套接字路径过长 " << socket_path << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        std::cerr << "错误: 创建套接字失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::unlink(socket_path.c_str()); // 上次异常退出留下的套接字文件
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd, 128) != 0) {
+        std::cerr << "错误: 无法监听 " << socket_path << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    path = socket_path;
+
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        std::cerr << "错误: 创建 epoll/eventfd 失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.fd = wake_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+    return true;
+}
+
+void RpcServer::stop() {
+    stopping.store(true);
+    if (wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = ::write(wake_fd, &one, sizeof(one)); // 只用 write，可在信号处理函数中调用
+        (void)n;
+    }
+}
+
+RpcServer::Stats RpcServer::getStats() const {
+    return stats;
+}
+
+int RpcServer::run() {
+    if (listen_fd < 0 || epoll_fd < 0) {
+        return -1;
+    }
+    const int max_events = 64;
+    epoll_event events[max_events];
+    while (!stopping.load()) {
+        int n = ::epoll_wait(epoll_fd, events, max_events, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "错误: epoll_wait 失败: " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == wake_fd) {
+                uint64_t value;
+                ssize_t r = ::read(wake_fd, &value, sizeof(value));
+                (void)r;
+                continue;
+            }
+            std::map<int, std::unique_ptr<Session> >::iterator it = sessions.find(fd);
+            if (it == sessions.end()) {
+                continue; // 本轮前面的事件已关闭该连接
+            }
+            Session& s = *it->second;
+            bool alive = true;
+            if (events[i].events & EPOLLIN) {
+                alive = readSession(s);
+                handleFrames(s); // 对端关闭写方向前发来的完整请求仍然处理
+                if (s.in.size() >= RPC_HEADER_SIZE) {
+                    uint32_t len;
+                    std::memcpy(&len, s.in.data(), sizeof(len));
+                    if (len > RPC_MAX_PAYLOAD) {
+                        std::cerr << "错误: 请求帧过大 (" << len << " 字节)，断开连接" << std::endl;
+                        alive = false;
+                    }
+                }
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                alive = false;
+            }
+            if (alive && s.out_sent < s.out.size()) {
+                alive = flushSession(s);
+            }
+            if (!alive) {
+                closeSession(fd);
+            }
+        }
+    }
+    return 0;
+}
+
+void RpcServer::acceptClients() {
+    for (;;) {
+        int sock = ::accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (sock < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "警告: accept 失败: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = sock;
+        if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev) != 0) {
+            ::close(sock);
+            continue;
+        }
+        std::unique_ptr<Session> s(new Session());
+        s->sock = sock;
+        s->out_sent = 0;
+        s->want_write = false;
+        sessions[sock] = std::move(s);
+        stats.connections++;
+    }
+}
+
+// 读到 EAGAIN 为止；对端关闭或出错返回 false
+bool RpcServer::readSession(Session& s) {
+    char buf[16384];
+    for (;;) {
+        ssize_t n = ::recv(s.sock, buf, sizeof(buf), 0);
+        if (n > 0) {
+            s.in.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+// 尽量发出应答；发不完时注册 EPOLLOUT 等待可写，发完后取消
+bool RpcServer::flushSession(Session& s) {
+    while (s.out_sent < s.out.size()) {
+        ssize_t n = ::send(s.sock, s.out.data() + s.out_sent, s.out.size() - s.out_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            s.out_sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    bool pending = s.out_sent < s.out.size();
+    if (!pending) {
+        s.out.clear();
+        s.out_sent = 0;
+    }
+    if (pending != s.want_write) {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.fd = s.sock;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, s.sock, &ev);
+        s.want_write = pending;
+    }
+    return true;
+}
+
+// 关闭连接，并关闭该连接遗留的 MiniFS 文件描述符
+void RpcServer::closeSession(int sock) {
+    std::map<int, std::unique_ptr<Session> >::iterator it = sessions.find(sock);
+    if (it == sessions.end()) {
+        return;
+    }
+    for (int fd : it->second->fds) {
+        fs.close(fd);
+    }
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+    ::close(sock);
+    sessions.erase(it);
+}
+
+// 处理缓冲区中所有完整的请求帧，应答追加到 out
+void RpcServer::handleFrames(Session& s) {
+    size_t pos = 0;
+    while (s.in.size() - pos >= RPC_HEADER_SIZE) {
+        uint32_t len;
+        uint16_t op;
+        uint32_t id;
+        std::memcpy(&len, s.in.data() + pos, sizeof(len));
+        std::memcpy(&op, s.in.data() + pos + 4, sizeof(op));
+        std::memcpy(&id, s.in.data() + pos + 8, sizeof(id));
+        if (len > RPC_MAX_PAYLOAD || s.in.size() - pos - RPC_HEADER_SIZE < len) {
+            break; // 帧不完整 (或过大，由调用者断开)
+        }
+
+        RpcReader req(s.in.data() + pos + RPC_HEADER_SIZE, len);
+        RpcWriter reply;
+        int status = (op == RPC_OP_BATCH) ? executeBatch(s, req, reply) : execute(s, op, req, reply);
+        stats.requests++;
+
+        RpcWriter header;
+        header.putU32(static_cast<uint32_t>(reply.data().size()));
+        header.putI32(status);
+        header.putU32(id);
+        s.out += header.data();
+        s.out += reply.data();
+        pos += RPC_HEADER_SIZE + len;
+    }
+    s.in.erase(0, pos);
+}
+
+int RpcServer::executeBatch(Session& s, RpcReader& req, RpcWriter& reply) {
+    uint32_t count = req.getU32();
+    if (!req.good()) {
+        return RPC_ERR_BAD_REQUEST;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t op = req.getU16();
+        std::string sub = req.getBytes();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        RpcReader sub_req(sub.data(), sub.size());
+        RpcWriter sub_reply;
+        int status = (op == RPC_OP_BATCH) ? RPC_ERR_BAD_REQUEST : execute(s, op, sub_req, sub_reply);
+        reply.putI32(status);
+        reply.putBytes(sub_reply.data().data(), sub_reply.data().size());
+    }
+    return static_cast<int>(count);
+}
+
+// 把绝对路径拆成父目录的i-节点号和最后一个组件
+int RpcServer::splitParent(const std::string& full_path, std::string& name) {
+    size_t slash = full_path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "/" : full_path.substr(0, slash);
+    name = (slash == std::string::npos) ? full_path : full_path.substr(slash + 1);
+    if (name.empty()) {
+        return MiniFS::INVALID_INUM_CONST;
+    }
+    return fs.resolve_path_to_inum(dir.empty() ? "/" : dir);
+}
+
+int RpcServer::execute(Session& s, uint16_t op, RpcReader& req, RpcWriter& reply) {
+    stats.ops++;
+    switch (op) {
+    case RPC_OP_OPEN: {
+        std::string full_path = req.getStr();
+        int flags = req.getI32();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        std::string name;
+        int parent = splitParent(full_path, name);
+        if (parent == MiniFS::INVALID_INUM_CONST) {
+            return RPC_ERR_FAILED;
+        }
+        int fd = fs.open(parent, name.c_str(), flags);
+        if (fd < 0) {
+            return RPC_ERR_FAILED;
+        }
+        s.fds.insert(fd);
+        return fd;
+    }
+    case RPC_OP_CLOSE: {
+        int fd = req.getI32();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        if (s.fds.erase(fd) == 0) {
+            return RPC_ERR_BAD_FD;
+        }
+        return fs.close(fd) == 0 ? 0 : RPC_ERR_FAILED;
+    }
+    case RPC_OP_READ: {
+        int fd = req.getI32();
+        int offset = req.getI32();
+        int count = req.getI32();
+        if (!req.good() || count < 0 || static_cast<uint32_t>(count) > RPC_MAX_PAYLOAD) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        if (s.fds.count(fd) == 0) {
+            return RPC_ERR_BAD_FD;
+        }
+        std::vector<char> buf(count > 0 ? count : 1);
+        int n = fs.pread(fd, buf.data(), count, offset);
+        if (n < 0) {
+            return RPC_ERR_FAILED;
+        }
+        reply.putRaw(buf.data(), static_cast<size_t>(n));
+        return n;
+    }
+    case RPC_OP_WRITE: {
+        int fd = req.getI32();
+        int offset = req.getI32();
+        std::string data = req.getBytes();
+        // 偏移和长度来自网络，先在这里拒绝，不把越界范围交给文件系统
+        if (!req.good() || offset < 0 || data.size() > RPC_MAX_PAYLOAD ||
+            offset > 8 * BLOCK_SIZE - static_cast<int>(data.size())) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        if (s.fds.count(fd) == 0) {
+            return RPC_ERR_BAD_FD;
+        }
+        int n = fs.pwrite(fd, data.data(), static_cast<int>(data.size()), offset);
+        return n < 0 ? RPC_ERR_FAILED : n;
+    }
+    case RPC_OP_STAT: {
+        std::string full_path = req.getStr();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        MiniFS::FileStat st;
+        if (fs.stat(full_path, st) != 0) {
+            return RPC_ERR_FAILED;
+        }
+        reply.putI32(st.st_ino);
+        reply.putI16(static_cast<int16_t>(st.st_type));
+        reply.putI16(static_cast<int16_t>(st.st_nlink));
+        reply.putI32(st.st_size);
+        return 0;
+    }
+    case RPC_OP_READDIR: {
+        std::string full_path = req.getStr();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        int inum = fs.resolve_path_to_inum(full_path);
+        MiniFS::DirCursor cursor;
+        if (inum == MiniFS::INVALID_INUM_CONST || fs.opendir(inum, cursor) != 0) {
+            return RPC_ERR_FAILED;
+        }
+        int count = 0;
+        MiniFS::DirEntry e;
+        while (fs.readdir(cursor, e)) {
+            reply.putI32(e.inum);
+            reply.putI16(static_cast<int16_t>(e.type));
+            reply.putStr(e.name);
+            count++;
+        }
+        return count;
+    }
+    case RPC_OP_MKDIR: {
+        std::string full_path = req.getStr();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        std::string name;
+        int parent = splitParent(full_path, name);
+        if (parent == MiniFS::INVALID_INUM_CONST) {
+            return RPC_ERR_FAILED;
+        }
+        int inum = fs.mkdir(parent, name.c_str());
+        return inum < 0 ? RPC_ERR_FAILED : inum;
+    }
+    case RPC_OP_UNLINK: {
+        std::string full_path = req.getStr();
+        if (!req.good()) {
+            return RPC_ERR_BAD_REQUEST;
+        }
+        std::string name;
+        int parent = splitParent(full_path, name);
+        if (parent == MiniFS::INVALID_INUM_CONST) {
+            return RPC_ERR_FAILED;
+        }
+        return fs.unlink(parent, name.c_str()) == 0 ? 0 : RPC_ERR_FAILED;
+    }
+    default:
+        return RPC_ERR_UNKNOWN_OP;
+    }
+}
+
+#else // !__linux__
+
+// 其他平台没有 epoll 和 (普遍可用的) Unix 域套接字，服务端模式不可用
+RpcServer::RpcServer(MiniFS& fs)
+    : fs(fs), listen_fd(-1), epoll_fd(-1), wake_fd(-1), stopping(false) {
+    stats.connections = 0;
+    stats.requests = 0;
+    stats.ops = 0;
+}
+
+RpcServer::~RpcServer() {}
+
+bool RpcServer::listen(const std::string& socket_path) {
+    (void)socket_path;
+    std::cerr << "错误: 服务端模式只支持 Linux" << std::endl;
+    return false;
+}
+
+int RpcServer::run() { return -1; }
+void RpcServer::stop() { stopping.store(true); }
+RpcServer::Stats RpcServer::getStats() const { return stats; }
+
+#endif // __linux__
@@ -0,0 +1,67 @@
+#ifndef RPC_SERVER_HPP
+#define RPC_SERVER_HPP
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "rpc_protocol.hpp"
+
+class MiniFS; // 前向声明 MiniFS 类
+
+// 守护进程模式: 由一个进程持有 MiniFS 实例，通过 Unix 域套接字为本机的多个客户端服务 (仅 Linux)
+// 单线程 epoll 事件循环，套接字全部非阻塞；每个连接一个会话，保存收发缓冲区和它打开的文件描述符
+class RpcServer {
+public:
+    explicit RpcServer(MiniFS& fs);
+    ~RpcServer();
+
+    RpcServer(const RpcServer&) = delete;
+    RpcServer& operator=(const RpcServer&) = delete;
+
+    // 创建并监听套接字 (已存在的同名套接字文件会被删除)，失败返回 false
+    bool listen(const std::string& socket_path);
+    // 运行事件循环直到 stop() 被调用，返回0；出错返回-1
+    int run();
+    // 可从其他线程或信号处理函数调用，通过 eventfd 唤醒事件循环
+    void stop();
+
+    struct Stats {
+        long connections;   // 累计接受的连接数
+        long requests;      // 累计处理的请求帧数 (批量请求算一个)
+        long ops;           // 累计执行的操作数 (批量请求按子操作计)
+    };
+    Stats getStats() const;
+
+private:
+    struct Session {
+        int sock;
+        std::string in;        // 尚未处理完的请求字节
+        std::string out;       // 尚未发出的应答字节
+        size_t out_sent;       // out 中已发出的字节数
+        bool want_write;       // 是否已注册 EPOLLOUT
+        std::set<int> fds;     // 本连接打开的 MiniFS 文件描述符
+    };
+
+    void acceptClients();
+    bool readSession(Session& s);
+    bool flushSession(Session& s);
+    void closeSession(int sock);
+    void handleFrames(Session& s);
+    int execute(Session& s, uint16_t op, RpcReader& req, RpcWriter& reply);
+    int executeBatch(Session& s, RpcReader& req, RpcWriter& reply);
+    int splitParent(const std::string& path, std::string& name);
+
+    MiniFS& fs;
+    std::string path;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;
+    std::atomic<bool> stopping;
+    std::map<int, std::unique_ptr<Session> > sessions;
+    Stats stats;
+};
+
+#endif // RPC_SERVER_HPP
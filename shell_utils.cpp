@@ -2,9 +2,108 @@
 #include "shell_utils.hpp"
 #include "minifs.hpp"
 #include "user.hpp"
+#include <map>
 // 全局或在runInteractiveShell作用域内定义当前工作目录i-节点号
 // 由于没有cd命令，它将一直为根目录
 static int current_working_directory_inum = MiniFS::ROOT_INUM_CONST;
+
+// 当前目录路径缓存: 从根到当前目录的i-节点栈和各级名称，cd 时增量更新，提示符直接使用；
+// mv/rmdir/format/测试命令可能改变路径，执行前置为失效，下次需要时再用 getCwdPath 完整重建
+struct CwdCache {
+    std::vector<int> inums;          // inums[0] 为根目录，末尾为当前目录
+    std::vector<std::string> names;  // names[i] 为 inums[i+1] 在 inums[i] 中的名称
+    std::string path;
+    bool valid;
+};
+static CwdCache cwd_cache = { std::vector<int>(1, MiniFS::ROOT_INUM_CONST), std::vector<std::string>(), "/", true };
+
+static void cwdCacheUpdatePath() {
+    cwd_cache.path = "/";
+    for (size_t i = 0; i < cwd_cache.names.size(); i++) {
+        cwd_cache.path += (i > 0 ? "/" : "") + cwd_cache.names[i];
+    }
+}
+
+static void cwdCacheInvalidate() {
+    cwd_cache.valid = false;
+}
+
+// 用 getCwdPath 得到的完整路径重建i-节点栈 (只在缓存失效后执行一次)
+static void cwdCacheRebuild(MiniFS& fs) {
+    cwd_cache.inums.assign(1, MiniFS::ROOT_INUM_CONST);
+    cwd_cache.names.clear();
+    std::string full = getCwdPath(fs, current_working_directory_inum);
+    std::istringstream iss(full);
+    std::string name;
+    while (std::getline(iss, name, '/')) {
+        if (name.empty()) {
+            continue;
+        }
+        cwd_cache.inums.push_back(fs._lookup_in_directory(cwd_cache.inums.back(), name));
+        cwd_cache.names.push_back(name);
+    }
+    cwd_cache.path = full;
+    cwd_cache.valid = cwd_cache.inums.back() == current_working_directory_inum;
+}
+
+// cd 成功后按路径组件增量更新缓存: 只查找新进入的各级目录，.. 直接出栈；
+// 遇到符号链接或结果与 target_inum 不符时置为失效
+static void cwdCacheApply(MiniFS& fs, const std::string& path, int target_inum) {
+    if (!cwd_cache.valid) {
+        return;
+    }
+    if (!path.empty() && path[0] == '/') {
+        cwd_cache.inums.resize(1);
+        cwd_cache.names.clear();
+    }
+    std::istringstream iss(path);
+    std::string name;
+    while (std::getline(iss, name, '/')) {
+        if (name.empty() || name == ".") {
+            continue;
+        }
+        if (name == "..") {
+            if (cwd_cache.inums.size() > 1) {
+                cwd_cache.inums.pop_back();
+                cwd_cache.names.pop_back();
+            }
+            continue;
+        }
+        int inum = fs._lookup_in_directory(cwd_cache.inums.back(), name);
+        dinode node;
+        if (inum == MiniFS::INVALID_INUM_CONST || !fs._get_inode(inum, node) || node.type != T_DIR) {
+            cwdCacheInvalidate(); // 符号链接等情况交给完整重建
+            return;
+        }
+        cwd_cache.inums.push_back(inum);
+        cwd_cache.names.push_back(name);
+    }
+    if (cwd_cache.inums.back() != target_inum) {
+        cwdCacheInvalidate();
+        return;
+    }
+    cwdCacheUpdatePath();
+}
+
+// 访问时间策略的显示名 (status 与 atime 命令)
+static const char* atimePolicyName(MiniFS::AtimePolicy policy) {
+    switch (policy) {
+    case MiniFS::AtimePolicy::STRICT:
+        return "strict";
+    case MiniFS::AtimePolicy::NOATIME:
+        return "noatime";
+    default:
+        return "relatime";
+    }
+}
+
+// 当前工作目录的路径，缓存有效时不读任何块
+std::string getShellCwdPath(MiniFS& fs) {
+    if (!cwd_cache.valid || cwd_cache.inums.back() != current_working_directory_inum) {
+        cwdCacheRebuild(fs);
+    }
+    return cwd_cache.path;
+}
 // 修改 showHelp
 void showHelp() {
     std::cout << "\n========== MiniFS 文件系统命令行工具 ==========" << std::endl;
@@ -13,18 +112,60 @@ void showHelp() {
     std::cout << "  mkdir <路径/新目录名>   - 创建新目录" << std::endl;
     std::cout << "  rmdir <路径/目录名>     - 删除空目录" << std::endl;
     std::cout << "  rm <路径/文件名>        - 删除文件" << std::endl;
+    std::cout << "  rm -r <路径>            - 递归删除目录树 (块和i-节点成批释放)" << std::endl;
+    std::cout << "  cp [-r] <源路径> <目标路径> - 复制文件，-r 复制整棵目录树 (目标为目录时复制到其中)" << std::endl;
+    std::cout << "  du [路径]               - 统计占用的数据块与文件大小 (默认当前目录)" << std::endl;
+    std::cout << "  stat [-L] <路径>        - 显示文件属性与时间戳 (-L 跟随符号链接)" << std::endl;
+    std::cout << "  atime [strict|relatime|noatime] - 显示/设置访问时间的更新策略" << std::endl;
+    std::cout << "  mv <源路径> <目标路径>  - 重命名/移动 (目标为目录时移动到其中，已存在的文件被原子替换)" << std::endl;
+    std::cout << "  ln <已有文件> <新路径>  - 创建硬链接" << std::endl;
+    std::cout << "  ln -s <目标> <新路径>   - 创建符号链接 (目标不要求存在)" << std::endl;
+    std::cout << "  readlink <路径>         - 显示符号链接的目标" << std::endl;
+    std::cout << "  unlink <路径/文件名>    - 删除一个链接 (最后一个链接删除后释放文件)" << std::endl;
     std::cout << "  chdir <路径>            - 切换到指定目录 (别名: cd)" << std::endl;
     std::cout << "  create <路径/新文件名>  - 创建新文件" << std::endl;
-    std::cout << "  open <路径/文件名> <模式> - 打开文件，模式: r(只读), w(只写), rw(读写), c(创建)" << std::endl;
+    std::cout << "  open <路径/文件名> <模式> - 打开文件，模式: r(只读), w(只写), rw(读写), c(创建), t(截断后只写), a(追加)" << std::endl;
+    std::cout << "  truncate <路径/文件名> <字节数> - 把文件截断/扩展到指定大小" << std::endl;
     std::cout << "  close <fd>              - 关闭文件描述符" << std::endl;
     std::cout << "  read <fd> <字节数>      - 从文件中读取指定字节数" << std::endl;
     std::cout << "  write <fd> <内容>       - 向文件中写入内容" << std::endl;
+    std::cout << "  cp-in <宿主路径> <路径/文件名>  - 把宿主文件按块流式复制进来 (已存在时覆盖)" << std::endl;
+    std::cout << "  cp-out <路径/文件名> <宿主路径> - 把文件按块流式复制到宿主" << std::endl;
+    std::cout << "  cat <路径/文件名> [> 或 >> <宿主路径>] - 输出文件原始内容，可重定向/追加到宿主文件" << std::endl;
+    std::cout << "  seek <fd> <偏移> [set|cur|end|data|hole] - 设置写入位置 (data/hole 查找数据/空洞)" << std::endl;
+    std::cout << "  fallocate <fd> <偏移> <长度> [keep|punch] - 预分配数据块或打洞" << std::endl;
+    std::cout << "  csum <路径/文件名> on|off - 开启/关闭文件的数据块校验" << std::endl;
+    std::cout << "  scrub [start [块/秒]|stop] - 巡检: 无参数时立即执行一轮，start/stop 控制后台巡检" << std::endl;
     std::cout << "  test-bitmap             - 运行位图操作测试" << std::endl;
     std::cout << "  test-directory          - 运行目录操作测试 (旧版，可能不完全兼容路径)" << std::endl;
     std::cout << "  test-file               - 运行文件操作测试" << std::endl;
     std::cout << "  test-user               - 运行用户管理功能测试" << std::endl;
+    std::cout << "  test-checksum           - 运行元数据/数据校验与巡检测试" << std::endl;
+    std::cout << "  test-link               - 运行硬链接测试" << std::endl;
+    std::cout << "  test-symlink            - 运行符号链接测试" << std::endl;
+    std::cout << "  test-rename             - 运行重命名测试" << std::endl;
+    std::cout << "  test-truncate           - 运行截断与追加测试" << std::endl;
+    std::cout << "  test-sparse             - 运行稀疏文件测试" << std::endl;
+    std::cout << "  test-inline             - 运行内联小文件测试" << std::endl;
+    std::cout << "  test-lazyzero           - 运行数据块延迟清零测试" << std::endl;
+    std::cout << "  test-balloc             - 运行批量分配测试" << std::endl;
+    std::cout << "  test-bulk               - 运行批量导入/导出测试" << std::endl;
+    std::cout << "  test-pipeline           - 运行流水线导入测试" << std::endl;
+    std::cout << "  test-batch              - 运行批处理模式测试" << std::endl;
+    std::cout << "  test-cwd                - 运行当前目录路径缓存测试" << std::endl;
+    std::cout << "  test-copy               - 运行宿主文件复制与重定向测试" << std::endl;
+    std::cout << "  test-rpc                - 运行 RPC 服务端测试" << std::endl;
+    std::cout << "  test-blockdev           - 运行镜像块设备与增量写回测试" << std::endl;
+    std::cout << "  test-readahead          - 运行顺序预读测试" << std::endl;
+    std::cout << "  test-async              - 运行异步接口 (执行器/协程) 测试" << std::endl;
+    std::cout << "  test-steal              - 运行工作窃取线程池与并行遍历测试" << std::endl;
+    std::cout << "  test-tree               - 运行 rm -r / cp -r / du 测试" << std::endl;
+    std::cout << "  test-readdir            - 运行目录游标与 readdirplus 测试" << std::endl;
+    std::cout << "  test-stat               - 运行 stat 与属性缓存测试" << std::endl;
+    std::cout << "  test-time               - 运行时间戳与访问时间策略测试" << std::endl;
     std::cout << "  format                  - 格式化文件系统" << std::endl;
     std::cout << "  save                    - 保存文件系统" << std::endl;
+    std::cout << "  sync                    - 只把改动过的块写回镜像 (io_uring/pread 批量提交)" << std::endl;
     std::cout << "  status                  - 显示文件系统状态" << std::endl;
     std::cout << "  help                    - 显示帮助信息" << std::endl;
     std::cout << "  exit                    - 退出程序" << std::endl;
@@ -48,6 +189,23 @@ void showStatus(MiniFS& fs) {
     std::cout << "数据块总数: " << DATA_BLOCKS_NUM << std::endl;
     std::cout << "i-节点区起始块: " << INODE_START << std::endl;
     std::cout << "数据区起始块: " << DATA_START << std::endl;
+    std::cout << "空闲数据块: " << fs.countFreeBlocks() << " / " << DATA_BLOCKS_NUM << std::endl;
+    MiniFS::IOStats io = fs.getIOStats();
+    std::cout << "块I/O: 元数据 读 " << io.meta_reads << " / 写 " << io.meta_writes
+              << ", 数据 读 " << io.data_reads << " / 写 " << io.data_writes << std::endl;
+    std::cout << "顺序预读: 填充 " << io.readahead_fills << " 次, 命中 " << io.readahead_hits << " 次" << std::endl;
+    std::cout << "属性缓存: 命中 " << io.attr_cache_hits << " 次, 读i-节点块 " << io.attr_cache_misses << " 次"
+              << std::endl;
+    std::cout << "访问时间策略: " << atimePolicyName(fs.getAtimePolicy()) << ", 待写回 " << fs.pendingTimes() << " 个"
+              << std::endl;
+    MiniFS::ChecksumStats csum = fs.getChecksumStats();
+    std::cout << "元数据校验 (CRC32C, " << crc32cImplName() << "): 已校验 " << csum.verified
+              << " 块, 失败 " << csum.failures << " 块" << std::endl;
+    std::cout << "数据校验失败次数: " << csum.data_failures << std::endl;
+    MiniFS::ScrubStats scrub = fs.getScrubStats();
+    std::cout << "巡检: " << (scrub.running ? "运行中" : "未运行") << ", 完成 " << scrub.passes
+              << " 轮, 文件 " << scrub.files << " 个, 数据块 " << scrub.blocks
+              << " 个, 不匹配 " << scrub.mismatches << " 个" << std::endl;
     std::cout << "=================================" << std::endl;
 }
 
@@ -96,7 +254,7 @@ std::string getCwdPath(MiniFS& fs, int current_inum) {
         // 读取父目录的内容
         int entries_count = parent_node.size / sizeof(dirent);
         dirent entries[BLOCK_SIZE / sizeof(dirent)];
-        fs.readBlock(parent_node.addrs[0], entries);
+        fs._read_dir_block(parent_node, entries);
         
         // 查找对应当前inum的条目
         std::string current_name;
@@ -135,557 +293,1113 @@ std::string getCwdPath(MiniFS& fs, int current_inum) {
     return full_path;
 }
 
-// 交互式命令行界面
-void runInteractiveShell(MiniFS& fs, const std::string& fsfile) {
-    std::cout << "\n========== MiniFS 交互式命令行 ==========" << std::endl;
-    std::cout << "当前目录 i-节点号: " << current_working_directory_inum << " (根目录)" << std::endl;
-    std::cout << "输入 'help' 查看可用命令，输入 'exit' 退出" << std::endl;
-    std::cout << "=========================================" << std::endl;
-    
-    // 尝试从文件系统加载用户数据
-    fs.loadUserData();
-    
+// 执行一条已分词的命令，交互输入 (密码、多行写入、确认) 从 in 读取；返回 false 表示应当退出
+bool executeCommand(MiniFS& fs, const std::string& fsfile, const std::vector<std::string>& tokens, std::istream& in) {
     // 定义需要用户登录的命令列表
-    const std::vector<std::string> user_required_commands = {
+    static const std::vector<std::string> user_required_commands = {
         "mkdir", "rmdir", "rm", "cd", "chdir", "create", "open", 
-        "close", "read", "write"
+        "close", "read", "write", "csum", "scrub", "ln", "unlink", "readlink", "mv", "truncate", "seek", "fallocate",
+        "cp-in", "cp-out", "cat", "cp", "du", "stat"
     };
-    
-    std::string input;
-    while (true) {
-        // 获取当前工作目录的路径并显示命令提示符
-        std::string cwd_path = getCwdPath(fs, current_working_directory_inum);
-        std::string user_part = fs.isLoggedIn() ? fs.getCurrentUser().getUsername() + "@" : "";
-        std::cout << "\nMiniFS:" << user_part << cwd_path << "> ";
-        std::getline(std::cin, input);
-        
-        // 去除前导和后导空格
-        input.erase(0, input.find_first_not_of(" \t"));
-        if (input.find_last_not_of(" \t") != std::string::npos)
-            input.erase(input.find_last_not_of(" \t") + 1);
-        
-        if (input.empty()) {
-            continue;
+
+    std::string command = tokens[0];
+    if (command == "mv" || command == "rmdir" || command == "rm" || command == "format" || command.compare(0, 5, "test-") == 0) {
+        cwdCacheInvalidate(); // 可能重命名或删除当前路径上的目录
+    }
+    try {
+        // 1. 系统控制命令 - 不需要登录权限检查
+        if (command == "exit" || command == "quit") {
+            fs.stopScrubber();
+            std::cout << "正在保存用户数据和文件系统..." << std::endl;
+            
+            // 保存用户数据
+            fs.saveUserData();
+            
+            // 保存文件系统
+            if (fs.saveFS(fsfile) == 0) {
+                std::cout << "文件系统已保存到 " << fsfile << std::endl;
+            } else {
+                std::cout << "保存文件系统失败!" << std::endl;
+            }
+            return false;
+        } 
+        else if (command == "help" || command == "h") {
+            showHelp();
         }
-        
-        std::vector<std::string> tokens = parseCommand(input);
-        if (tokens.empty()) {
-            continue;
+        else if (command == "status") {
+            showStatus(fs);
         }
-        
-        std::string command = tokens[0];
-        try {
-            // 1. 系统控制命令 - 不需要登录权限检查
-            if (command == "exit" || command == "quit") {
-                std::cout << "正在保存用户数据和文件系统..." << std::endl;
-                
-                // 保存用户数据
-                fs.saveUserData();
-                
-                // 保存文件系统
-                if (fs.saveFS(fsfile) == 0) {
-                    std::cout << "文件系统已保存到 " << fsfile << std::endl;
+        else if (command == "save") {
+            if (fs.saveFS(fsfile) == 0) {
+                std::cout << "文件系统已保存到 " << fsfile << std::endl;
+            } else {
+                std::cout << "保存文件系统失败!" << std::endl;
+            }
+        }
+        else if (command == "sync") {
+            int written = fs.syncFS(fsfile);
+            if (written >= 0) {
+                std::cout << "已写回 " << written << " 个改动过的块到 " << fsfile
+                          << " (" << fs.backingDeviceName() << ")" << std::endl;
+            } else {
+                std::cout << "写回文件系统失败!" << std::endl;
+            }
+        }
+        else if (command == "format") {
+            std::cout << "警告: 这将清除所有文件数据! 是否同时保留用户账户? (Y/n): ";
+            std::string confirm;
+            std::getline(in, confirm);
+            
+            if (confirm == "n" || confirm == "N") {
+                std::cout << "将格式化文件系统并重置所有用户信息。确认吗? (y/N): ";
+                std::getline(in, confirm);
+                if (confirm == "y" || confirm == "Y" || confirm == "yes") {
+                    fs.format();
+                    current_working_directory_inum = MiniFS::ROOT_INUM_CONST; // 重置CWD
+                    std::cout << "文件系统已重新格式化，用户信息已重置。当前目录已重置为根目录。" << std::endl;
                 } else {
-                    std::cout << "保存文件系统失败!" << std::endl;
+                    std::cout << "操作已取消" << std::endl;
+                }
+            } else {
+                std::cout << "将格式化文件系统但保留用户信息。确认吗? (y/N): ";
+                std::getline(in, confirm);
+                if (confirm == "y" || confirm == "Y" || confirm == "yes") {
+                    fs.formatWithUserPreservation();
+                    current_working_directory_inum = MiniFS::ROOT_INUM_CONST; // 重置CWD
+                    std::cout << "文件系统已重新格式化，用户信息已保留。当前目录已重置为根目录。" << std::endl;
+                } else {
+                    std::cout << "操作已取消" << std::endl;
                 }
-                break;
-            } 
-            else if (command == "help" || command == "h") {
-                showHelp();
             }
-            else if (command == "status") {
-                showStatus(fs);
+        }
+        
+        // 2. 用户管理命令 - 不需要登录权限检查
+        else if (command == "login") {
+            if (tokens.size() == 2) {
+                std::string username = tokens[1];
+                std::string password;
+                std::cout << "请输入密码: ";
+                std::getline(in, password);
+                fs.login(username, password);
+            } else {
+                std::cerr << "用法: login <用户名>" << std::endl;
             }
-            else if (command == "save") {
-                if (fs.saveFS(fsfile) == 0) {
-                    std::cout << "文件系统已保存到 " << fsfile << std::endl;
-                } else {
-                    std::cout << "保存文件系统失败!" << std::endl;
-                }
-            }
-            else if (command == "format") {
-                std::cout << "警告: 这将清除所有文件数据! 是否同时保留用户账户? (Y/n): ";
-                std::string confirm;
-                std::getline(std::cin, confirm);
-                
-                if (confirm == "n" || confirm == "N") {
-                    std::cout << "将格式化文件系统并重置所有用户信息。确认吗? (y/N): ";
-                    std::getline(std::cin, confirm);
-                    if (confirm == "y" || confirm == "Y" || confirm == "yes") {
-                        fs.format();
-                        current_working_directory_inum = MiniFS::ROOT_INUM_CONST; // 重置CWD
-                        std::cout << "文件系统已重新格式化，用户信息已重置。当前目录已重置为根目录。" << std::endl;
+        }
+        else if (command == "logout") {
+            fs.logout();
+        }
+        else if (command == "useradd") {
+            if (tokens.size() == 4) {
+                std::string username = tokens[1];
+                try {
+                    int uid = std::stoi(tokens[2]);
+                    int gid = std::stoi(tokens[3]);
+                    std::string password, password_confirm;
+                    std::cout << "为用户 " << username << " 设置密码: ";
+                    std::getline(in, password);
+                    std::cout << "确认密码: ";
+                    std::getline(in, password_confirm);
+                    
+                    if (password == password_confirm) {
+                        fs.addUser(username, password, uid, gid);
                     } else {
-                        std::cout << "操作已取消" << std::endl;
+                        std::cerr << "错误: 两次输入的密码不匹配" << std::endl;
                     }
-                } else {
-                    std::cout << "将格式化文件系统但保留用户信息。确认吗? (y/N): ";
-                    std::getline(std::cin, confirm);
-                    if (confirm == "y" || confirm == "Y" || confirm == "yes") {
-                        fs.formatWithUserPreservation();
-                        current_working_directory_inum = MiniFS::ROOT_INUM_CONST; // 重置CWD
-                        std::cout << "文件系统已重新格式化，用户信息已保留。当前目录已重置为根目录。" << std::endl;
+                } catch (const std::invalid_argument& e) {
+                    std::cerr << "错误: UID 和 GID 必须是整数值" << std::endl;
+                }
+            } else {
+                std::cerr << "用法: useradd <用户名> <UID> <GID>" << std::endl;
+            }
+        }
+        else if (command == "users") {
+            fs.listUsers();
+        }
+        else if (command == "whoami") {
+            if (fs.isLoggedIn()) {
+                const User& current_user = fs.getCurrentUser();
+                std::cout << "当前用户: " << current_user.getUsername() 
+                          << " (UID: " << current_user.getUid() 
+                          << ", GID: " << current_user.getGid() << ")" << std::endl;
+            } else {
+                std::cout << "未登录" << std::endl;
+            }
+        }
+        else if (command == "save-users") {
+            if (fs.saveUserData()) {
+                std::cout << "用户数据已成功保存到文件系统" << std::endl;
+            } else {
+                std::cout << "保存用户数据失败" << std::endl;
+            }
+        }
+        else if (command == "load-users") {
+            if (fs.loadUserData()) {
+                std::cout << "用户数据已成功从文件系统加载" << std::endl;
+            } else {
+                std::cout << "从文件系统加载用户数据失败，将使用默认配置" << std::endl;
+            }
+        }
+        
+        // 3. 测试命令 - 不需要登录权限检查
+        else if (command == "test-bitmap") {
+            test_bitmap_operations(fs);
+        } 
+        else if (command == "test-directory") {
+            std::cout << "注意: test-directory 使用旧的基于inum的mkdir，可能不完全反映路径行为。" << std::endl;
+            test_directory_operations(fs);
+        } 
+        else if (command == "test-file") {
+            std::cout << "开始执行文件操作测试..." << std::endl;
+            test_file_operations(fs);
+        }
+        else if (command == "test-user") {
+            std::cout << "开始执行用户管理功能测试..." << std::endl;
+            test_user_operations(fs);
+        }
+        else if (command == "test-checksum") {
+            test_checksum_operations(fs);
+        }
+        else if (command == "test-link") {
+            test_link_operations(fs);
+        }
+        else if (command == "test-symlink") {
+            test_symlink_operations(fs);
+        }
+        else if (command == "test-rename") {
+            test_rename_operations(fs);
+        }
+        else if (command == "test-truncate") {
+            test_truncate_operations(fs);
+        }
+        else if (command == "test-sparse") {
+            test_sparse_operations(fs);
+        }
+        else if (command == "test-inline") {
+            test_inline_operations(fs);
+        }
+        else if (command == "test-lazyzero") {
+            test_lazy_zero_operations(fs);
+        }
+        else if (command == "test-balloc") {
+            test_batch_alloc_operations(fs);
+        }
+        else if (command == "test-bulk") {
+            test_bulk_import_operations(fs);
+        }
+        else if (command == "test-pipeline") {
+            test_pipeline_import_operations(fs);
+        }
+        else if (command == "test-batch") {
+            test_batch_shell_operations(fs);
+        }
+        else if (command == "test-cwd") {
+            test_cwd_cache_operations(fs);
+        }
+        else if (command == "test-copy") {
+            test_copy_operations(fs);
+        }
+        else if (command == "test-rpc") {
+            test_rpc_operations(fs);
+        }
+        else if (command == "test-blockdev") {
+            test_block_device_operations(fs);
+        }
+        else if (command == "test-readahead") {
+            test_readahead_operations(fs);
+        }
+        else if (command == "test-async") {
+            test_async_operations(fs);
+        }
+        else if (command == "test-steal") {
+            test_work_stealing_operations(fs);
+        }
+        else if (command == "test-tree") {
+            test_tree_operations(fs);
+        }
+        else if (command == "test-readdir") {
+            test_readdir_operations(fs);
+        }
+        else if (command == "test-stat") {
+            test_stat_operations(fs);
+        }
+        else if (command == "test-time") {
+            test_timestamp_operations(fs);
+        }
+        
+        // 4. 文件系统命令 - 需要登录权限检查
+        else {
+            // 对于需要用户登录的操作，进行权限检查
+            bool requires_login = std::find(user_required_commands.begin(), 
+                                          user_required_commands.end(), 
+                                          command) != user_required_commands.end();
+            
+            if (requires_login && !fs.isLoggedIn()) {
+                std::cerr << "错误: 命令 '" << command << "' 需要用户登录" << std::endl;
+                std::cerr << "请使用 'login <用户名>' 登录系统" << std::endl;
+                return true;
+            }
+            
+            // 4.1 目录浏览与查看命令
+            if (command == "ls") {
+                if (tokens.size() == 1) {
+                    // ls (列出当前工作目录)
+                    std::cout << "列出当前目录 (inum " << current_working_directory_inum << ") 内容:" << std::endl;
+                    fs.listDir(current_working_directory_inum);
+                } else if (tokens.size() == 2) {
+                    // ls <路径>
+                    std::string path_arg = tokens[1];
+                    int target_inum = fs.resolve_path_to_inum(path_arg, current_working_directory_inum);
+                    
+                    if (target_inum != MiniFS::INVALID_INUM_CONST) {
+                        fs.listDir(target_inum);
                     } else {
-                        std::cout << "操作已取消" << std::endl;
+                        std::cerr << "错误: 跄径 '" << path_arg << "' 解析失败或不存在。" << std::endl;
                     }
+                } else {
+                    std::cerr << "用法: ls [路径]" << std::endl;
                 }
             }
             
-            // 2. 用户管理命令 - 不需要登录权限检查
-            else if (command == "login") {
+            // 4.2 目录操作命令
+            else if (command == "mkdir") {
                 if (tokens.size() == 2) {
-                    std::string username = tokens[1];
-                    std::string password;
-                    std::cout << "请输入密码: ";
-                    std::getline(std::cin, password);
-                    fs.login(username, password);
+                    // 规范化路径参数
+                    std::string full_path_arg = tokens[1];
+                    std::string parent_path_str;
+                    std::string new_dir_name_str;
+                    
+                    // 解析路径，分离父目录和新目录名
+                    if (!parsePath(full_path_arg, parent_path_str, new_dir_name_str)) {
+                        return true;
+                    }
+                    
+                    // 检查目录名是否有效
+                    if (!isValidName(new_dir_name_str, full_path_arg, true)) {
+                        return true;
+                    }
+                    
+                    // 解析父目录inum
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 创建目录
+                    int result = fs.mkdir(parent_dir_inum, new_dir_name_str.c_str());
+                    if (result != MiniFS::INVALID_INUM_CONST) {
+                        std::cout << "成功创建目录 '" << full_path_arg << "' (i-节点号: " << result << ")." << std::endl;
+                    }
                 } else {
-                    std::cerr << "用法: login <用户名>" << std::endl;
+                    std::cerr << "用法: mkdir <路径/新目录名>" << std::endl;
                 }
             }
-            else if (command == "logout") {
-                fs.logout();
+            else if (command == "rmdir") {
+                if (tokens.size() == 2) {
+                    // rmdir <路径/目录名>
+                    std::string full_path_arg = tokens[1];
+                    std::string parent_path_str;
+                    std::string dir_name_str;
+                    
+                    // 规范化路径
+                    std::string temp_full_path = normalizePath(full_path_arg);
+                    
+                    // 特殊情况：禁止删除根目录
+                    if (temp_full_path == "/") {
+                        std::cerr << "错误: 不能删除根目录。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 解析路径，分离父目录和目录名
+                    if (!parsePath(temp_full_path, parent_path_str, dir_name_str)) {
+                        return true;
+                    }
+                    
+                    // 检查目录名是否有效
+                    if (!isValidName(dir_name_str, full_path_arg, true)) {
+                        return true;
+                    }
+                    
+                    // 解析父目录inum
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 删除目录
+                    int result = fs.rmdir(parent_dir_inum, dir_name_str.c_str());
+                    if (result == 0) {
+                        std::cout << "成功删除目录: '" << full_path_arg << "'" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: rmdir <路径/目录名>" << std::endl;
+                }
             }
-            else if (command == "useradd") {
-                if (tokens.size() == 4) {
-                    std::string username = tokens[1];
-                    try {
-                        int uid = std::stoi(tokens[2]);
-                        int gid = std::stoi(tokens[3]);
-                        std::string password, password_confirm;
-                        std::cout << "为用户 " << username << " 设置密码: ";
-                        std::getline(std::cin, password);
-                        std::cout << "确认密码: ";
-                        std::getline(std::cin, password_confirm);
-                        
-                        if (password == password_confirm) {
-                            fs.addUser(username, password, uid, gid);
+            else if (command == "chdir" || command == "cd") {
+                if (tokens.size() == 2) {
+                    std::string target_path = normalizePath(tokens[1]);
+                    
+                    if (target_path.empty()) {
+                        std::cerr << "错误: 路径不能为空。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 解析目标路径
+                    int target_inum = fs.resolve_path_to_inum(target_path, current_working_directory_inum);
+                    
+                    if (target_inum != MiniFS::INVALID_INUM_CONST) {
+                        // 验证目标是否为目录
+                        dinode target_node;
+                        if (fs._get_inode(target_inum, target_node)) {
+                            if (target_node.type == T_DIR) {
+                                current_working_directory_inum = target_inum;
+                                cwdCacheApply(fs, target_path, target_inum);
+                                std::cout << "成功切换到目录: " << target_path << " (i-节点号: " << target_inum << ")" << std::endl;
+                            } else {
+                                std::cerr << "错误: '" << target_path << "' 不是一个目录。" << std::endl;
+                            }
                         } else {
-                            std::cerr << "错误: 两次输入的密码不匹配" << std::endl;
+                            std::cerr << "错误: 无法读取目标路径的i-节点信息。" << std::endl;
                         }
-                    } catch (const std::invalid_argument& e) {
-                        std::cerr << "错误: UID 和 GID 必须是整数值" << std::endl;
+                    } else {
+                        std::cerr << "错误: 路径 '" << target_path << "' 解析失败或不存在。" << std::endl;
                     }
                 } else {
-                    std::cerr << "用法: useradd <用户名> <UID> <GID>" << std::endl;
+                    std::cerr << "用法: chdir <路径> 或 cd <路径>" << std::endl;
                 }
             }
-            else if (command == "users") {
-                fs.listUsers();
+            
+            // 4.3 文件操作命令
+            else if (command == "create") {
+                if (tokens.size() == 2) {
+                    std::string full_path_arg = tokens[1];
+                    std::string parent_path_str;
+                    std::string new_file_name_str;
+                    
+                    // 解析路径，分离父目录和文件名
+                    if (!parsePath(full_path_arg, parent_path_str, new_file_name_str)) {
+                        return true;
+                    }
+                    
+                    // 检查文件名是否有效
+                    if (!isValidName(new_file_name_str, full_path_arg, false)) {
+                        return true;
+                    }
+                    
+                    // 解析父目录inum
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 创建文件
+                    int result = fs.create(parent_dir_inum, new_file_name_str.c_str());
+                    if (result != MiniFS::INVALID_INUM_CONST) {
+                        std::cout << "成功创建文件: '" << full_path_arg << "' (i-节点号: " << result << ")." << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: create <路径/新文件名>" << std::endl;
+                }
             }
-            else if (command == "whoami") {
-                if (fs.isLoggedIn()) {
-                    const User& current_user = fs.getCurrentUser();
-                    std::cout << "当前用户: " << current_user.getUsername() 
-                              << " (UID: " << current_user.getUid() 
-                              << ", GID: " << current_user.getGid() << ")" << std::endl;
+            else if (command == "rm") {
+                if (tokens.size() == 2) {
+                    std::string full_path_arg = tokens[1];
+                    std::string parent_path_str;
+                    std::string file_name_str;
+                    
+                    // 解析路径，分离父目录和文件名
+                    if (!parsePath(full_path_arg, parent_path_str, file_name_str)) {
+                        return true;
+                    }
+                    
+                    // 检查文件名是否有效
+                    if (!isValidName(file_name_str, full_path_arg, false)) {
+                        return true;
+                    }
+                    
+                    // 解析父目录inum
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    
+                    // 删除文件
+                    int result = fs.rm(parent_dir_inum, file_name_str.c_str());
+                    if (result == 0) {
+                        std::cout << "成功删除文件: '" << full_path_arg << "'" << std::endl;
+                    }
+                } else if (tokens.size() == 3 && tokens[1] == "-r") {
+                    // rm -r <路径>: 递归删除整棵目录树 (也可以是单个文件)
+                    std::string parent_path_str;
+                    std::string name_str;
+                    if (normalizePath(tokens[2]) == "/") {
+                        std::cerr << "错误: 不能删除根目录。" << std::endl;
+                        return true;
+                    }
+                    if (!parsePath(tokens[2], parent_path_str, name_str) || !isValidName(name_str, tokens[2], false)) {
+                        return true;
+                    }
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    // 当前目录在被删除的子树中时，删除后回到根目录 (与 format 相同)，不留下指向已释放i-节点的 CWD
+                    int target_inum = fs._lookup_in_directory(parent_dir_inum, name_str);
+                    cwdCacheRebuild(fs);
+                    bool removes_cwd = target_inum != MiniFS::INVALID_INUM_CONST &&
+                                       std::find(cwd_cache.inums.begin(), cwd_cache.inums.end(), target_inum) !=
+                                           cwd_cache.inums.end();
+                    if (fs.removeTree(parent_dir_inum, name_str.c_str()) >= 0 && removes_cwd) {
+                        current_working_directory_inum = MiniFS::ROOT_INUM_CONST;
+                        cwdCacheInvalidate();
+                        std::cout << "当前目录已被删除，已重置为根目录。" << std::endl;
+                    }
                 } else {
-                    std::cout << "未登录" << std::endl;
+                    std::cerr << "用法: rm [-r] <路径>" << std::endl;
                 }
             }
-            else if (command == "save-users") {
-                if (fs.saveUserData()) {
-                    std::cout << "用户数据已成功保存到文件系统" << std::endl;
+            else if (command == "cp") {
+                bool recursive = tokens.size() == 4 && tokens[1] == "-r";
+                if (tokens.size() == 3 || recursive) {
+                    const std::string& src_path = tokens[tokens.size() - 2];
+                    const std::string& dst_path = tokens.back();
+                    int src_inum = fs.resolve_path_to_inum(src_path, current_working_directory_inum, false);
+                    dinode src_node;
+                    if (src_inum == MiniFS::INVALID_INUM_CONST || !fs._get_inode(src_inum, src_node)) {
+                        std::cerr << "错误: '" << src_path << "' 不存在" << std::endl;
+                        return true;
+                    }
+                    if (src_node.type == T_DIR && !recursive) {
+                        std::cerr << "错误: '" << src_path << "' 是目录，复制目录请使用 cp -r" << std::endl;
+                        return true;
+                    }
+                    // 目标是已存在的目录时复制到其中并保留原名，否则按 父路径/新名字 处理 (与 mv 相同)
+                    int dst_dir_inum = MiniFS::INVALID_INUM_CONST;
+                    std::string dst_name_str;
+                    int existing = fs.resolve_path_to_inum(dst_path, current_working_directory_inum);
+                    dinode existing_node;
+                    if (existing != MiniFS::INVALID_INUM_CONST && fs._get_inode(existing, existing_node) &&
+                        existing_node.type == T_DIR) {
+                        std::string unused;
+                        dst_dir_inum = existing;
+                        if (!parsePath(src_path, unused, dst_name_str)) {
+                            return true;
+                        }
+                    } else {
+                        std::string dst_parent_str;
+                        if (!parsePath(dst_path, dst_parent_str, dst_name_str) ||
+                            !isValidName(dst_name_str, dst_path, false)) {
+                            return true;
+                        }
+                        dst_dir_inum = resolveParentPath(fs, dst_parent_str);
+                        if (dst_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                            std::cerr << "错误: 父路径 '" << dst_parent_str << "' 解析失败或不存在。" << std::endl;
+                            return true;
+                        }
+                    }
+                    int created = fs.copyTree(src_inum, dst_dir_inum, dst_name_str.c_str());
+                    if (created >= 0) {
+                        std::cout << "成功复制: '" << src_path << "' -> '" << dst_path << "' (" << created
+                                  << " 个i-节点)" << std::endl;
+                    }
                 } else {
-                    std::cout << "保存用户数据失败" << std::endl;
+                    std::cerr << "用法: cp [-r] <源路径> <目标路径>" << std::endl;
                 }
             }
-            else if (command == "load-users") {
-                if (fs.loadUserData()) {
-                    std::cout << "用户数据已成功从文件系统加载" << std::endl;
+            else if (command == "du") {
+                if (tokens.size() <= 2) {
+                    std::string path = tokens.size() == 2 ? tokens[1] : ".";
+                    int inum = fs.resolve_path_to_inum(path, current_working_directory_inum, false);
+                    MiniFS::DiskUsage du;
+                    if (inum == MiniFS::INVALID_INUM_CONST || fs.diskUsage(inum, du) != 0) {
+                        std::cerr << "错误: '" << path << "' 不存在" << std::endl;
+                        return true;
+                    }
+                    std::cout << du.blocks << " 块 (" << du.blocks * BLOCK_SIZE / 1024.0 << " KB)  " << path
+                              << "  [文件 " << du.files << ", 目录 " << du.dirs << ", 符号链接 " << du.symlinks
+                              << ", 共 " << du.bytes << " 字节]" << std::endl;
                 } else {
-                    std::cout << "从文件系统加载用户数据失败，将使用默认配置" << std::endl;
+                    std::cerr << "用法: du [路径]" << std::endl;
                 }
             }
-            
-            // 3. 测试命令 - 不需要登录权限检查
-            else if (command == "test-bitmap") {
-                test_bitmap_operations(fs);
-            } 
-            else if (command == "test-directory") {
-                std::cout << "注意: test-directory 使用旧的基于inum的mkdir，可能不完全反映路径行为。" << std::endl;
-                test_directory_operations(fs);
-            } 
-            else if (command == "test-file") {
-                std::cout << "开始执行文件操作测试..." << std::endl;
-                test_file_operations(fs);
-            }
-            else if (command == "test-user") {
-                std::cout << "开始执行用户管理功能测试..." << std::endl;
-                test_user_operations(fs);
+            else if (command == "stat") {
+                bool follow = tokens.size() == 3 && tokens[1] == "-L";
+                if (tokens.size() == 2 || follow) {
+                    const std::string& path = tokens.back();
+                    MiniFS::FileStat st;
+                    int rc = follow ? fs.stat(path, st, current_working_directory_inum)
+                                    : fs.lstat(path, st, current_working_directory_inum);
+                    if (rc != 0) {
+                        std::cerr << "错误: '" << path << "' 不存在" << std::endl;
+                        return true;
+                    }
+                    const char* type = st.st_type == T_DIR ? "目录" : st.st_type == T_SYMLINK ? "符号链接" : "普通文件";
+                    std::cout << "  文件: " << path << std::endl;
+                    std::cout << "  类型: " << type << "  i-节点: " << st.st_ino << "  链接: " << st.st_nlink << std::endl;
+                    std::cout << "  大小: " << st.st_size << "  块: " << st.st_blocks << "  块大小: " << st.st_blksize
+                              << std::endl;
+                    std::cout << "  访问: " << formatTimestamp(st.st_atim) << std::endl;
+                    std::cout << "  修改: " << formatTimestamp(st.st_mtim) << std::endl;
+                    std::cout << "  改变: " << formatTimestamp(st.st_ctim) << std::endl;
+                } else {
+                    std::cerr << "用法: stat [-L] <路径>" << std::endl;
+                }
             }
-            
-            // 4. 文件系统命令 - 需要登录权限检查
-            else {
-                // 对于需要用户登录的操作，进行权限检查
-                bool requires_login = std::find(user_required_commands.begin(), 
-                                              user_required_commands.end(), 
-                                              command) != user_required_commands.end();
-                
-                if (requires_login && !fs.isLoggedIn()) {
-                    std::cerr << "错误: 命令 '" << command << "' 需要用户登录" << std::endl;
-                    std::cerr << "请使用 'login <用户名>' 登录系统" << std::endl;
-                    continue;
-                }
-                
-                // 4.1 目录浏览与查看命令
-                if (command == "ls") {
-                    if (tokens.size() == 1) {
-                        // ls (列出当前工作目录)
-                        std::cout << "列出当前目录 (inum " << current_working_directory_inum << ") 内容:" << std::endl;
-                        fs.listDir(current_working_directory_inum);
-                    } else if (tokens.size() == 2) {
-                        // ls <路径>
-                        std::string path_arg = tokens[1];
-                        int target_inum = fs.resolve_path_to_inum(path_arg, current_working_directory_inum);
-                        
-                        if (target_inum != MiniFS::INVALID_INUM_CONST) {
-                            fs.listDir(target_inum);
-                        } else {
-                            std::cerr << "错误: 跄径 '" << path_arg << "' 解析失败或不存在。" << std::endl;
-                        }
+            else if (command == "atime") {
+                if (tokens.size() == 2) {
+                    if (tokens[1] == "strict") {
+                        fs.setAtimePolicy(MiniFS::AtimePolicy::STRICT);
+                    } else if (tokens[1] == "relatime") {
+                        fs.setAtimePolicy(MiniFS::AtimePolicy::RELATIME);
+                    } else if (tokens[1] == "noatime") {
+                        fs.setAtimePolicy(MiniFS::AtimePolicy::NOATIME);
                     } else {
-                        std::cerr << "用法: ls [路径]" << std::endl;
+                        std::cerr << "用法: atime [strict|relatime|noatime]" << std::endl;
+                        return true;
                     }
                 }
-                
-                // 4.2 目录操作命令
-                else if (command == "mkdir") {
-                    if (tokens.size() == 2) {
-                        // 规范化路径参数
-                        std::string full_path_arg = tokens[1];
-                        std::string parent_path_str;
-                        std::string new_dir_name_str;
-                        
-                        // 解析路径，分离父目录和新目录名
-                        if (!parsePath(full_path_arg, parent_path_str, new_dir_name_str)) {
-                            continue;
-                        }
-                        
-                        // 检查目录名是否有效
-                        if (!isValidName(new_dir_name_str, full_path_arg, true)) {
-                            continue;
-                        }
-                        
-                        // 解析父目录inum
-                        int parent_dir_inum = resolveParentPath(fs, parent_path_str);
-                        if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
-                            std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
-                            continue;
-                        }
-                        
-                        // 创建目录
-                        int result = fs.mkdir(parent_dir_inum, new_dir_name_str.c_str());
-                        if (result != MiniFS::INVALID_INUM_CONST) {
-                            std::cout << "成功创建目录 '" << full_path_arg << "' (i-节点号: " << result << ")." << std::endl;
-                        }
-                    } else {
-                        std::cerr << "用法: mkdir <路径/新目录名>" << std::endl;
+                if (tokens.size() <= 2) {
+                    std::cout << "访问时间策略: " << atimePolicyName(fs.getAtimePolicy()) << std::endl;
+                } else {
+                    std::cerr << "用法: atime [strict|relatime|noatime]" << std::endl;
+                }
+            }
+            else if (command == "unlink") {
+                if (tokens.size() == 2) {
+                    std::string parent_path_str;
+                    std::string file_name_str;
+                    if (!parsePath(tokens[1], parent_path_str, file_name_str) ||
+                        !isValidName(file_name_str, tokens[1], false)) {
+                        return true;
+                    }
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
                     }
+                    if (fs.unlink(parent_dir_inum, file_name_str.c_str()) == 0) {
+                        std::cout << "成功删除链接: '" << tokens[1] << "'" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: unlink <路径/文件名>" << std::endl;
                 }
-                else if (command == "rmdir") {
-                    if (tokens.size() == 2) {
-                        // rmdir <路径/目录名>
-                        std::string full_path_arg = tokens[1];
-                        std::string parent_path_str;
-                        std::string dir_name_str;
-                        
-                        // 规范化路径
-                        std::string temp_full_path = normalizePath(full_path_arg);
-                        
-                        // 特殊情况：禁止删除根目录
-                        if (temp_full_path == "/") {
-                            std::cerr << "错误: 不能删除根目录。" << std::endl;
-                            continue;
-                        }
-                        
-                        // 解析路径，分离父目录和目录名
-                        if (!parsePath(temp_full_path, parent_path_str, dir_name_str)) {
-                            continue;
-                        }
-                        
-                        // 检查目录名是否有效
-                        if (!isValidName(dir_name_str, full_path_arg, true)) {
-                            continue;
-                        }
-                        
-                        // 解析父目录inum
-                        int parent_dir_inum = resolveParentPath(fs, parent_path_str);
-                        if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
-                            std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
-                            continue;
+            }
+            else if (command == "mv") {
+                if (tokens.size() == 3) {
+                    std::string src_parent_str;
+                    std::string src_name_str;
+                    if (!parsePath(tokens[1], src_parent_str, src_name_str) ||
+                        !isValidName(src_name_str, tokens[1], false)) {
+                        return true;
+                    }
+                    int src_dir_inum = resolveParentPath(fs, src_parent_str);
+                    if (src_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << src_parent_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+
+                    // 目标是已存在的目录时移动到其中并保留原名，否则按 父路径/新名字 处理
+                    int dst_dir_inum = MiniFS::INVALID_INUM_CONST;
+                    std::string dst_name_str;
+                    int existing = fs.resolve_path_to_inum(tokens[2], current_working_directory_inum);
+                    dinode existing_node;
+                    if (existing != MiniFS::INVALID_INUM_CONST && fs._get_inode(existing, existing_node) &&
+                        existing_node.type == T_DIR) {
+                        dst_dir_inum = existing;
+                        dst_name_str = src_name_str;
+                    } else {
+                        std::string dst_parent_str;
+                        if (!parsePath(tokens[2], dst_parent_str, dst_name_str) ||
+                            !isValidName(dst_name_str, tokens[2], false)) {
+                            return true;
                         }
-                        
-                        // 删除目录
-                        int result = fs.rmdir(parent_dir_inum, dir_name_str.c_str());
-                        if (result == 0) {
-                            std::cout << "成功删除目录: '" << full_path_arg << "'" << std::endl;
+                        dst_dir_inum = resolveParentPath(fs, dst_parent_str);
+                        if (dst_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                            std::cerr << "错误: 父路径 '" << dst_parent_str << "' 解析失败或不存在。" << std::endl;
+                            return true;
                         }
-                    } else {
-                        std::cerr << "用法: rmdir <路径/目录名>" << std::endl;
                     }
+                    if (fs.rename(src_dir_inum, src_name_str.c_str(), dst_dir_inum, dst_name_str.c_str()) == 0) {
+                        std::cout << "成功移动: '" << tokens[1] << "' -> '" << tokens[2] << "'" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: mv <源路径> <目标路径>" << std::endl;
                 }
-                else if (command == "chdir" || command == "cd") {
-                    if (tokens.size() == 2) {
-                        std::string target_path = normalizePath(tokens[1]);
-                        
-                        if (target_path.empty()) {
-                            std::cerr << "错误: 路径不能为空。" << std::endl;
-                            continue;
-                        }
-                        
-                        // 解析目标路径
-                        int target_inum = fs.resolve_path_to_inum(target_path, current_working_directory_inum);
-                        
-                        if (target_inum != MiniFS::INVALID_INUM_CONST) {
-                            // 验证目标是否为目录
-                            dinode target_node;
-                            if (fs._get_inode(target_inum, target_node)) {
-                                if (target_node.type == T_DIR) {
-                                    current_working_directory_inum = target_inum;
-                                    std::cout << "成功切换到目录: " << target_path << " (i-节点号: " << target_inum << ")" << std::endl;
-                                } else {
-                                    std::cerr << "错误: '" << target_path << "' 不是一个目录。" << std::endl;
-                                }
-                            } else {
-                                std::cerr << "错误: 无法读取目标路径的i-节点信息。" << std::endl;
-                            }
-                        } else {
-                            std::cerr << "错误: 路径 '" << target_path << "' 解析失败或不存在。" << std::endl;
-                        }
+            }
+            else if (command == "ln" && tokens.size() == 4 && tokens[1] == "-s") {
+                std::string parent_path_str;
+                std::string link_name_str;
+                if (!parsePath(tokens[3], parent_path_str, link_name_str) ||
+                    !isValidName(link_name_str, tokens[3], false)) {
+                    return true;
+                }
+                int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                    std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                    return true;
+                }
+                if (fs.symlink(parent_dir_inum, link_name_str.c_str(), tokens[2].c_str()) != MiniFS::INVALID_INUM_CONST) {
+                    std::cout << "成功创建符号链接: '" << tokens[3] << "' -> '" << tokens[2] << "'" << std::endl;
+                }
+            }
+            else if (command == "readlink") {
+                if (tokens.size() == 2) {
+                    int link_inum = fs.resolve_path_to_inum(tokens[1], current_working_directory_inum, false);
+                    if (link_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 路径 '" << tokens[1] << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    std::string target;
+                    if (fs.readlink(link_inum, target) >= 0) {
+                        std::cout << target << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: readlink <路径>" << std::endl;
+                }
+            }
+            else if (command == "ln") {
+                if (tokens.size() == 3) {
+                    int target_inum = fs.resolve_path_to_inum(tokens[1], current_working_directory_inum);
+                    if (target_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 路径 '" << tokens[1] << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    std::string parent_path_str;
+                    std::string link_name_str;
+                    if (!parsePath(tokens[2], parent_path_str, link_name_str) ||
+                        !isValidName(link_name_str, tokens[2], false)) {
+                        return true;
+                    }
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    if (fs.link(target_inum, parent_dir_inum, link_name_str.c_str()) == 0) {
+                        std::cout << "成功创建链接: '" << tokens[2] << "' -> '" << tokens[1] << "'" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: ln [-s] <已有文件|目标> <新路径>" << std::endl;
+                }
+            }
+            
+            // 4.4 文件读写命令
+            else if (command == "open") {
+                if (tokens.size() == 3) {
+                    std::string full_path_arg = tokens[1];
+                    std::string mode_str = tokens[2];
+                    std::string parent_path_str;
+                    std::string file_name_str;
+                    int flags = 0;
+                    
+                    // 解析打开模式
+                    if (mode_str == "r") {
+                        flags = MiniFS::O_RDONLY;
+                    } else if (mode_str == "w") {
+                        flags = MiniFS::O_WRONLY;
+                    } else if (mode_str == "rw") {
+                        flags = MiniFS::O_RDWR;
+                    } else if (mode_str == "c") {
+                        flags = MiniFS::O_CREATE | MiniFS::O_RDWR;
+                    } else if (mode_str == "t") {
+                        flags = MiniFS::O_WRONLY | MiniFS::O_TRUNC;
+                    } else if (mode_str == "a") {
+                        flags = MiniFS::O_WRONLY | MiniFS::O_APPEND;
                     } else {
-                        std::cerr << "用法: chdir <路径> 或 cd <路径>" << std::endl;
+                        std::cerr << "错误: 无效的打开模式 '" << mode_str << "'" << std::endl;
+                        std::cerr << "有效模式: r(只读), w(只写), rw(读写), c(创建), t(截断), a(追加)" << std::endl;
+                        return true;
+                    }
+                    
+                    // 解析路径，分离父目录和文件名
+                    if (!parsePath(full_path_arg, parent_path_str, file_name_str)) {
+                        return true;
+                    }
+                    
+                    // 检查文件名是否有效
+                    if (!isValidName(file_name_str, full_path_arg, false)) {
+                        return true;
+                    }
+                    
+                    // 解析父目录inum
+                    int parent_dir_inum = resolveParentPath(fs, parent_path_str);
+                    if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
+                        return true;
                     }
+                    
+                    // 打开文件
+                    int fd = fs.open(parent_dir_inum, file_name_str.c_str(), flags);
+                    if (fd != -1) {
+                        std::cout << "成功打开文件: '" << full_path_arg << "' (文件描述符: " << fd << ")." << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: open <路径/文件名> <模式>" << std::endl;
+                    std::cerr << "  模式: r(只读), w(只写), rw(读写), c(创建), t(截断), a(追加)" << std::endl;
                 }
-                
-                // 4.3 文件操作命令
-                else if (command == "create") {
-                    if (tokens.size() == 2) {
-                        std::string full_path_arg = tokens[1];
-                        std::string parent_path_str;
-                        std::string new_file_name_str;
-                        
-                        // 解析路径，分离父目录和文件名
-                        if (!parsePath(full_path_arg, parent_path_str, new_file_name_str)) {
-                            continue;
+            }
+            else if (command == "seek") {
+                if (tokens.size() == 3 || tokens.size() == 4) {
+                    std::string whence_str = tokens.size() == 4 ? tokens[3] : "set";
+                    int whence = -1;
+                    if (whence_str == "set") whence = MiniFS::LSEEK_SET;
+                    else if (whence_str == "cur") whence = MiniFS::LSEEK_CUR;
+                    else if (whence_str == "end") whence = MiniFS::LSEEK_END;
+                    else if (whence_str == "data") whence = MiniFS::LSEEK_DATA;
+                    else if (whence_str == "hole") whence = MiniFS::LSEEK_HOLE;
+                    if (whence == -1) {
+                        std::cerr << "错误: 无效的 whence '" << whence_str << "'" << std::endl;
+                        return true;
+                    }
+                    try {
+                        int pos = fs.lseek(std::stoi(tokens[1]), std::stoi(tokens[2]), whence);
+                        if (pos >= 0) {
+                            std::cout << "当前位置: " << pos << std::endl;
                         }
-                        
-                        // 检查文件名是否有效
-                        if (!isValidName(new_file_name_str, full_path_arg, false)) {
-                            continue;
+                    } catch (const std::exception& e) {
+                        std::cerr << "错误: 文件描述符和偏移必须是数字" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: seek <fd> <偏移> [set|cur|end|data|hole]" << std::endl;
+                }
+            }
+            else if (command == "fallocate") {
+                if (tokens.size() == 4 || tokens.size() == 5) {
+                    int mode = 0;
+                    if (tokens.size() == 5) {
+                        if (tokens[4] == "keep") mode = MiniFS::FALLOC_KEEP_SIZE;
+                        else if (tokens[4] == "punch") mode = MiniFS::FALLOC_PUNCH_HOLE;
+                        else {
+                            std::cerr << "错误: 无效的模式 '" << tokens[4] << "' (keep 或 punch)" << std::endl;
+                            return true;
                         }
-                        
-                        // 解析父目录inum
-                        int parent_dir_inum = resolveParentPath(fs, parent_path_str);
-                        if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
-                            std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
-                            continue;
+                    }
+                    try {
+                        if (fs.fallocate(std::stoi(tokens[1]), mode, std::stoi(tokens[2]), std::stoi(tokens[3])) == 0) {
+                            std::cout << (mode == MiniFS::FALLOC_PUNCH_HOLE ? "打洞完成" : "预分配完成") << std::endl;
                         }
-                        
-                        // 创建文件
-                        int result = fs.create(parent_dir_inum, new_file_name_str.c_str());
-                        if (result != MiniFS::INVALID_INUM_CONST) {
-                            std::cout << "成功创建文件: '" << full_path_arg << "' (i-节点号: " << result << ")." << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cerr << "错误: 文件描述符、偏移和长度必须是数字" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: fallocate <fd> <偏移> <长度> [keep|punch]" << std::endl;
+                }
+            }
+            else if (command == "truncate") {
+                if (tokens.size() == 3) {
+                    int target_inum = fs.resolve_path_to_inum(tokens[1], current_working_directory_inum);
+                    if (target_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 路径 '" << tokens[1] << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    try {
+                        int length = std::stoi(tokens[2]);
+                        if (fs.truncate(target_inum, length) == 0) {
+                            std::cout << "成功把 '" << tokens[1] << "' 截断为 " << length << " 字节" << std::endl;
                         }
-                    } else {
-                        std::cerr << "用法: create <路径/新文件名>" << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cerr << "错误: 无效的字节数 '" << tokens[2] << "'" << std::endl;
                     }
+                } else {
+                    std::cerr << "用法: truncate <路径/文件名> <字节数>" << std::endl;
                 }
-                else if (command == "rm") {
-                    if (tokens.size() == 2) {
-                        std::string full_path_arg = tokens[1];
-                        std::string parent_path_str;
-                        std::string file_name_str;
-                        
-                        // 解析路径，分离父目录和文件名
-                        if (!parsePath(full_path_arg, parent_path_str, file_name_str)) {
-                            continue;
+            }
+            else if (command == "close") {
+                if (tokens.size() == 2) {
+                    try {
+                        int fd = std::stoi(tokens[1]);
+                        int result = fs.close(fd);
+                        if (result == 0) {
+                            std::cout << "成功关闭文件描述符: " << fd << std::endl;
                         }
+                    } catch (const std::invalid_argument& e) {
+                        std::cerr << "错误: 无效的文件描述符，必须是一个数字" << std::endl;
+                    } catch (const std::out_of_range& e) {
+                        std::cerr << "错误: 文件描述符超出范围" << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: close <文件描述符>" << std::endl;
+                }
+            }
+            else if (command == "read") {
+                if (tokens.size() == 3) {
+                    try {
+                        int fd = std::stoi(tokens[1]);
+                        int count = std::stoi(tokens[2]);
                         
-                        // 检查文件名是否有效
-                        if (!isValidName(file_name_str, full_path_arg, false)) {
-                            continue;
+                        if (count <= 0) {
+                            std::cerr << "错误: 读取字节数必须大于0" << std::endl;
+                            return true;
                         }
                         
-                        // 解析父目录inum
-                        int parent_dir_inum = resolveParentPath(fs, parent_path_str);
-                        if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
-                            std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
-                            continue;
+                        if (count > 1024) {
+                            std::cout << "警告: 读取字节数较大，已限制为1024字节" << std::endl;
+                            count = 1024;
                         }
                         
-                        // 删除文件
-                        int result = fs.rm(parent_dir_inum, file_name_str.c_str());
-                        if (result == 0) {
-                            std::cout << "成功删除文件: '" << full_path_arg << "'" << std::endl;
+                        // 分配缓冲区来存储读取的数据
+                        std::unique_ptr<char[]> buffer(new char[count + 1]);
+                        if (!buffer) {
+                            std::cerr << "错误: 内存分配失败" << std::endl;
+                            return true;
                         }
-                    } else {
-                        std::cerr << "用法: rm <路径/文件名>" << std::endl;
-                    }
-                }
-                
-                // 4.4 文件读写命令
-                else if (command == "open") {
-                    if (tokens.size() == 3) {
-                        std::string full_path_arg = tokens[1];
-                        std::string mode_str = tokens[2];
-                        std::string parent_path_str;
-                        std::string file_name_str;
-                        int flags = 0;
                         
-                        // 解析打开模式
-                        if (mode_str == "r") {
-                            flags = MiniFS::O_RDONLY;
-                        } else if (mode_str == "w") {
-                            flags = MiniFS::O_WRONLY;
-                        } else if (mode_str == "rw") {
-                            flags = MiniFS::O_RDWR;
-                        } else if (mode_str == "c") {
-                            flags = MiniFS::O_CREATE | MiniFS::O_RDWR;
-                        } else {
-                            std::cerr << "错误: 无效的打开模式 '" << mode_str << "'" << std::endl;
-                            std::cerr << "有效模式: r(只读), w(只写), rw(读写), c(创建)" << std::endl;
-                            continue;
-                        }
+                        // 读取数据
+                        int bytes_read = fs.read(fd, buffer.get(), count);
                         
-                        // 解析路径，分离父目录和文件名
-                        if (!parsePath(full_path_arg, parent_path_str, file_name_str)) {
-                            continue;
+                        if (bytes_read > 0) {
+                            // 确保字符串正确结尾
+                            buffer[bytes_read] = '\0';
+                            
+                            std::cout << "从文件描述符 " << fd << " 读取了 " << bytes_read << " 字节:" << std::endl;
+                            std::cout << "----开始内容----" << std::endl;
+                            
+                            // 检查并打印读取的内容
+                            displayReadContent(buffer.get(), bytes_read);
+                            
+                            std::cout << "----结束内容----" << std::endl;
+                        } else if (bytes_read == 0) {
+                            std::cout << "已到达文件末尾，未读取任何字节" << std::endl;
                         }
+                    } catch (const std::exception& e) {
+                        std::cerr << "错误: " << e.what() << std::endl;
+                    }
+                } else {
+                    std::cerr << "用法: read <文件描述符> <字节数>" << std::endl;
+                }
+            }
+            else if (command == "write") {
+                if (tokens.size() >= 3) {
+                    try {
+                        int fd = std::stoi(tokens[1]);
                         
-                        // 检查文件名是否有效
-                        if (!isValidName(file_name_str, full_path_arg, false)) {
-                            continue;
+                        // 获取要写入的内容
+                        std::string content;
+                        if (tokens[2] == "$") {
+                            std::cout << "请输入要写入的内容（以单独的'.'行结束）：" << std::endl;
+                            std::string line;
+                            while (std::getline(in, line) && line != ".") {
+                                content += line + "\n";
+                            }
+                        } else {
+                            for (size_t i = 2; i < tokens.size(); ++i) {
+                                content += tokens[i];
+                                if (i < tokens.size() - 1) {
+                                    content += " ";
+                                }
+                            }
                         }
                         
-                        // 解析父目录inum
-                        int parent_dir_inum = resolveParentPath(fs, parent_path_str);
-                        if (parent_dir_inum == MiniFS::INVALID_INUM_CONST) {
-                            std::cerr << "错误: 父路径 '" << parent_path_str << "' 解析失败或不存在。" << std::endl;
-                            continue;
-                        }
+                        // 执行写入操作
+                        int bytes_written = fs.write(fd, content.c_str(), content.length());
                         
-                        // 打开文件
-                        int fd = fs.open(parent_dir_inum, file_name_str.c_str(), flags);
-                        if (fd != -1) {
-                            std::cout << "成功打开文件: '" << full_path_arg << "' (文件描述符: " << fd << ")." << std::endl;
+                        if (bytes_written > 0) {
+                            std::cout << "成功向文件描述符 " << fd << " 写入 " << bytes_written << " 字节" << std::endl;
                         }
-                    } else {
-                        std::cerr << "用法: open <路径/文件名> <模式>" << std::endl;
-                        std::cerr << "  模式: r(只读), w(只写), rw(读写), c(创建)" << std::endl;
+                    } catch (const std::invalid_argument& e) {
+                        std::cerr << "错误: 无效的文件描述符，必须是一个数字" << std::endl;
+                    } catch (const std::out_of_range& e) {
+                        std::cerr << "错误: 文件描述符超出范围" << std::endl;
                     }
+                } else {
+                    std::cerr << "用法: write <文件描述符> <内容>" << std::endl;
+                    std::cerr << "  或: write <文件描述符> $ (然后逐行输入内容，以单独的'.'行结束)" << std::endl;
                 }
-                else if (command == "close") {
-                    if (tokens.size() == 2) {
-                        try {
-                            int fd = std::stoi(tokens[1]);
-                            int result = fs.close(fd);
-                            if (result == 0) {
-                                std::cout << "成功关闭文件描述符: " << fd << std::endl;
-                            }
-                        } catch (const std::invalid_argument& e) {
-                            std::cerr << "错误: 无效的文件描述符，必须是一个数字" << std::endl;
-                        } catch (const std::out_of_range& e) {
-                            std::cerr << "错误: 文件描述符超出范围" << std::endl;
-                        }
-                    } else {
-                        std::cerr << "用法: close <文件描述符>" << std::endl;
+            }
+            // 4.5 宿主文件复制与输出重定向
+            else if (command == "cp-in") {
+                if (tokens.size() == 3) {
+                    long copied = copyHostToFs(fs, tokens[1], tokens[2]);
+                    if (copied >= 0) {
+                        std::cout << "已复制 " << copied << " 字节: " << tokens[1] << " -> " << tokens[2] << std::endl;
                     }
+                } else {
+                    std::cerr << "用法: cp-in <宿主路径> <路径/文件名>" << std::endl;
                 }
-                else if (command == "read") {
-                    if (tokens.size() == 3) {
-                        try {
-                            int fd = std::stoi(tokens[1]);
-                            int count = std::stoi(tokens[2]);
-                            
-                            if (count <= 0) {
-                                std::cerr << "错误: 读取字节数必须大于0" << std::endl;
-                                continue;
-                            }
-                            
-                            if (count > 1024) {
-                                std::cout << "警告: 读取字节数较大，已限制为1024字节" << std::endl;
-                                count = 1024;
-                            }
-                            
-                            // 分配缓冲区来存储读取的数据
-                            std::unique_ptr<char[]> buffer(new char[count + 1]);
-                            if (!buffer) {
-                                std::cerr << "错误: 内存分配失败" << std::endl;
-                                continue;
-                            }
-                            
-                            // 读取数据
-                            int bytes_read = fs.read(fd, buffer.get(), count);
-                            
-                            if (bytes_read > 0) {
-                                // 确保字符串正确结尾
-                                buffer[bytes_read] = '\0';
-                                
-                                std::cout << "从文件描述符 " << fd << " 读取了 " << bytes_read << " 字节:" << std::endl;
-                                std::cout << "----开始内容----" << std::endl;
-                                
-                                // 检查并打印读取的内容
-                                displayReadContent(buffer.get(), bytes_read);
-                                
-                                std::cout << "----结束内容----" << std::endl;
-                            } else if (bytes_read == 0) {
-                                std::cout << "已到达文件末尾，未读取任何字节" << std::endl;
-                            }
-                        } catch (const std::exception& e) {
-                            std::cerr << "错误: " << e.what() << std::endl;
-                        }
-                    } else {
-                        std::cerr << "用法: read <文件描述符> <字节数>" << std::endl;
+            }
+            else if (command == "cp-out" || command == "cat") {
+                // cp-out <文件> <宿主路径> 等价于 cat <文件> > <宿主路径>
+                bool to_host = command == "cp-out" ? tokens.size() == 3
+                                                   : tokens.size() == 4 && (tokens[2] == ">" || tokens[2] == ">>");
+                if (to_host) {
+                    const std::string& host_path = tokens.back();
+                    bool append = command == "cat" && tokens[2] == ">>";
+                    std::ofstream out(host_path.c_str(), std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+                    if (!out) {
+                        std::cerr << "错误: 无法打开宿主文件 '" << host_path << "'" << std::endl;
+                        return true;
+                    }
+                    long copied = copyFsToStream(fs, tokens[1], out);
+                    if (copied >= 0) {
+                        std::cout << "已复制 " << copied << " 字节: " << tokens[1] << " -> " << host_path << std::endl;
                     }
+                } else if (command == "cat" && tokens.size() == 2) {
+                    copyFsToStream(fs, tokens[1], std::cout);
+                    std::cout << std::flush;
+                } else if (command == "cat") {
+                    std::cerr << "用法: cat <路径/文件名> [> 或 >> <宿主路径>]" << std::endl;
+                } else {
+                    std::cerr << "用法: cp-out <路径/文件名> <宿主路径>" << std::endl;
                 }
-                else if (command == "write") {
-                    if (tokens.size() >= 3) {
-                        try {
-                            int fd = std::stoi(tokens[1]);
-                            
-                            // 获取要写入的内容
-                            std::string content;
-                            if (tokens[2] == "$") {
-                                std::cout << "请输入要写入的内容（以单独的'.'行结束）：" << std::endl;
-                                std::string line;
-                                while (std::getline(std::cin, line) && line != ".") {
-                                    content += line + "\n";
-                                }
-                            } else {
-                                for (size_t i = 2; i < tokens.size(); ++i) {
-                                    content += tokens[i];
-                                    if (i < tokens.size() - 1) {
-                                        content += " ";
-                                    }
-                                }
-                            }
-                            
-                            // 执行写入操作
-                            int bytes_written = fs.write(fd, content.c_str(), content.length());
-                            
-                            if (bytes_written > 0) {
-                                std::cout << "成功向文件描述符 " << fd << " 写入 " << bytes_written << " 字节" << std::endl;
-                            }
-                        } catch (const std::invalid_argument& e) {
-                            std::cerr << "错误: 无效的文件描述符，必须是一个数字" << std::endl;
-                        } catch (const std::out_of_range& e) {
-                            std::cerr << "错误: 文件描述符超出范围" << std::endl;
-                        }
-                    } else {
-                        std::cerr << "用法: write <文件描述符> <内容>" << std::endl;
-                        std::cerr << "  或: write <文件描述符> $ (然后逐行输入内容，以单独的'.'行结束)" << std::endl;
+            }
+            // 4.6 数据校验与巡检命令
+            else if (command == "csum") {
+                if (tokens.size() == 3 && (tokens[2] == "on" || tokens[2] == "off")) {
+                    int target_inum = fs.resolve_path_to_inum(tokens[1], current_working_directory_inum);
+                    if (target_inum == MiniFS::INVALID_INUM_CONST) {
+                        std::cerr << "错误: 路径 '" << tokens[1] << "' 解析失败或不存在。" << std::endl;
+                        return true;
+                    }
+                    bool enable = tokens[2] == "on";
+                    if (fs.setDataChecksums(target_inum, enable) == 0) {
+                        std::cout << "已" << (enable ? "开启" : "关闭") << " '" << tokens[1] << "' 的数据校验" << std::endl;
                     }
+                } else {
+                    std::cerr << "用法: csum <路径/文件名> on|off" << std::endl;
                 }
-                else {
-                    std::cerr << "未知命令: " << command << std::endl;
-                    std::cerr << "输入 'help' 查看可用命令" << std::endl;
+            }
+            else if (command == "scrub") {
+                if (tokens.size() == 1) {
+                    int mismatches = fs.scrubOnce();
+                    std::cout << "巡检完成，发现 " << mismatches << " 个不匹配块" << std::endl;
+                } else if (tokens[1] == "start" && tokens.size() <= 3) {
+                    try {
+                        int rate = tokens.size() == 3 ? std::stoi(tokens[2]) : 256;
+                        fs.startScrubber(rate);
+                    } catch (const std::exception& e) {
+                        std::cerr << "错误: 速率必须是整数 (块/秒)" << std::endl;
+                    }
+                } else if (tokens[1] == "stop" && tokens.size() == 2) {
+                    fs.stopScrubber();
+                } else {
+                    std::cerr << "用法: scrub [start [块/秒]|stop]" << std::endl;
                 }
             }
-        } catch (const std::exception& e) {
-            std::cerr << "执行命令时发生错误: " << e.what() << std::endl;
+            else {
+                std::cerr << "未知命令: " << command << std::endl;
+                std::cerr << "输入 'help' 查看可用命令" << std::endl;
+            }
         }
+    } catch (const std::exception& e) {
+        std::cerr << "执行命令时发生错误: " << e.what() << std::endl;
     }
+    return true;
+}
+
+// 交互式命令行界面
+void runInteractiveShell(MiniFS& fs, const std::string& fsfile) {
+    std::cout << "\n========== MiniFS 交互式命令行 ==========" << std::endl;
+    std::cout << "当前目录 i-节点号: " << current_working_directory_inum << " (根目录)" << std::endl;
+    std::cout << "输入 'help' 查看可用命令，输入 'exit' 退出" << std::endl;
+    std::cout << "=========================================" << std::endl;
+    
+    // 尝试从文件系统加载用户数据
+    fs.loadUserData();
+    
+    std::string input;
+    while (true) {
+        // 获取当前工作目录的路径并显示命令提示符
+        std::string cwd_path = getShellCwdPath(fs);
+        std::string user_part = fs.isLoggedIn() ? fs.getCurrentUser().getUsername() + "@" : "";
+        std::cout << "\nMiniFS:" << user_part << cwd_path << "> ";
+        if (!std::getline(std::cin, input)) {
+            // 标准输入结束 (例如管道输入读完) 时按 exit 处理，而不是反复执行上一条命令
+            executeCommand(fs, fsfile, std::vector<std::string>(1, "exit"), std::cin);
+            break;
+        }
+        
+        // 去除前导和后导空格
+        input.erase(0, input.find_first_not_of(" \t"));
+        if (input.find_last_not_of(" \t") != std::string::npos)
+            input.erase(input.find_last_not_of(" \t") + 1);
+        
+        if (input.empty()) {
+            continue;
+        }
+        
+        std::vector<std::string> tokens = parseCommand(input);
+        if (tokens.empty()) {
+            continue;
+        }
+        if (!executeCommand(fs, fsfile, tokens, std::cin)) {
+            break;
+        }
+    }
+}
+
+// 非交互的批处理模式: 不打印提示符、不重建当前路径，逐行执行脚本
+// 空行和 # 开头的注释行跳过；exit/quit 或脚本结束时保存一次用户数据和镜像
+int runBatchShell(MiniFS& fs, const std::string& fsfile, std::istream& script, const BatchOptions& options) {
+    fs.loadUserData();
+
+    std::map<std::string, std::vector<double> > latencies_us; // 按命令名统计每次执行的耗时
+    int executed = 0;
+    int deferred_saves = 0;
+    std::chrono::steady_clock::time_point batch_start = std::chrono::steady_clock::now();
+    std::string input;
+    while (std::getline(script, input)) {
+        std::vector<std::string> tokens = parseCommand(input);
+        if (tokens.empty() || tokens[0][0] == '#') {
+            continue;
+        }
+        const std::string& command = tokens[0];
+        if (command == "exit" || command == "quit") {
+            break;
+        }
+        if (options.save_at_end && command == "save") {
+            deferred_saves++; // 推迟到结束时统一保存
+            continue;
+        }
+        if (options.echo) {
+            std::cout << "> " << input << std::endl;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        executeCommand(fs, fsfile, tokens, script);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        latencies_us[command].push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        executed++;
+    }
+    double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batch_start).count();
+
+    fs.stopScrubber();
+    fs.saveUserData();
+    if (fs.saveFS(fsfile) == 0) {
+        std::cout << "文件系统已保存到 " << fsfile
+                  << (deferred_saves > 0 ? " (合并了 " + std::to_string(deferred_saves) + " 次 save)" : "") << std::endl;
+    } else {
+        std::cout << "保存文件系统失败!" << std::endl;
+    }
+
+    // 每条命令的耗时统计 (微秒)
+    std::ios::fmtflags saved_flags = std::cout.flags();
+    std::streamsize saved_precision = std::cout.precision();
+    std::cout << "\n========== 批处理耗时统计 ==========" << std::endl;
+    std::cout << "共执行 " << executed << " 条命令，总耗时 " << std::fixed << std::setprecision(3) << total_ms << " ms" << std::endl;
+    std::cout << std::left << std::setw(12) << "command" << std::right << std::setw(8) << "count" << std::setw(12) << "avg(us)"
+              << std::setw(12) << "p50(us)" << std::setw(12) << "p99(us)" << std::setw(12) << "max(us)" << std::endl;
+    for (std::map<std::string, std::vector<double> >::iterator it = latencies_us.begin(); it != latencies_us.end(); ++it) {
+        std::vector<double>& samples = it->second;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) {
+            sum += v;
+        }
+        size_t n = samples.size();
+        std::cout << std::left << std::setw(12) << it->first << std::right << std::setw(8) << n
+                  << std::setw(12) << std::setprecision(1) << sum / n
+                  << std::setw(12) << samples[std::min(n - 1, n / 2)]
+                  << std::setw(12) << samples[std::min(n - 1, n * 99 / 100)]
+                  << std::setw(12) << samples[n - 1] << std::endl;
+    }
+    std::cout << "====================================" << std::endl;
+    std::cout.flags(saved_flags);
+    std::cout.precision(saved_precision);
+    return executed;
 }
 
 // 辅助函数：规范化路径（移除多余的斜杠）
@@ -778,4 +1492,83 @@ void displayReadContent(const char* buffer, int bytes_read) {
         }
         std::cout << std::endl;
     }
-}
\ No newline at end of file
+}
+
+// 以块为单位把宿主文件复制到镜像中的文件 (不存在时创建，存在时截断)，整个复制过程复用一个块大小的缓冲区
+// 返回复制的字节数，失败返回-1
+long copyHostToFs(MiniFS& fs, const std::string& host_path, const std::string& fs_path) {
+    std::ifstream in(host_path.c_str(), std::ios::binary);
+    if (!in) {
+        std::cerr << "错误: 无法打开宿主文件 '" << host_path << "'" << std::endl;
+        return -1;
+    }
+    std::string parent_path, name;
+    if (!parsePath(fs_path, parent_path, name) || !isValidName(name, fs_path, false)) {
+        return -1;
+    }
+    int parent_inum = resolveParentPath(fs, parent_path);
+    if (parent_inum == MiniFS::INVALID_INUM_CONST) {
+        std::cerr << "错误: 父路径 '" << parent_path << "' 解析失败或不存在。" << std::endl;
+        return -1;
+    }
+    int fd = fs.open(parent_inum, name.c_str(), MiniFS::O_WRONLY | MiniFS::O_CREATE | MiniFS::O_TRUNC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[BLOCK_SIZE];
+    long total = 0;
+    while (in) {
+        in.read(buf, sizeof(buf));
+        int n = static_cast<int>(in.gcount());
+        if (n == 0) {
+            break;
+        }
+        if (fs.write(fd, buf, n) != n) {
+            std::cerr << "错误: 写入 '" << fs_path << "' 失败 (已写入 " << total << " 字节)" << std::endl;
+            fs.close(fd);
+            return -1;
+        }
+        total += n;
+    }
+    fs.close(fd);
+    return total;
+}
+
+// 以块为单位把镜像中的文件原样写到 out (空洞输出为0)，返回复制的字节数，失败返回-1
+long copyFsToStream(MiniFS& fs, const std::string& fs_path, std::ostream& out) {
+    std::string parent_path, name;
+    if (!parsePath(fs_path, parent_path, name)) {
+        return -1;
+    }
+    int parent_inum = resolveParentPath(fs, parent_path);
+    if (parent_inum == MiniFS::INVALID_INUM_CONST) {
+        std::cerr << "错误: 父路径 '" << parent_path << "' 解析失败或不存在。" << std::endl;
+        return -1;
+    }
+    int fd = fs.open(parent_inum, name.c_str(), MiniFS::O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[BLOCK_SIZE];
+    long total = 0;
+    for (;;) {
+        int n = fs.pread(fd, buf, sizeof(buf), static_cast<int>(total));
+        if (n < 0) {
+            fs.close(fd);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        out.write(buf, n);
+        total += n;
+    }
+    fs.close(fd);
+    if (!out) {
+        std::cerr << "错误: 输出失败" << std::endl;
+        return -1;
+    }
+    return total;
+}
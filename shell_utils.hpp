@@ -10,7 +10,20 @@ void showHelp();
 void showStatus(MiniFS& fs); // 改回非const以适应当前实现
 std::vector<std::string> parseCommand(const std::string& input);
 void runInteractiveShell(MiniFS& fs, const std::string& fsfile);
+// 执行一条已分词的命令，交互输入从 in 读取；返回 false 表示应当退出
+bool executeCommand(MiniFS& fs, const std::string& fsfile, const std::vector<std::string>& tokens, std::istream& in);
+
+// 批处理模式选项
+struct BatchOptions {
+    bool save_at_end;   // 跳过脚本中的 save，结束时只保存一次
+    bool echo;          // 执行前回显每条命令
+
+    BatchOptions() : save_at_end(false), echo(false) {}
+};
+// 从 script 逐行执行命令 (无提示符)，结束时保存并输出每条命令的耗时统计；返回执行的命令数
+int runBatchShell(MiniFS& fs, const std::string& fsfile, std::istream& script, const BatchOptions& options);
 std::string getCwdPath(MiniFS& fs, int current_inum);
+std::string getShellCwdPath(MiniFS& fs); // 当前工作目录的路径 (使用缓存，cd 时增量更新)
 
 // 添加辅助函数的声明
 std::string normalizePath(const std::string& path);
@@ -19,4 +32,8 @@ bool isValidName(const std::string& name, const std::string& full_path, bool is_
 int resolveParentPath(MiniFS& fs, const std::string& parent_path);
 void displayReadContent(const char* buffer, int bytes_read);
 
+// 宿主文件与镜像文件之间按块流式复制，返回复制的字节数，失败返回-1
+long copyHostToFs(MiniFS& fs, const std::string& host_path, const std::string& fs_path);
+long copyFsToStream(MiniFS& fs, const std::string& fs_path, std::ostream& out);
+
 #endif // FS_UTILS_HPP
\ No newline at end of file
@@ -20,22 +20,8 @@ bool UserManager::saveUsersToFS(MiniFS* fs) {
     // 获取用户数据字符串
     std::string user_data = getUsersDataString();
 
-    // 创建/etc/passwd文件
-    // 首先查看文件是否已存在，存在则删除
-    int passwd_inum = fs->_lookup_in_directory(etc_dir_inum, "passwd");
-    if (passwd_inum != MiniFS::INVALID_INUM_CONST) {
-        fs->rm(etc_dir_inum, "passwd");
-    }
-
-    // 创建新文件
-    passwd_inum = fs->create(etc_dir_inum, "passwd");
-    if (passwd_inum == MiniFS::INVALID_INUM_CONST) {
-        std::cerr << "错误: 无法创建/etc/passwd文件" << std::endl;
-        return false;
-    }
-
-    // 打开文件
-    int fd = fs->open(etc_dir_inum, "passwd", MiniFS::O_WRONLY);
+    // 打开/etc/passwd: 不存在则创建，已存在则截断后原地重写 (复用原有i-节点和数据块)
+    int fd = fs->open(etc_dir_inum, "passwd", MiniFS::O_WRONLY | MiniFS::O_CREATE | MiniFS::O_TRUNC);
     if (fd == -1) {
         std::cerr << "错误: 无法打开/etc/passwd文件写入" << std::endl;
         return false;
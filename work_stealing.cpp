@@ -0,0 +1,176 @@
+#include "work_stealing.hpp"
+
+namespace {
+// 当前线程所属的线程池及其队列下标 (非工作线程为 -1)
+thread_local WorkStealingPool* current_pool = nullptr;
+thread_local int current_index = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int thread_count)
+    : queued(0), next_queue(0), stopping(false), executed(0), stolen(0) {
+    if (thread_count <= 0) {
+        thread_count = static_cast<int>(std::thread::hardware_concurrency());
+        if (thread_count <= 0) {
+            thread_count = 2;
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < thread_count; i++) {
+        threads.push_back(std::thread([this, i]() { workerLoop(i); }));
+    }
+}
+
+// 执行完已提交的任务 (包括它们派生的任务) 后退出
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        stopping = true;
+    }
+    idle_cv.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::post(std::function<void()> task) {
+    int index = (current_pool == this) ? current_index
+                                       : static_cast<int>(next_queue++ % static_cast<unsigned>(queues.size()));
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queued++;
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+    }
+    idle_cv.notify_one();
+}
+
+// 从自己队列的尾部取任务
+bool WorkStealingPool::popLocal(int index, std::function<void()>& task) {
+    WorkerQueue& q = *queues[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) {
+        return false;
+    }
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+// 从其他队列的头部窃取，从 thief 的下一个队列开始轮询
+bool WorkStealingPool::steal(int thief, std::function<void()>& task) {
+    int n = static_cast<int>(queues.size());
+    int start = thief < 0 ? static_cast<int>(next_queue.load() % static_cast<unsigned>(n)) : thief + 1;
+    for (int k = 0; k < n; k++) {
+        int victim = (start + k) % n;
+        if (victim == thief) {
+            continue;
+        }
+        WorkerQueue& q = *queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOneTask() {
+    std::function<void()> task;
+    int index = (current_pool == this) ? current_index : -1;
+    if (index >= 0 && popLocal(index, task)) {
+        queued--;
+    } else if (steal(index, task)) {
+        queued--;
+        stolen++;
+    } else {
+        return false;
+    }
+    executed++;
+    task();
+    return true;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    current_pool = this;
+    current_index = index;
+    for (;;) {
+        if (runOneTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_cv.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+WorkStealingPool::Stats WorkStealingPool::getStats() const {
+    Stats s;
+    s.executed = executed;
+    s.stolen = stolen;
+    return s;
+}
+
+void TaskTree::Node::spawn(Task task) {
+    Node* child = new Node(tree, this);
+    pending++;
+    tree.pool.post([child, task]() {
+        task(*child);
+        child->release();
+    });
+}
+
+// 计数减一: 归零说明自身和全部子任务都已完成，通知父节点并释放本节点
+void TaskTree::Node::release() {
+    if (--pending != 0) {
+        return;
+    }
+    if (parent == nullptr) {
+        tree.finish();
+        return;
+    }
+    Node* p = parent;
+    delete this;
+    p->release();
+}
+
+TaskTree::TaskTree(WorkStealingPool& pool)
+    : pool(pool), root(*this, nullptr), done(false), waited(false) {}
+
+TaskTree::~TaskTree() {
+    wait();
+}
+
+void TaskTree::finish() {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    done = true;
+    done_cv.notify_all();
+}
+
+void TaskTree::wait() {
+    if (waited) {
+        return;
+    }
+    waited = true;
+    root.release(); // 根节点自身的计数
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            if (done) {
+                return;
+            }
+        }
+        // 帮忙执行任务；没有可取的任务时 (都在其他线程上执行) 短暂等待
+        if (!pool.runOneTask()) {
+            std::unique_lock<std::mutex> lock(done_mutex);
+            done_cv.wait_for(lock, std::chrono::milliseconds(1), [this]() { return done; });
+        }
+    }
+}
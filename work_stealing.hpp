@@ -0,0 +1,111 @@
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "async_fs.hpp"
+
+// 工作窃取线程池: 每个工作线程一个双端队列
+// 工作线程派生的任务放入自己队列的尾部并从尾部取 (后进先出，刚派生的子任务数据还在缓存中)；
+// 自己的队列空了就从其他线程队列的头部窃取 (先进先出，偷走的是较早派生、通常较大的子树)。
+// 外部线程提交的任务轮流放入各队列。也可以作为异步接口的执行器使用
+class WorkStealingPool : public AsyncExecutor {
+public:
+    struct Stats {
+        long executed;   // 开始执行的任务数
+        long stolen;     // 其中从其他队列窃取的任务数
+    };
+
+    // threads 为0时使用硬件线程数
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void post(std::function<void()> task) override;
+    int threadCount() const { return static_cast<int>(threads.size()); }
+
+    // 取一个任务在当前线程执行 (等待任务完成的线程借此帮忙)，没有任务时返回 false
+    bool runOneTask();
+
+    Stats getStats() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    bool popLocal(int index, std::function<void()>& task);
+    bool steal(int thief, std::function<void()>& task);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<WorkerQueue> > queues;
+    std::vector<std::thread> threads;
+    std::atomic<long> queued;          // 所有队列中的任务总数
+    std::atomic<unsigned> next_queue;  // 外部提交时轮流选择队列
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    bool stopping;
+    std::atomic<long> executed;
+    std::atomic<long> stolen;
+};
+
+// 树形完成计数: 每个任务是一个节点，记录自身与尚未完成的子任务个数，
+// 计数归零时通知父节点，只有根节点归零时才唤醒等待者 (不需要全局锁或全局计数器)
+//
+// 用法:
+//   TaskTree tree(pool);
+//   tree.spawn([&](TaskTree::Node& n) { ...; n.spawn(子任务); });
+//   tree.wait();   // 等待期间调用线程也执行任务
+class TaskTree {
+public:
+    class Node;
+    typedef std::function<void(Node&)> Task;
+
+    class Node {
+    public:
+        // 派生子任务: 本节点在子任务完成之前不算完成
+        void spawn(Task task);
+
+    private:
+        friend class TaskTree;
+        Node(TaskTree& tree, Node* parent) : tree(tree), parent(parent), pending(1) {}
+        void release();
+
+        TaskTree& tree;
+        Node* parent;
+        std::atomic<long> pending;
+    };
+
+    explicit TaskTree(WorkStealingPool& pool);
+    ~TaskTree();
+
+    TaskTree(const TaskTree&) = delete;
+    TaskTree& operator=(const TaskTree&) = delete;
+
+    void spawn(Task task) { root.spawn(std::move(task)); }
+    // 等待全部任务 (含各层子任务) 完成；只能调用一次
+    void wait();
+
+private:
+    void finish();
+
+    WorkStealingPool& pool;
+    Node root;
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    bool done;
+    bool waited;
+};
+
+#endif // WORK_STEALING_HPP